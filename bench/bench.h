@@ -0,0 +1,36 @@
+#ifndef MINESWEEPER_BENCH_H
+#define MINESWEEPER_BENCH_H
+
+#include <stdlib.h>
+#include <time.h>
+#include "map.h"
+
+/*
+ * Gemeenschappelijke helpers voor de benchmarks in bench/.
+ * Elke benchmark is een apart programma dat zijn resultaten als tekst naar stdout schrijft.
+ */
+
+// De huidige tijd in milliseconden (monotone klok).
+static inline double bench_now_ms()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec * 1e3 + (double)t.tv_nsec * 1e-6;
+}
+
+// Een volledig gegenereerd speelveld van w x h met het gegeven aantal mijnen (mijnen en nummers ingevuld).
+static inline int bench_board(Board *b, int w, int h, int mines, uint64_t seed)
+{
+    if (init_map(b, w, h, mines) != 0)
+        return -1;
+    add_mines(b, seed, 1, -1, -1);
+    return 0;
+}
+
+// Leest het i-de argument als getal, of geeft de standaardwaarde terug als het ontbreekt.
+static inline int bench_arg(int argc, char **argv, int i, int fallback)
+{
+    return argc > i ? atoi(argv[i]) : fallback;
+}
+
+#endif // MINESWEEPER_BENCH_H
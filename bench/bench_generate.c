@@ -0,0 +1,51 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "parallel.h"
+
+/*
+ * Meet hoe het genereren van een groot speelveld (mijnen plaatsen en getallen berekenen) schaalt van 1 tot N threads.
+ * Elke run start van een leeg speelveld; we controleren meteen dat het resultaat gelijk is aan dat van 1 thread.
+ *
+ * Gebruik: bench_generate [breedte] [hoogte] [max threads] [mijnen per 1000 cellen]
+ */
+int main(int argc, char **argv)
+{
+    int w = bench_arg(argc, argv, 1, 8000);
+    int h = bench_arg(argc, argv, 2, 8000);
+    int max_threads = bench_arg(argc, argv, 3, parallel_default_threads());
+    int per_mille = bench_arg(argc, argv, 4, 160);
+    int mines = (int)((long long)w * h * per_mille / 1000);
+
+    Board reference, b;
+    if (init_map(&reference, w, h, mines) != 0 || init_map(&b, w, h, mines) != 0)
+    {
+        fprintf(stderr, "Out of memory for a %dx%d board\n", w, h);
+        return 1;
+    }
+
+    printf("%dx%d board, %d mines, %d core(s)\n", w, h, mines, parallel_default_threads());
+    printf("%8s %12s %10s\n", "threads", "time (ms)", "speedup");
+    double base = 0;
+    for (int threads = 1; threads <= max_threads; ++threads)
+    {
+        Board *target = threads == 1 ? &reference : &b;
+        memset(target->cells, 0, map_cell_count(target));
+        target->mines = mines;
+        double t0 = bench_now_ms();
+        add_mines(target, 42, threads, w / 2, h / 2);
+        double ms = bench_now_ms() - t0;
+        if (threads == 1)
+            base = ms;
+        else if (memcmp(b.cells, reference.cells, map_cell_count(&b)) != 0)
+        {
+            fprintf(stderr, "%d threads: the board differs from the board of 1 thread\n", threads);
+            return 1;
+        }
+        printf("%8d %12.2f %9.2fx\n", threads, ms, base / ms);
+    }
+    free_map(&reference);
+    free_map(&b);
+    return 0;
+}
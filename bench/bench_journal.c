@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "files.h"
+#include "game.h"
+#include "journal.h"
+#include "rng.h"
+
+/*
+ * Meet het afspelen van een journal (journal_replay via game_load), in MB/s van het journal en in ns per record,
+ * tegenover de geheugenbandbreedte: een memcpy van evenveel bytes, en enkel het decoderen van de records (zonder de zetten).
+ * Het journal bevat een momentopname van een speelveld na de eerste klik, gevolgd door:
+ * - "snapshot": geen records (enkel het inlezen van de momentopname, dat trekken we van de andere af);
+ * - "flags": vlaggen die telkens geplaatst en weer weggehaald worden (de goedkoopste zet);
+ * - "reveals": kliks op willekeurige veilige cellen (de eerste starten cascades, de rest is al uncovered).
+ * We schrijven het bestand rechtstreeks, zodat journal_flush het niet compacteert. Per variant nemen we de snelste van een aantal herhalingen.
+ *
+ * Gebruik: bench_journal [grootte] [records] [herhalingen] [bestandsnaam]
+ */
+
+// Schrijft een journal met de momentopname van game en count records van het gegeven type.
+static int write_journal(const char *filename, const Game *game, JournalRecordType type, size_t count, uint64_t seed)
+{
+    const Board *b = &game->board;
+    size_t snapshot_size;
+    uint8_t *snapshot = encode_field_binary(b, game->seed, CELL_UNCOVERED, &snapshot_size);
+    if (!snapshot)
+        return -1;
+    size_t size = JOURNAL_HEADER_SIZE + snapshot_size + count * JOURNAL_RECORD_SIZE;
+    uint8_t *buf = (uint8_t *)calloc(size, 1);
+    if (!buf)
+    {
+        free(snapshot);
+        return -1;
+    }
+    memcpy(buf, JOURNAL_MAGIC, 4);
+    put_u16(buf + 4, JOURNAL_VERSION);
+    put_u16(buf + 6, JOURNAL_FLAG_MINES);
+    put_u32(buf + 8, (uint32_t)b->width);
+    put_u32(buf + 12, (uint32_t)b->height);
+    put_u32(buf + 16, (uint32_t)b->mines);
+    put_u64(buf + 24, snapshot_size);
+    memcpy(buf + JOURNAL_HEADER_SIZE, snapshot, snapshot_size);
+    free(snapshot);
+
+    Rng rng;
+    rng_seed(&rng, seed);
+    uint8_t *record = buf + JOURNAL_HEADER_SIZE + snapshot_size;
+    int x = 0, y = 0;
+    for (size_t i = 0; i < count; ++i, record += JOURNAL_RECORD_SIZE)
+    {
+        // Een vlag wordt in het volgende record weer weggehaald, zodat we nooit aan het maximum aantal vlaggen komen.
+        if (type == JOURNAL_REVEAL || i % 2 == 0)
+        {
+            do
+            {
+                x = (int)rng_bounded(&rng, (uint64_t)b->width);
+                y = (int)rng_bounded(&rng, (uint64_t)b->height);
+            } while (cell_is_mine(MAP_CELL(b, x, y)));
+        }
+        record[0] = (uint8_t)type;
+        put_u32(record + 4, (uint32_t)x);
+        put_u32(record + 8, (uint32_t)y);
+    }
+    int result = write_file(filename, buf, size, false);
+    free(buf);
+    return result;
+}
+
+// De snelste tijd (in ms) van repeat keer het journal afspelen.
+static double time_replay(const char *filename, int repeat)
+{
+    double best = 1e30;
+    for (int r = 0; r < repeat; ++r)
+    {
+        double start = bench_now_ms();
+        Game *game = game_load(filename);
+        double ms = bench_now_ms() - start;
+        if (!game)
+            return -1;
+        game_free(game);
+        if (ms < best)
+            best = ms;
+    }
+    return best;
+}
+
+// De snelste tijd (in ms) van enkel het decoderen van de records (type, x en y), zonder de zetten uit te voeren.
+static double time_decode(const char *filename, size_t count, int repeat, uint64_t *checksum)
+{
+    MappedFile f;
+    if (map_file(filename, &f) != 0)
+        return -1;
+    const uint8_t *records = (const uint8_t *)f.data + f.size - count * JOURNAL_RECORD_SIZE;
+    double best = 1e30;
+    for (int r = 0; r < repeat; ++r)
+    {
+        double start = bench_now_ms();
+        uint64_t sum = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const uint8_t *record = records + i * JOURNAL_RECORD_SIZE;
+            sum += record[0] + get_u32(record + 4) + get_u32(record + 8);
+        }
+        double ms = bench_now_ms() - start;
+        *checksum += sum;
+        if (ms < best)
+            best = ms;
+    }
+    unmap_file(&f);
+    return best;
+}
+
+// De snelste tijd (in ms) van een memcpy van size bytes: de bovengrens voor 1 doorloop over het journal.
+static double time_memcpy(size_t size, int repeat, uint64_t *checksum)
+{
+    uint8_t *src = (uint8_t *)malloc(size), *dst = (uint8_t *)malloc(size);
+    if (!src || !dst)
+    {
+        free(src);
+        free(dst);
+        return -1;
+    }
+    memset(src, 1, size);
+    memset(dst, 0, size);
+    double best = 1e30;
+    for (int r = 0; r < repeat; ++r)
+    {
+        double start = bench_now_ms();
+        memcpy(dst, src, size);
+        double ms = bench_now_ms() - start;
+        *checksum += dst[size / 2];
+        if (ms < best)
+            best = ms;
+    }
+    free(src);
+    free(dst);
+    return best;
+}
+
+int main(int argc, char **argv)
+{
+    int n = bench_arg(argc, argv, 1, 2000);
+    size_t count = (size_t)bench_arg(argc, argv, 2, 1000000);
+    int repeat = bench_arg(argc, argv, 3, 3);
+    const char *filename = argc > 4 ? argv[4] : "bench_journal.tmp";
+
+    // Een speelveld na de eerste klik in het midden: de mijnen liggen vast, een deel is uncovered.
+    Game *game = game_new(n, n, n * n / 6);
+    if (!game)
+    {
+        fprintf(stderr, "Out of memory for a %dx%d board\n", n, n);
+        return 1;
+    }
+    game->seed = 42;
+    game_reveal(game, n / 2, n / 2);
+
+    printf("%dx%d board, %zu records (%.1f MB), best of %d\n", n, n, count, count * JOURNAL_RECORD_SIZE / 1e6, repeat);
+    if (write_journal(filename, game, JOURNAL_FLAG, 0, 1) != 0)
+    {
+        fprintf(stderr, "Could not write %s\n", filename);
+        game_free(game);
+        return 1;
+    }
+    double snapshot_ms = time_replay(filename, repeat);
+
+    uint64_t checksum = 0;
+    double record_mb = count * JOURNAL_RECORD_SIZE / 1e6;
+    double memcpy_ms = time_memcpy(count * JOURNAL_RECORD_SIZE, repeat, &checksum);
+    printf("%-10s %12s %12s %12s\n", "", "ms", "MB/s", "ns/record");
+    printf("%-10s %12.2f %12s %12s\n", "snapshot", snapshot_ms, "-", "-");
+    printf("%-10s %12.2f %12.0f %12.2f\n", "memcpy", memcpy_ms, record_mb / memcpy_ms * 1e3, memcpy_ms * 1e6 / count);
+
+    static const JournalRecordType types[] = {JOURNAL_FLAG, JOURNAL_REVEAL};
+    static const char *names[] = {"flags", "reveals"};
+    int result = 0;
+    for (int t = 0; t < 2 && result == 0; ++t)
+    {
+        if (write_journal(filename, game, types[t], count, 2 + t) != 0)
+        {
+            result = 1;
+            break;
+        }
+        if (t == 0)
+        {
+            double decode_ms = time_decode(filename, count, repeat, &checksum);
+            printf("%-10s %12.2f %12.0f %12.2f\n", "decode", decode_ms, record_mb / decode_ms * 1e3, decode_ms * 1e6 / count);
+        }
+        // De tijd van de records alleen: zonder het inlezen van de momentopname.
+        double ms = time_replay(filename, repeat) - snapshot_ms;
+        printf("%-10s %12.2f %12.0f %12.2f\n", names[t], ms, record_mb / ms * 1e3, ms * 1e6 / count);
+    }
+    printf("(checksum %llu)\n", (unsigned long long)checksum);
+    remove(filename);
+    game_free(game);
+    return result;
+}
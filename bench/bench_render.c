@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <SDL2/SDL.h>
+#include "bench.h"
+
+/*
+ * Meet de frametijd van het tekenen van een volledig speelveld (standaard 500x500) op 2 manieren:
+ * - het oude pad: 12 aparte textures en 1 SDL_RenderCopy per cell, waarbij de texture per cell wisselt;
+ * - het atlas pad van de GUI: 1 texture atlas en alle cellen in batches via SDL_RenderGeometry.
+ * Elke frame wordt het hele speelveld getekend (zonder board texture), zodat enkel het verschil in submission gemeten wordt.
+ * De afbeeldingen worden uit Images/ geladen, dus de benchmark moet vanuit de root van de repo gestart worden.
+ *
+ * Gebruik: bench_render [grootte] [frames] [cell grootte in pixels]
+ * Zonder scherm kan de benchmark met SDL_VIDEODRIVER=dummy (software renderer) draaien.
+ */
+
+#define IMAGE_SIZE 50
+#define TILE_COUNT 12
+#define BATCH_MAX_CELLS 16384
+
+static const char *tile_files[TILE_COUNT] = {
+    "Images/0.bmp", "Images/1.bmp", "Images/2.bmp",
+    "Images/3.bmp", "Images/4.bmp", "Images/5.bmp",
+    "Images/6.bmp", "Images/7.bmp", "Images/8.bmp",
+    "Images/covered.bmp", "Images/flagged.bmp", "Images/mine.bmp"};
+
+static SDL_Renderer *renderer;
+static SDL_Texture *tile_textures[TILE_COUNT];
+static SDL_Texture *atlas_texture;
+static SDL_Vertex *batch_vertices;
+static int *batch_indices;
+
+// Dezelfde keuze van tegel als cell_tile in de GUI (9 = covered, 10 = flagged, 11 = mijn).
+static int cell_tile(Cell c)
+{
+    if (cell_has(c, CELL_UNCOVERED))
+        return cell_is_mine(c) ? 11 : cell_neighbour_mines(c);
+    return cell_has(c, CELL_FLAGGED) ? 10 : 9;
+}
+
+// Laadt de afbeeldingen als 12 aparte textures (oud pad) en als 1 atlas (nieuw pad). Geeft false terug bij een fout.
+static bool load_textures()
+{
+    SDL_Surface *atlas = SDL_CreateRGBSurfaceWithFormat(0, TILE_COUNT * IMAGE_SIZE, IMAGE_SIZE, 32, SDL_PIXELFORMAT_RGBA8888);
+    if (!atlas)
+        return false;
+    SDL_FillRect(atlas, NULL, SDL_MapRGBA(atlas->format, 255, 255, 255, 255));
+    for (int i = 0; i < TILE_COUNT; ++i)
+    {
+        SDL_Surface *s = SDL_LoadBMP(tile_files[i]);
+        if (!s)
+        {
+            // Zonder afbeelding gebruiken we een witte tegel, zodat er toch 12 aparte textures zijn.
+            SDL_Log("Failed to load image %s: %s", tile_files[i], SDL_GetError());
+            s = SDL_CreateRGBSurfaceWithFormat(0, IMAGE_SIZE, IMAGE_SIZE, 32, SDL_PIXELFORMAT_RGBA8888);
+            if (!s)
+            {
+                SDL_FreeSurface(atlas);
+                return false;
+            }
+            SDL_FillRect(s, NULL, SDL_MapRGBA(s->format, 255, 255, 255, 255));
+        }
+        tile_textures[i] = SDL_CreateTextureFromSurface(renderer, s);
+        SDL_Rect dst = {i * IMAGE_SIZE, 0, IMAGE_SIZE, IMAGE_SIZE};
+        SDL_SetSurfaceBlendMode(s, SDL_BLENDMODE_NONE);
+        SDL_BlitScaled(s, NULL, atlas, &dst);
+        SDL_FreeSurface(s);
+        if (!tile_textures[i])
+        {
+            SDL_FreeSurface(atlas);
+            return false;
+        }
+    }
+    atlas_texture = SDL_CreateTextureFromSurface(renderer, atlas);
+    SDL_FreeSurface(atlas);
+
+    batch_vertices = (SDL_Vertex *)malloc(BATCH_MAX_CELLS * 4 * sizeof(SDL_Vertex));
+    batch_indices = (int *)malloc(BATCH_MAX_CELLS * 6 * sizeof(int));
+    if (!atlas_texture || !batch_vertices || !batch_indices)
+        return false;
+    for (int i = 0; i < BATCH_MAX_CELLS; ++i)
+    {
+        int *q = &batch_indices[i * 6];
+        q[0] = i * 4, q[1] = i * 4 + 1, q[2] = i * 4 + 2;
+        q[3] = i * 4 + 1, q[4] = i * 4 + 3, q[5] = i * 4 + 2;
+    }
+    return true;
+}
+
+// Het oude pad: per cell 1 SDL_RenderCopy met de texture van die cell.
+static void draw_old(const Board *b, int size)
+{
+    for (int row = 0; row < b->height; ++row)
+    {
+        for (int col = 0; col < b->width; ++col)
+        {
+            SDL_Rect dst = {col * size, row * size, size, size};
+            SDL_RenderCopy(renderer, tile_textures[cell_tile(MAP_CELL(b, col, row))], NULL, &dst);
+        }
+    }
+}
+
+// Het atlas pad: quads verzamelen en per BATCH_MAX_CELLS cellen 1 SDL_RenderGeometry call.
+static bool draw_atlas(const Board *b, int size)
+{
+    SDL_Color white = {255, 255, 255, 255};
+    int cells = 0;
+    for (int row = 0; row < b->height; ++row)
+    {
+        for (int col = 0; col < b->width; ++col)
+        {
+            int tile = cell_tile(MAP_CELL(b, col, row));
+            float x0 = (float)(col * size), y0 = (float)(row * size), x1 = x0 + size, y1 = y0 + size;
+            float u0 = (float)tile / TILE_COUNT, u1 = (float)(tile + 1) / TILE_COUNT;
+            SDL_Vertex *v = &batch_vertices[cells * 4];
+            v[0] = (SDL_Vertex){{x0, y0}, white, {u0, 0.0f}};
+            v[1] = (SDL_Vertex){{x1, y0}, white, {u1, 0.0f}};
+            v[2] = (SDL_Vertex){{x0, y1}, white, {u0, 1.0f}};
+            v[3] = (SDL_Vertex){{x1, y1}, white, {u1, 1.0f}};
+            if (++cells == BATCH_MAX_CELLS)
+            {
+                if (SDL_RenderGeometry(renderer, atlas_texture, batch_vertices, cells * 4, batch_indices, cells * 6) != 0)
+                    return false;
+                cells = 0;
+            }
+        }
+    }
+    return cells == 0 || SDL_RenderGeometry(renderer, atlas_texture, batch_vertices, cells * 4, batch_indices, cells * 6) == 0;
+}
+
+// Tekent het aantal frames met het gegeven pad en geeft de gemiddelde frametijd in ms terug (negatief bij een fout).
+static double time_frames(const Board *b, int size, int frames, bool atlas)
+{
+    double t0 = bench_now_ms();
+    for (int i = 0; i < frames; ++i)
+    {
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+        SDL_RenderClear(renderer);
+        if (atlas && !draw_atlas(b, size))
+            return -1;
+        if (!atlas)
+            draw_old(b, size);
+        SDL_RenderPresent(renderer);
+    }
+    return (bench_now_ms() - t0) / frames;
+}
+
+int main(int argc, char **argv)
+{
+    int n = bench_arg(argc, argv, 1, 500);
+    int frames = bench_arg(argc, argv, 2, 20);
+    int size = bench_arg(argc, argv, 3, 2);
+
+    Board b;
+    if (bench_board(&b, n, n, n * n / 6, 42) != 0)
+    {
+        fprintf(stderr, "Out of memory for a %dx%d board\n", n, n);
+        return 1;
+    }
+    // Een speelveld halverwege een spel: ongeveer de helft uncovered en enkele vlaggen, zodat alle tegels voorkomen.
+    for (size_t i = 0; i < map_cell_count(&b); ++i)
+    {
+        if (i % 7 == 3)
+            cell_set(&b.cells[i], CELL_FLAGGED, true);
+        else if ((i / (size_t)n + i) % 2 == 0)
+            cell_set(&b.cells[i], CELL_UNCOVERED, true);
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO) != 0)
+    {
+        fprintf(stderr, "Could not initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_Window *window = SDL_CreateWindow("bench_render", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, n * size, n * size, SDL_WINDOW_HIDDEN);
+    renderer = window ? SDL_CreateRenderer(window, -1, 0) : NULL;
+    if (!renderer)
+    {
+        fprintf(stderr, "Could not create a renderer: %s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_RendererInfo info;
+    SDL_GetRendererInfo(renderer, &info);
+    if (!load_textures())
+    {
+        fprintf(stderr, "Could not create the textures: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    // 1 opwarm-frame per pad, zodat het uploaden van textures niet meetelt.
+    time_frames(&b, size, 1, false);
+    time_frames(&b, size, 1, true);
+    double old_ms = time_frames(&b, size, frames, false);
+    double atlas_ms = time_frames(&b, size, frames, true);
+
+    printf("%dx%d board, %d px cells, renderer %s, %d frames\n", n, n, size, info.name, frames);
+    printf("old (1 texture per tile):  %8.2f ms/frame\n", old_ms);
+    if (atlas_ms < 0)
+        printf("atlas (SDL_RenderGeometry): not supported: %s\n", SDL_GetError());
+    else
+        printf("atlas (SDL_RenderGeometry): %8.2f ms/frame (%.1fx)\n", atlas_ms, old_ms / atlas_ms);
+
+    for (int i = 0; i < TILE_COUNT; ++i)
+        SDL_DestroyTexture(tile_textures[i]);
+    SDL_DestroyTexture(atlas_texture);
+    free(batch_vertices);
+    free(batch_indices);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    free_map(&b);
+    return 0;
+}
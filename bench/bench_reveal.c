@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "reveal.h"
+
+/*
+ * Vergelijkt de scanline reveal engine met het oude algoritme: een stack van cellen waarop elke cell tot 8 keer gepusht kan worden.
+ * Het oude algoritme gebruikte 2 VLAs van width * height ints op de C stack, wat op grote velden crasht;
+ * hier gebruiken we voor die versie een groeiende heap-array zodat de vergelijking ook op grote velden kan lopen.
+ * Beide versies vertrekken van dezelfde kopie van het speelveld, en we controleren dat het resultaat identiek is.
+ *
+ * Gebruik: bench_reveal [max grootte] [mijnen per 1000 cellen]
+ */
+
+typedef struct
+{
+    int x;
+    int y;
+} StackCell;
+
+// Het oude algoritme (flood_reveal uit game.c), enkel de stack staat op de heap. Geeft -1 terug als de stack niet meer kan groeien.
+static long old_flood_reveal(Board *b, int start_x, int start_y)
+{
+    size_t capacity = 1024, count = 0;
+    StackCell *stack = (StackCell *)malloc(capacity * sizeof(StackCell));
+    if (!stack)
+        return -1;
+    long uncovered = 0;
+    stack[count++] = (StackCell){start_x, start_y};
+
+    while (count > 0)
+    {
+        StackCell curr = stack[--count];
+        if (!map_in_bounds(b, curr.x, curr.y))
+            continue;
+        if (cell_has(MAP_CELL(b, curr.x, curr.y), CELL_UNCOVERED))
+            continue;
+        cell_set(&MAP_CELL(b, curr.x, curr.y), CELL_UNCOVERED, true);
+        uncovered++;
+        if (cell_neighbour_mines(MAP_CELL(b, curr.x, curr.y)) != 0)
+            continue;
+        for (int dx = -1; dx <= 1; dx++)
+        {
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                int nx = curr.x + dx, ny = curr.y + dy;
+                if ((dx == 0 && dy == 0) || !map_in_bounds(b, nx, ny))
+                    continue;
+                Cell n = MAP_CELL(b, nx, ny);
+                if (cell_has(n, CELL_UNCOVERED) || cell_has(n, CELL_FLAGGED))
+                    continue;
+                if (count == capacity)
+                {
+                    StackCell *grown = (StackCell *)realloc(stack, capacity * 2 * sizeof(StackCell));
+                    if (!grown)
+                    {
+                        free(stack);
+                        return -1;
+                    }
+                    stack = grown;
+                    capacity *= 2;
+                }
+                stack[count++] = (StackCell){nx, ny};
+            }
+        }
+    }
+    free(stack);
+    return uncovered;
+}
+
+// Zoekt de nul-cell die het dichtst bij het midden ligt (in leesvolgorde vanaf het midden).
+static size_t find_zero(const Board *b)
+{
+    size_t cells = map_cell_count(b);
+    for (size_t k = 0; k < cells; ++k)
+    {
+        size_t i = (cells / 2 + k) % cells;
+        if (b->cells[i] == 0)
+            return i;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int max_size = bench_arg(argc, argv, 1, 4000);
+    int per_mille = bench_arg(argc, argv, 2, 20);
+
+    printf("%-12s %10s %12s %14s %8s\n", "board", "revealed", "old (ms)", "scanline (ms)", "speedup");
+    for (int size = 500; size <= max_size; size *= 2)
+    {
+        Board original, old_board, new_board;
+        int mines = (int)((long long)size * size * per_mille / 1000);
+        if (bench_board(&original, size, size, mines, 42) != 0 || init_map(&old_board, size, size, mines) != 0 ||
+            init_map(&new_board, size, size, mines) != 0)
+        {
+            fprintf(stderr, "Out of memory for a %dx%d board\n", size, size);
+            return 1;
+        }
+        size_t start = find_zero(&original);
+        int sx = (int)(start % (size_t)size), sy = (int)(start / (size_t)size);
+        memcpy(old_board.cells, original.cells, map_cell_count(&original));
+        memcpy(new_board.cells, original.cells, map_cell_count(&original));
+
+        double t0 = bench_now_ms();
+        long old_uncovered = old_flood_reveal(&old_board, sx, sy);
+        double t1 = bench_now_ms();
+        RevealEngine engine;
+        reveal_init(&engine);
+        long new_uncovered = reveal_cascade(&engine, &new_board, sx, sy, NULL);
+        double t2 = bench_now_ms();
+        reveal_free(&engine);
+
+        if (old_uncovered < 0)
+        {
+            fprintf(stderr, "%dx%d: out of memory for the stack of the old algorithm\n", size, size);
+            return 1;
+        }
+        if (old_uncovered != new_uncovered || memcmp(old_board.cells, new_board.cells, map_cell_count(&original)) != 0)
+        {
+            fprintf(stderr, "%dx%d: scanline result differs from the old algorithm\n", size, size);
+            return 1;
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "%dx%d", size, size);
+        printf("%-12s %10ld %12.2f %14.2f %7.1fx\n", name, new_uncovered, t1 - t0, t2 - t1, (t1 - t0) / (t2 - t1));
+
+        free_map(&original);
+        free_map(&old_board);
+        free_map(&new_board);
+    }
+    return 0;
+}
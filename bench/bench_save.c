@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "files.h"
+
+/*
+ * Meet de doorvoer (MB/s) van het wegschrijven van een speelveld:
+ * - het oude tekstformaat: 2 fputc's per cell, kolom per kolom (stride width door het geheugen), met 3 tijdelijke arrays;
+ * - save_field: beide grids rij per rij in 1 buffer en 1 write call, met en zonder fsync + rename;
+ * - save_field_binary ter vergelijking.
+ * Per variant nemen we de snelste van een aantal herhalingen.
+ *
+ * Gebruik: bench_save [grootte] [herhalingen] [bestandsnaam]
+ */
+
+// De oude save_field (van voor de buffer), met de 3 arrays die save_game vroeger aanmaakte.
+static int old_save_field(const char *filename, const Board *b)
+{
+    int w = b->width, h = b->height;
+    size_t cells = map_cell_count(b);
+    char *map = (char *)malloc(cells), *flagged = (char *)malloc(cells), *uncovered = (char *)malloc(cells);
+    FILE *out = fopen(filename, "w");
+    if (!map || !flagged || !uncovered || !out)
+        return -1;
+    for (size_t i = 0; i < cells; ++i)
+    {
+        map[i] = cell_is_mine(b->cells[i]) ? 'M' : (char)('0' + cell_neighbour_mines(b->cells[i]));
+        flagged[i] = cell_has(b->cells[i], CELL_FLAGGED);
+        uncovered[i] = cell_has(b->cells[i], CELL_UNCOVERED);
+    }
+    for (int x = 0; x < w; ++x)
+    {
+        for (int y = 0; y < h; ++y)
+        {
+            fputc(map[y * w + x], out);
+            fputc(' ', out);
+        }
+        fputc('\n', out);
+    }
+    fputc('\n', out);
+    for (int x = 0; x < w; ++x)
+    {
+        for (int y = 0; y < h; ++y)
+        {
+            int i = y * w + x;
+            fputc(flagged[i] ? 'F' : uncovered[i] ? 'U' : '#', out);
+            fputc(' ', out);
+        }
+        fputc('\n', out);
+    }
+    fclose(out);
+    free(map);
+    free(flagged);
+    free(uncovered);
+    return 0;
+}
+
+// Geeft de grootte van het bestand in bytes terug.
+static long file_size(const char *filename)
+{
+    FILE *f = fopen(filename, "rb");
+    if (!f)
+        return -1;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    return size;
+}
+
+// Schrijft het speelveld repeat keer met de gegeven variant en print de beste doorvoer.
+static int run(const char *name, const char *filename, const Board *b, int repeat, int variant)
+{
+    double best = -1;
+    for (int r = 0; r < repeat; ++r)
+    {
+        double t0 = bench_now_ms();
+        int result = variant == 0   ? old_save_field(filename, b)
+                     : variant == 1 ? save_field(filename, b, false)
+                     : variant == 2 ? save_field(filename, b, true)
+                                    : save_field_binary(filename, b, 42, false);
+        double ms = bench_now_ms() - t0;
+        if (result != 0)
+        {
+            fprintf(stderr, "%s: could not write %s\n", name, filename);
+            return -1;
+        }
+        if (best < 0 || ms < best)
+            best = ms;
+    }
+    long size = file_size(filename);
+    // Het binaire formaat is veel kleiner, dus we tonen ook het aantal cellen per seconde.
+    printf("%-26s %10.2f MB %10.2f ms %10.1f MB/s %10.1f Mcells/s\n", name, size / 1e6, best, size / 1e3 / best,
+           map_cell_count(b) / 1e3 / best);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int n = bench_arg(argc, argv, 1, 4000);
+    int repeat = bench_arg(argc, argv, 2, 3);
+    const char *filename = argc > 3 ? argv[3] : "bench_save.tmp";
+
+    Board b;
+    if (bench_board(&b, n, n, n * n / 6, 42) != 0)
+    {
+        fprintf(stderr, "Out of memory for a %dx%d board\n", n, n);
+        return 1;
+    }
+    for (size_t i = 0; i < map_cell_count(&b); ++i)
+    {
+        if (i % 7 == 3)
+            cell_set(&b.cells[i], CELL_FLAGGED, true);
+        else if (i % 3 == 0)
+            cell_set(&b.cells[i], CELL_UNCOVERED, true);
+    }
+
+    printf("%dx%d board, best of %d\n", n, n, repeat);
+    int result = run("old (fputc, column-major)", filename, &b, repeat, 0) || run("save_field", filename, &b, repeat, 1) ||
+                 run("save_field (fsync)", filename, &b, repeat, 2) || run("save_field_binary", filename, &b, repeat, 3);
+    remove(filename);
+    free_map(&b);
+    return result ? 1 : 0;
+}
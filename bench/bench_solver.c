@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "game.h"
+#include "solver.h"
+#include "rng.h"
+
+/*
+ * Meet de tijd per solver_step (het doel is minder dan 1 ms per stap) over een corpus van speelvelden.
+ * Elk speelveld wordt vanaf zijn toestand verder gespeeld: per stap vraagt de solver de zekere zetten, en alle veilige cellen worden uncovered.
+ * Loopt de solver vast, dan uncoveren we een willekeurige veilige cell (we kennen het speelveld), zodat ook de latere toestanden
+ * van een spel gemeten worden.
+ *
+ * Gebruik: bench_solver [field_*.txt ...]
+ * Zonder bestanden wordt een corpus gegenereerd: een aantal spellen per standaard moeilijkheid en enkele grotere speelvelden.
+ */
+
+#define TARGET_MS 1.0
+
+typedef struct
+{
+    double *ms;
+    size_t count;
+    size_t capacity;
+} Timings;
+
+static int timings_add(Timings *t, double ms)
+{
+    if (t->count == t->capacity)
+    {
+        size_t capacity = t->capacity ? t->capacity * 2 : 1024;
+        double *grown = (double *)realloc(t->ms, capacity * sizeof(double));
+        if (!grown)
+            return -1;
+        t->ms = grown;
+        t->capacity = capacity;
+    }
+    t->ms[t->count++] = ms;
+    return 0;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Print het gemiddelde, de p50, p99 en het maximum van de stappen, en of het doel gehaald is.
+static void timings_report(const char *name, Timings *t)
+{
+    if (t->count == 0)
+    {
+        printf("%-28s no steps\n", name);
+        return;
+    }
+    qsort(t->ms, t->count, sizeof(double), compare_double);
+    double sum = 0;
+    size_t over = 0;
+    for (size_t i = 0; i < t->count; ++i)
+    {
+        sum += t->ms[i];
+        over += t->ms[i] >= TARGET_MS;
+    }
+    double p99 = t->ms[(t->count - 1) * 99 / 100];
+    printf("%-28s %8zu %9.3f %9.3f %9.3f %9.3f %8zu  %s\n", name, t->count, sum / t->count, t->ms[(t->count - 1) / 2], p99,
+           t->ms[t->count - 1], over, p99 < TARGET_MS ? "ok" : "over target");
+    t->count = 0;
+}
+
+// Uncovert een willekeurige covered cell die geen mijn is; geeft false terug als er geen meer is.
+static bool reveal_random_safe(Game *game, Rng *rng)
+{
+    Board *b = &game->board;
+    size_t cells = map_cell_count(b);
+    size_t start = (size_t)rng_bounded(rng, cells);
+    for (size_t k = 0; k < cells; ++k)
+    {
+        size_t i = (start + k) % cells;
+        if (!cell_is_mine(b->cells[i]) && !cell_has(b->cells[i], CELL_UNCOVERED))
+            return game_reveal(game, (int)(i % (size_t)b->width), (int)(i / (size_t)b->width));
+    }
+    return false;
+}
+
+// Speelt het spel vanaf zijn huidige toestand uit, en meet elke solver_step.
+static int play(Game *game, Solver *solver, Timings *t, Rng *rng)
+{
+    while (game_status(game) == GAME_PLAYING)
+    {
+        double t0 = bench_now_ms();
+        if (solver_step(solver, game) != 0 || timings_add(t, bench_now_ms() - t0) != 0)
+            return -1;
+        int width = game->board.width;
+        for (size_t i = 0; i < solver->safe_count; ++i)
+            game_reveal(game, solver->safe[i] % width, solver->safe[i] / width);
+        if (solver->safe_count == 0 && !reveal_random_safe(game, rng))
+            break;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    Solver solver;
+    solver_init(&solver);
+    Timings t = {NULL, 0, 0};
+    Rng rng;
+    rng_seed(&rng, 42);
+
+    printf("%-28s %8s %9s %9s %9s %9s %8s\n", "corpus", "steps", "mean ms", "p50 ms", "p99 ms", "max ms", ">= 1 ms");
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            Game *game = game_load(argv[i]);
+            if (!game)
+            {
+                fprintf(stderr, "Could not load %s\n", argv[i]);
+                continue;
+            }
+            if (play(game, &solver, &t, &rng) != 0)
+                fprintf(stderr, "%s: out of memory\n", argv[i]);
+            game_free(game);
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "%d saved fields", argc - 1);
+        timings_report(name, &t);
+    }
+    else
+    {
+        static const struct
+        {
+            int w, h, mines, games;
+        } corpus[] = {{9, 9, 10, 200}, {16, 16, 40, 200}, {30, 16, 99, 200}, {100, 100, 1600, 20}, {300, 300, 14400, 3}};
+        for (size_t c = 0; c < sizeof(corpus) / sizeof(corpus[0]); ++c)
+        {
+            Game *game = game_new(corpus[c].w, corpus[c].h, corpus[c].mines);
+            if (!game)
+                return 1;
+            game->threads = 1;
+            for (int g = 0; g < corpus[c].games; ++g)
+            {
+                game_reset(game, rng_next(&rng));
+                game_reveal(game, corpus[c].w / 2, corpus[c].h / 2);
+                if (play(game, &solver, &t, &rng) != 0)
+                    fprintf(stderr, "Out of memory\n");
+            }
+            game_free(game);
+            char name[32];
+            snprintf(name, sizeof(name), "%dx%d/%d (%d games)", corpus[c].w, corpus[c].h, corpus[c].mines, corpus[c].games);
+            timings_report(name, &t);
+        }
+    }
+    free(t.ms);
+    solver_free(&solver);
+    return 0;
+}
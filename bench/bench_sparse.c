@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "game.h"
+#include "rng.h"
+
+/*
+ * Vergelijkt een gewoon speelveld met het speelveld van -z (sparse.h) op grote speelvelden met weinig mijnen:
+ * het geheugen van het speelveld, de tijd om het aan te maken, de eerste klik (meestal een grote opening),
+ * en de gemiddelde tijd van een reeks willekeurige kliks daarna (vooral zinvol op het laatste, dichtere speelveld).
+ * Het gewone speelveld wordt eerst volledig gegenereerd (game_pregenerate), zodat de eerste klik enkel de cascade meet.
+ * Bij -z worden de mijnen pas bij de eerste klik geplaatst, dus daar zit het plaatsen mee in de tijd van de eerste klik.
+ *
+ * Gebruik: bench_sparse [breedte hoogte mijnen] [kliks]
+ */
+
+// Het geheugen van het speelveld: de cellen en de visited bitset bij een gewoon speelveld, de index en bitmaps bij -z.
+static size_t board_memory(const Game *game)
+{
+    if (game->sparse)
+        return sparse_memory(game->sparse);
+    return map_cell_count(&game->board) + game->reveal.visited_words * sizeof(uint64_t);
+}
+
+static int run(int w, int h, int mines, int clicks, bool sparse)
+{
+    double t0 = bench_now_ms();
+    Game *game = sparse ? game_new_sparse(w, h, mines) : game_new(w, h, mines);
+    if (!game)
+    {
+        printf("%-7s %dx%d: out of memory\n", sparse ? "sparse" : "dense", w, h);
+        return -1;
+    }
+    game->seed = 42;
+    game->threads = 1;
+    if (!sparse && game_pregenerate(game) != 0)
+    {
+        game_free(game);
+        printf("%-7s %dx%d: out of memory\n", "dense", w, h);
+        return -1;
+    }
+    double t1 = bench_now_ms();
+    game_reveal(game, w / 2, h / 2);
+    double t2 = bench_now_ms();
+    long long opened = game->uncovered_safe;
+
+    // Willekeurige kliks op covered cellen die geen mijn zijn; bij weinig mijnen is na de eerste klik bijna alles al open.
+    Rng rng;
+    rng_seed(&rng, 7);
+    int done = 0;
+    double click_ms = 0;
+    for (int i = 0; i < clicks * 10 && done < clicks && game_status(game) == GAME_PLAYING; ++i)
+    {
+        int x = (int)rng_bounded(&rng, (uint64_t)w), y = (int)rng_bounded(&rng, (uint64_t)h);
+        Cell c = game_cell(game, x, y);
+        if (cell_is_mine(c) || cell_has(c, CELL_UNCOVERED) || cell_has(c, CELL_FLAGGED))
+            continue;
+        double t3 = bench_now_ms();
+        game_reveal(game, x, y);
+        click_ms += bench_now_ms() - t3;
+        dirty_clear(&game->dirty);
+        done++;
+    }
+
+    char click[32] = "-";
+    if (done > 0)
+        snprintf(click, sizeof(click), "%.3f (%d)", click_ms / done, done);
+    printf("%-7s %6dx%-6d %9d %10.1f %10.2f %12lld %14s %10.1f\n", sparse ? "sparse" : "dense", w, h, mines, t1 - t0, t2 - t1,
+           opened, click, board_memory(game) / 1e6);
+    game_free(game);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static const struct
+    {
+        int w, h, mines;
+    } boards[] = {{2000, 2000, 4000}, {10000, 10000, 100000}, {20000, 20000, 40000}, {4000, 4000, 1600000}};
+    int clicks = bench_arg(argc, argv, 4, 1000);
+
+    printf("%-7s %13s %9s %10s %10s %12s %14s %10s\n", "board", "size", "mines", "setup ms", "click 1 ms", "opened", "click ms (n)",
+           "memory MB");
+    if (argc > 3)
+    {
+        int w = atoi(argv[1]), h = atoi(argv[2]), mines = atoi(argv[3]);
+        run(w, h, mines, clicks, false);
+        run(w, h, mines, clicks, true);
+        return 0;
+    }
+    for (size_t i = 0; i < sizeof(boards) / sizeof(boards[0]); ++i)
+    {
+        run(boards[i].w, boards[i].h, boards[i].mines, clicks, false);
+        run(boards[i].w, boards[i].h, boards[i].mines, clicks, true);
+    }
+    return 0;
+}
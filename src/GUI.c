@@ -5,7 +5,12 @@
 #include <stdbool.h>
 #include "GUI.h"
 #include "map.h"
-#include "files.h"
+#include "game.h"
+#include "save.h"
+#include "journal.h"
+#include "solver.h"
+#include "probability.h"
+#include "world.h"
 
 /*
  * Deze renderer wordt gebruikt om figuren in het venster te tekenen.
@@ -13,11 +18,37 @@
  */
 static SDL_Renderer *renderer;
 
-// Instantieer de variabelen voor het bijhouden van de textures.
-static SDL_Texture *digit_textures[9] = {NULL};
-static SDL_Texture *digit_covered_texture = NULL;
-static SDL_Texture *digit_flagged_texture = NULL;
-static SDL_Texture *digit_mine_texture = NULL;
+/*
+ * Alle afbeeldingen worden bij het opstarten in 1 texture atlas geplaatst, naast elkaar in tegels van DEFAULT_IMAGE_SIZE.
+ * Zo kunnen alle cellen van een frame in 1 batch (SDL_RenderGeometry) getekend worden, zonder tussen textures te wisselen.
+ */
+enum
+{
+    TILE_DIGIT_0 = 0, // de tegels 0 t.e.m. 8 zijn de nummers
+    TILE_COVERED = 9,
+    TILE_FLAGGED = 10,
+    TILE_MINE = 11,
+    TILE_BLANK = 12, // een witte tegel voor cellen die verwijderd zijn tijdens de win-animatie
+    TILE_COUNT = 13
+};
+static SDL_Texture *atlas_texture = NULL;
+
+/*
+ * De vertex en index buffers voor het batchen van cellen.
+ * Elke cell is een quad van 4 vertices en 6 indices; na BATCH_MAX_CELLS cellen wordt de batch doorgestuurd.
+ */
+#define BATCH_MAX_CELLS 16384
+static SDL_Vertex *batch_vertices = NULL;
+static int *batch_indices = NULL;
+static int batch_cells = 0;
+static bool geometry_supported = true;
+
+/*
+ * De persistente texture waarin het volledige speelveld getekend staat.
+ * Enkel cellen die veranderd zijn (volgens de dirty list van het spel) worden hierin opnieuw getekend.
+ */
+static SDL_Texture *board_texture = NULL;
+static bool board_texture_supported = true;
 
 // Instantieer de variabele voor het bijhouden van de display mode.
 static SDL_DisplayMode dm;
@@ -70,10 +101,15 @@ int determine_img_win_size(int cols, int rows, int *out_img_size, int *out_windo
         int max_width = dm.w / cols;
         int max_height = dm.h / rows;
         img_size = max_width < max_height ? max_width : max_height;
-        if (img_size < 20)
-            img_size = 20; // minimale grootte
+        if (img_size < MIN_IMAGE_SIZE)
+            img_size = MIN_IMAGE_SIZE; // minimale grootte
         window_widthidth = cols * img_size;
         window_heighteight = rows * img_size;
+        // Past het speelveld dan nog steeds niet, dan wordt het venster zo groot als het scherm en toont de camera een deel van het speelveld.
+        if (window_widthidth > dm.w)
+            window_widthidth = dm.w;
+        if (window_heighteight > dm.h)
+            window_heighteight = dm.h;
     }
 
     *out_img_size = img_size;
@@ -96,78 +132,341 @@ int mouse_y = 0;
  */
 int should_continue = 1;
 
+/*
+ * De camera bepaalt welk deel van het speelveld in het venster getoond wordt.
+ * camera_x en camera_y zijn de (wereld)pixel-coördinaten van de linkerbovenhoek van het venster, cell_size is de zoom.
+ * Tekenen en hit-testen gebeuren enkel via de camera, zodat de kost enkel afhangt van het aantal zichtbare cellen.
+ */
+static int cell_size = DEFAULT_IMAGE_SIZE;
+static int camera_x = 0;
+static int camera_y = 0;
+
+// De toestand van het verslepen van de camera met de middelste muisknop.
+static bool dragging = false;
+static int drag_start_x = 0, drag_start_y = 0;
+static int drag_camera_x = 0, drag_camera_y = 0;
+
 /*
  * Dit is het venster dat getoond zal worden en waarin het speelveld weergegeven wordt.
  * Dit venster wordt aangemaakt bij het initialiseren van de GUI en wordt weer afgebroken wanneer het spel ten einde komt.
  */
 static SDL_Window *window;
 
-// benodigde game state variabelen
-bool mines_placed = false;      // of de mijnen reeds geplaatst zijn via add_mines
-static bool show_mines = false; // via 'b' key
-static bool game_lost = false;
-static int losing_col = -1, losing_row = -1;
+// Het spel dat in dit venster gespeeld wordt. De spelregels zelf zitten in de headless game core (game.c).
+static Game *game = NULL;
+
+/*
+ * Met -e spelen we in plaats van game in een oneindige wereld (zie world.h); game is dan NULL.
+ * De camera is dan niet begrensd en de zichtbare cellen worden elke frame rechtstreeks uit de wereld getekend:
+ * een board texture en dirty list zijn er niet (de wereld heeft geen vaste afmetingen).
+ * De camera blijft binnen WORLD_CAMERA_LIMIT pixels van de oorsprong, zodat de pixel-coördinaten niet overflowen.
+ */
+static World *world = NULL;
+#define WORLD_CAMERA_LIMIT (1 << 28)
+
+// benodigde GUI state variabelen voor de animaties
 static uint32_t lose_start_time = 0;
-static bool game_won = false;
 static int win_remaining = 0;
 static uint32_t win_last_remove = 0;
-static bool show_all = false; // via 'p' key
 
-int init_states()
+/*
+ * Het opslaan via de 's' key gebeurt op een achtergrondthread, zodat een grote save geen frames doet haperen.
+ * De momentopname wordt op de hoofdthread genomen; de thread meldt het einde via een SDL user event (save_done_event).
+ * Er loopt hoogstens 1 save tegelijk.
+ */
+static SaveJob save_job;
+static SDL_Thread *save_thread = NULL;
+static uint32_t save_done_event = (uint32_t)-1;
+
+/*
+ * Het speelveld wordt op een achtergrondthread gegenereerd terwijl het venster opent (zie game_pregenerate),
+ * zodat de eerste klik niet moet wachten. Vóór de eerste actie die de mijnen nodig heeft, wachten we op die thread.
+ */
+static SDL_Thread *pregenerate_thread = NULL;
+
+/*
+ * Met -a (of bij het inladen van een journal) wordt elke zet in een journal bijgehouden.
+ * De records worden gebufferd en hoogstens elke JOURNAL_FLUSH_INTERVAL ms weggeschreven, niet bij elke klik.
+ */
+static Journal journal;
+static uint32_t journal_last_flush = 0;
+#define JOURNAL_FLUSH_INTERVAL 1000
+
+// De solver voor de 'h' key; zijn buffers worden hergebruikt tussen 2 hints.
+static Solver solver;
+
+/*
+ * De kansen op een mijn voor de heat overlay ('o' key) en voor een hint als er geen zekere zet is.
+ * Ze worden enkel herberekend als het spel veranderd is (probabilities_stale), en dan enkel voor de veranderde delen.
+ */
+static ProbabilityEngine probabilities;
+static bool probabilities_stale = true;
+static bool show_probabilities = false;
+
+// Het interval (in ms) tussen 2 stappen van de animaties.
+#define LOSE_BLINK_INTERVAL 1000
+#define WIN_REMOVE_INTERVAL 20
+
+/*
+ * Een grote cascade wordt over meerdere frames verdeeld (zie advance_reveal): per frame werken we seeds af in stukken
+ * van REVEAL_STEP_SEEDS, tot REVEAL_FRAME_BUDGET ms op zijn. Zo blijven tekenen en input vlot, en zie je de golf uitdijen.
+ */
+#define REVEAL_STEP_SEEDS 64
+#define REVEAL_FRAME_BUDGET 8
+
+/*
+ * Frame pacing: we tekenen enkel een nieuwe frame als er iets veranderd is (redraw_pending),
+ * en nooit vaker dan 1 keer per frame_interval ms (0 = geen limiet).
+ */
+static bool redraw_pending = true;
+static uint32_t frame_interval = 0;
+static uint32_t last_frame_time = 0;
+
+/*
+ * Berekent hoelang (in ms) read_input mag wachten op een event vooraleer er een nieuwe frame getekend moet worden.
+ * Dit is het eerstvolgende van: een uitstaande redraw of een lopende cascade (rekening houdend met de FPS limiet),
+ * de volgende knipper van de verloren mijn, en de volgende stap van de win-animatie. Geeft -1 terug als er niets gepland is (wachten tot er input is).
+ */
+static int next_wakeup(uint32_t now)
 {
-    // We initialiseren alle cell states op false
-    for (int y = 0; y < map_height; ++y)
+    int timeout = -1;
+    if (redraw_pending || (game && (game->dirty.full || game->dirty.count > 0 || game_reveal_pending(game))))
     {
-        for (int x = 0; x < map_width; ++x)
-        {
-            map[y][x].uncovered = false;
-            map[y][x].flagged = false;
-            map[y][x].removed = false;
-            map[y][x].saved_uncovered = false;
-        }
+        uint32_t since = now - last_frame_time;
+        timeout = since >= frame_interval ? 0 : (int)(frame_interval - since);
     }
-    return 0;
+    int deadline = -1;
+    GameStatus status = world ? world->status : game_status(game);
+    if (status == GAME_LOST && !(game && game->show_mines))
+        deadline = LOSE_BLINK_INTERVAL - (int)((now - lose_start_time) % LOSE_BLINK_INTERVAL);
+    else if (status == GAME_WON && win_remaining > 0)
+    {
+        uint32_t since = now - win_last_remove;
+        deadline = since >= WIN_REMOVE_INTERVAL ? 0 : (int)(WIN_REMOVE_INTERVAL - since);
+    }
+    if (deadline >= 0 && (timeout < 0 || deadline < timeout))
+        timeout = deadline;
+    // Gebufferde zetten in het journal moeten ook zonder nieuwe input weggeschreven worden.
+    if (journal.pending > 0)
+    {
+        uint32_t since = now - journal_last_flush;
+        deadline = since >= JOURNAL_FLUSH_INTERVAL ? 0 : (int)(JOURNAL_FLUSH_INTERVAL - since);
+        if (timeout < 0 || deadline < timeout)
+            timeout = deadline;
+    }
+    return timeout;
+}
+
+static int pregenerate_thread_main(void *data)
+{
+    return game_pregenerate((Game *)data);
+}
+
+// Wacht tot het speelveld op de achtergrond gegenereerd is (meestal is dat al lang gebeurd).
+static void finish_pregeneration()
+{
+    if (!pregenerate_thread)
+        return;
+    SDL_WaitThread(pregenerate_thread, NULL);
+    pregenerate_thread = NULL;
+}
+
+// Voegt een zet toe aan het journal (als dat actief is). Bij een schrijffout stoppen we met journalen.
+static void record_move(JournalRecordType type, int x, int y)
+{
+    if (!journal_is_open(&journal))
+        return;
+    if (journal.pending == 0)
+        journal_last_flush = SDL_GetTicks();
+    if (journal_record(&journal, game, type, x, y) != 0)
+    {
+        fprintf(stderr, "Error writing journal %s, journaling stopped\n", journal.filename);
+        journal_close(&journal, NULL);
+    }
+}
+
+// Schrijft de gebufferde zetten weg als ze al JOURNAL_FLUSH_INTERVAL ms wachten.
+static void flush_journal(uint32_t now)
+{
+    if (!journal_is_open(&journal) || journal.pending == 0 || now - journal_last_flush < JOURNAL_FLUSH_INTERVAL)
+        return;
+    journal_last_flush = now;
+    if (journal_flush(&journal, game) != 0)
+    {
+        fprintf(stderr, "Error writing journal %s, journaling stopped\n", journal.filename);
+        journal_close(&journal, NULL);
+    }
+}
+
+// Houdt de camera binnen het speelveld. Als het speelveld kleiner is dan het venster, staat het linksboven.
+static void camera_clamp()
+{
+    if (world)
+    {
+        camera_x = camera_x < -WORLD_CAMERA_LIMIT ? -WORLD_CAMERA_LIMIT : camera_x > WORLD_CAMERA_LIMIT ? WORLD_CAMERA_LIMIT : camera_x;
+        camera_y = camera_y < -WORLD_CAMERA_LIMIT ? -WORLD_CAMERA_LIMIT : camera_y > WORLD_CAMERA_LIMIT ? WORLD_CAMERA_LIMIT : camera_y;
+        return;
+    }
+    long long max_x = (long long)game->board.width * cell_size - curr_window_width;
+    long long max_y = (long long)game->board.height * cell_size - curr_window_height;
+    if (camera_x > max_x)
+        camera_x = (int)max_x;
+    if (camera_y > max_y)
+        camera_y = (int)max_y;
+    if (camera_x < 0)
+        camera_x = 0;
+    if (camera_y < 0)
+        camera_y = 0;
 }
 
 /*
- * Bij elke interactie, wordt het speeldveld in de console geprint.
- * Zie HOC Slides 4_input_output dia 10 voor putchar.
+ * Verplaatst de camera naar (x, y). Als het beeld verschuift, moet de board texture (die het venster bedekt)
+ * volledig opnieuw getekend worden; dat zijn enkel de zichtbare cellen.
  */
-static void print_view()
+static void camera_move_to(int x, int y)
 {
-    for (int y = 0; y < map_height; ++y)
+    int old_x = camera_x, old_y = camera_y;
+    camera_x = x;
+    camera_y = y;
+    camera_clamp();
+    if (camera_x != old_x || camera_y != old_y)
     {
-        for (int x = 0; x < map_width; ++x)
-        {
-            if (map[y][x].uncovered)
-            {
-                if (map[y][x].is_mine)
-                    putchar('M');
-                else
-                    putchar('0' + map[y][x].neighbour_mines);
-            }
-            else if (map[y][x].flagged)
-            {
-                putchar('F');
-            }
-            else if (show_mines && map[y][x].is_mine)
-            {
-                putchar('M');
-            }
-            else
-            {
-                putchar('#');
-            }
-            putchar(' ');
-        }
-        putchar('\n');
+        if (game)
+            dirty_mark_all(&game->dirty);
+        redraw_pending = true;
+    }
+}
+
+/*
+ * Zoomt in (steps > 0) of uit (steps < 0) rond het punt (sx, sy) in het venster:
+ * het punt van het speelveld onder de muis blijft op dezelfde plaats staan.
+ */
+static void camera_zoom(int steps, int sx, int sy)
+{
+    int size = cell_size;
+    for (; steps > 0; --steps)
+        size = size * 5 / 4 > size ? size * 5 / 4 : size + 1;
+    for (; steps < 0; ++steps)
+        size = size * 4 / 5 < size ? size * 4 / 5 : size - 1;
+    if (size < MIN_CELL_SIZE)
+        size = MIN_CELL_SIZE;
+    if (size > MAX_CELL_SIZE)
+        size = MAX_CELL_SIZE;
+    if (size == cell_size)
+        return;
+    long long world_x = (long long)camera_x + sx, world_y = (long long)camera_y + sy;
+    int x = (int)(world_x * size / cell_size - sx);
+    int y = (int)(world_y * size / cell_size - sy);
+    cell_size = size;
+    camera_move_to(x, y);
+    // Ook als de camera niet verschuift, zijn alle zichtbare cellen van grootte veranderd.
+    if (game)
+        dirty_mark_all(&game->dirty);
+    redraw_pending = true;
+}
+
+// Deelt naar beneden afgerond, ook voor negatieve pixel-coördinaten (enkel in de wereld van -e).
+static int floor_div(long long a, int b)
+{
+    return (int)(a >= 0 ? a / b : -((-a - 1) / b) - 1);
+}
+
+// Zet een positie in het venster om naar een cell van het speelveld. Geeft false terug als er daar geen cell is.
+static bool screen_to_cell(int sx, int sy, int *col, int *row)
+{
+    if (sx < 0 || sy < 0)
+        return false;
+    *col = floor_div((long long)camera_x + sx, cell_size);
+    *row = floor_div((long long)camera_y + sy, cell_size);
+    return world || map_in_bounds(&game->board, *col, *row);
+}
+
+// Bepaalt de (inclusieve) rijen en kolommen van het speelveld die (deels) in het venster zichtbaar zijn.
+static void visible_cells(int *col0, int *row0, int *col1, int *row1)
+{
+    *col0 = floor_div(camera_x, cell_size);
+    *row0 = floor_div(camera_y, cell_size);
+    *col1 = floor_div((long long)camera_x + curr_window_width - 1, cell_size);
+    *row1 = floor_div((long long)camera_y + curr_window_height - 1, cell_size);
+    if (world)
+        return;
+    const Board *b = &game->board;
+    if (*col1 > b->width - 1)
+        *col1 = b->width - 1;
+    if (*row1 > b->height - 1)
+        *row1 = b->height - 1;
+}
+
+/*
+ * Verwerkt een (samengevoegde) muisbeweging naar (x, y): tijdens het verslepen verschuift de camera,
+ * anders wordt enkel de hover marker opnieuw getekend als de muis naar een andere cell bewogen is.
+ */
+static void apply_motion(int x, int y)
+{
+    if (dragging)
+        camera_move_to(drag_camera_x - (x - drag_start_x), drag_camera_y - (y - drag_start_y));
+    else if (floor_div((long long)camera_x + x, cell_size) != floor_div((long long)camera_x + mouse_x, cell_size) ||
+             floor_div((long long)camera_y + y, cell_size) != floor_div((long long)camera_y + mouse_y, cell_size))
+        redraw_pending = true;
+    mouse_x = x;
+    mouse_y = y;
+}
+
+/*
+ * Start de win-animatie: initialiseer de verwijder-lijst.
+ * Seed de RNG met huidige ticks zodat de verwijdervolgorde random is.
+ */
+static void start_win_animation()
+{
+    Board *b = &game->board;
+    // Een speelveld van -z heeft geen cellen om te verwijderen: het blijft staan tot de speler het venster sluit.
+    if (game->sparse)
+        return;
+    size_t cells = map_cell_count(b);
+    win_remaining = b->width * b->height;
+    for (size_t i = 0; i < cells; ++i)
+        cell_set(&b->cells[i], CELL_REMOVED, false); // nog niet verwijderd tijdens animatie
+    srand((unsigned int)SDL_GetTicks());
+}
+
+// Als een cascade klaar is: print het speelveld, en start de win-animatie als ze het laatste stuk uncoverde.
+static void report_reveal_finished()
+{
+    game_print_view(game);
+    probabilities_stale = true;
+    if (game_status(game) == GAME_WON)
+    {
+        printf("All number cells uncovered - you win!\n");
+        start_win_animation();
     }
-    putchar('\n');
+}
+
+// Werkt een lopende cascade meteen volledig af, voor acties die de volledige toestand nodig hebben (save, hint, show_all).
+static void finish_reveal()
+{
+    if (!game_reveal_pending(game))
+        return;
+    game_reveal_finish(game);
+    report_reveal_finished();
+}
+
+// Werkt de lopende cascade verder af, hoogstens REVEAL_FRAME_BUDGET ms per frame.
+static void advance_reveal()
+{
+    if (!game_reveal_pending(game))
+        return;
+    uint32_t start = SDL_GetTicks();
+    do
+        game_reveal_step(game, REVEAL_STEP_SEEDS);
+    while (game_reveal_pending(game) && SDL_GetTicks() - start < REVEAL_FRAME_BUDGET);
+    if (!game_reveal_pending(game))
+        report_reveal_finished();
 }
 
 /*
  * Controleert of het gegeven event "relevant" is voor dit spel.
- * We gebruiken in deze GUI enkel muiskliks, toetsdrukken, en de "Quit" van het venster, dus enkel deze soorten events zijn "relevant".
+ * We gebruiken in deze GUI enkel muiskliks, muisbewegingen (voor de hover marker en de camera), het muiswiel, toetsdrukken, de "Quit" van het venster
+ * en de events waarna opnieuw getekend moet worden, dus enkel deze soorten events zijn "relevant".
  */
 static int is_relevant_event(SDL_Event *event)
 {
@@ -176,105 +475,353 @@ static int is_relevant_event(SDL_Event *event)
         return 0;
     }
     return (event->type == SDL_MOUSEBUTTONDOWN) ||
+           (event->type == SDL_MOUSEBUTTONUP) ||
+           (event->type == SDL_MOUSEMOTION) ||
+           (event->type == SDL_MOUSEWHEEL) ||
            (event->type == SDL_KEYDOWN) ||
-           (event->type == SDL_QUIT);
+           (event->type == SDL_QUIT) ||
+           (event->type == SDL_WINDOWEVENT) ||
+           (event->type == SDL_RENDER_TARGETS_RESET) ||
+           (event->type == SDL_RENDER_DEVICE_RESET) ||
+           (save_done_event != (uint32_t)-1 && event->type == save_done_event);
 }
 
-// Deze functie vangt de input uit de GUI op (muiskliks en het indrukken van toetsen).
-void read_input()
+// De achtergrondthread voor het opslaan: schrijft de momentopname weg en meldt het resultaat aan de game loop.
+static int save_thread_main(void *data)
 {
+    int result = save_job_run((const SaveJob *)data);
     SDL_Event event;
-    bool changed = false;
-    int grid_rows = map_height, grid_cols = map_width;
-    int cell_w = curr_window_width / grid_cols;
-    int cell_h = curr_window_height / grid_rows;
+    memset(&event, 0, sizeof(event));
+    event.type = save_done_event;
+    event.user.code = result;
+    SDL_PushEvent(&event);
+    return result;
+}
 
-    /*
-     * Handelt alle input uit de GUI af.
-     * Telkens de speler een input in de GUI geeft (bv. een muisklik, muis bewegen, toetsindrukken
-     * enz.) wordt er een 'event' (van het type SDL_Event) gegenereerd dat hier wordt afgehandeld.
-     *
-     * Niet al deze events zijn relevant voor jou: als de muis bv. gewoon wordt bewogen, hoef
-     * je niet te reageren op dit event.
-     * We gebruiken daarom de is_relevant_event-functie om niet-gebruikte events weg te
-     * filteren, zonder dat ze de applicatie vertragen of de GUI minder responsief maken.
-     *
-     * Zie ook https://wiki.libsdl.org/SDL_PollEvent
-     */
-    while (1)
+static void report_save(int result)
+{
+    if (result != 0)
+        fprintf(stderr, "Error saving field to %s\n", save_job.filename);
+    else
+        printf("Saved field to %s\n", save_job.filename);
+}
+
+/*
+ * Start een save op de achtergrond. Als er geen thread aangemaakt kan worden, slaan we synchroon op.
+ * Een lopende cascade wordt eerst afgewerkt, zodat de save de toestand na de klik bevat (zoals het journal).
+ */
+static void start_save()
+{
+    if (save_thread)
     {
-        int event_polled = SDL_PollEvent(&event);
-        if (event_polled == 0)
+        printf("A save is already in progress\n");
+        return;
+    }
+    finish_reveal();
+    if (save_job_prepare(&save_job, game) != 0)
+    {
+        fprintf(stderr, "Error preparing save\n");
+        return;
+    }
+    printf("Saving field to %s...\n", save_job.filename);
+    save_thread = SDL_CreateThread(save_thread_main, "save", &save_job);
+    if (!save_thread)
+    {
+        SDL_Log("Failed to start save thread, saving synchronously: %s", SDL_GetError());
+        report_save(save_job_run(&save_job));
+    }
+}
+
+/*
+ * Werkt de kansen bij als het spel veranderd is sinds de vorige keer.
+ * Geeft false terug (en zet de overlay af) als het geheugen opraakt.
+ */
+static bool update_probabilities()
+{
+    if (!probabilities_stale)
+        return true;
+    if (probability_update(&probabilities, game) != 0)
+    {
+        fprintf(stderr, "Not enough memory for the mine probabilities\n");
+        show_probabilities = false;
+        return false;
+    }
+    probabilities_stale = false;
+    return true;
+}
+
+/*
+ * Hint via 'h' key: we vragen de solver naar de zekere zetten en voeren er 1 uit.
+ * Een veilige cell wordt uncovered; is er geen, dan vlaggen we een zekere mijn die nog geen vlag heeft.
+ */
+static void give_hint(bool *changed)
+{
+    Board *b = &game->board;
+    if (!game->mines_placed)
+    {
+        printf("No hint before the first click\n");
+        return;
+    }
+    // De solver moet de volledige toestand zien; de cascade kan het spel ook net gewonnen hebben.
+    finish_reveal();
+    if (game_status(game) != GAME_PLAYING)
+        return;
+    if (game->show_all)
+    {
+        printf("No hint while show_all is active\n");
+        return;
+    }
+    if (map_cell_count(b) > SOLVER_MAX_CELLS)
+    {
+        printf("No hint on a board with more than %zu cells\n", SOLVER_MAX_CELLS);
+        return;
+    }
+    if (solver_step(&solver, game) != 0)
+    {
+        fprintf(stderr, "Not enough memory for the solver\n");
+        return;
+    }
+
+    if (solver.safe_count > 0)
+    {
+        int x = solver.safe[0] % b->width, y = solver.safe[0] / b->width;
+        printf("Hint: cell (%d, %d) is safe (%zu safe cells, %zu certain mines)\n", x, y, solver.safe_count, solver.mine_count);
+        if (game_reveal(game, x, y))
         {
-            return;
+            record_move(JOURNAL_REVEAL, x, y);
+            *changed = true;
         }
-        else if (is_relevant_event(&event))
+        if (game_status(game) == GAME_WON)
         {
+            printf("All number cells uncovered - you win!\n");
+            start_win_animation();
+        }
+        return;
+    }
+    for (size_t i = 0; i < solver.mine_count; ++i)
+    {
+        int x = solver.mines[i] % b->width, y = solver.mines[i] / b->width;
+        if (cell_has(MAP_CELL(b, x, y), CELL_FLAGGED))
+            continue;
+        printf("Hint: cell (%d, %d) is a mine\n", x, y);
+        if (game_toggle_flag(game, x, y) == FLAG_CHANGED)
+        {
+            record_move(JOURNAL_FLAG, x, y);
+            *changed = true;
+        }
+        if (game_status(game) == GAME_WON)
+        {
+            printf("All mines flagged - you win!\n");
+            start_win_animation();
+        }
+        return;
+    }
+    // Geen zekere zet: we tonen de cell met de kleinste kans op een mijn (zonder ze te uncoveren).
+    if (!update_probabilities())
+        return;
+    int best = -1;
+    size_t cells = map_cell_count(b);
+    for (size_t i = 0; i < cells; ++i)
+    {
+        float p = probabilities.probability[i];
+        if (p >= 0.0f && (best < 0 || p < probabilities.probability[best]))
+            best = (int)i;
+    }
+    if (best < 0)
+        printf("Hint: no certain move, you will have to guess\n");
+    else
+        printf("Hint: no certain move, the safest guess is cell (%d, %d) with a mine probability of %.1f%%\n",
+               best % b->width, best / b->width, probabilities.probability[best] * 100.0f);
+}
+
+/*
+ * Handelt de events van de wereld van -e af (na de camera): kliks, de 's' key (opslaan) en het sluiten van het venster.
+ * Na verlies kan de speler enkel nog rondkijken, opslaan en afsluiten.
+ */
+static void handle_world_event(const SDL_Event *event, bool *changed)
+{
+    if (event->type == SDL_QUIT)
+    {
+        should_continue = 0;
+        return;
+    }
+    if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_s)
+    {
+        if (world_save(world) != 0)
+            fprintf(stderr, "Error saving world to %s\n", world->directory);
+        else
+            printf("Saved world to %s\n", world->directory);
+        return;
+    }
+    if (event->type != SDL_MOUSEBUTTONDOWN || world->status != GAME_PLAYING)
+        return;
+
+    mouse_x = event->button.x;
+    mouse_y = event->button.y;
+    int col, row;
+    if (!screen_to_cell(mouse_x, mouse_y, &col, &row))
+        return;
+    if (event->button.button == SDL_BUTTON_RIGHT)
+    {
+        *changed = world_toggle_flag(world, col, row) == FLAG_CHANGED;
+        return;
+    }
+    *changed = world_reveal(world, col, row);
+    if (world->status == GAME_LOST)
+    {
+        lose_start_time = SDL_GetTicks();
+        printf("You clicked a mine at (%d, %d) - you lose. Score: %llu\n", col, row, (unsigned long long)world->uncovered);
+    }
+}
+
+/*
+ * Handelt 1 relevant event af (behalve muisbewegingen, die worden samengevoegd in read_input).
+ * Als de toestand van het spel veranderd is, wordt *changed op true gezet.
+ */
+static void handle_event(const SDL_Event *event, bool *changed)
+{
+    // Elk event hier kan het beeld veranderen, dus we tekenen in de volgende frame opnieuw.
+    redraw_pending = true;
+
+    // Het venster moet opnieuw getekend worden (bv. nadat het bedekt was); de board texture blijft geldig.
+    if (event->type == SDL_WINDOWEVENT)
+        return;
+
+    // De inhoud van render target textures kan verloren gaan (bv. bij Direct3D); dan tekenen we het speelveld volledig opnieuw.
+    if (event->type == SDL_RENDER_TARGETS_RESET || event->type == SDL_RENDER_DEVICE_RESET)
+    {
+        if (event->type == SDL_RENDER_DEVICE_RESET && board_texture)
+        {
+            SDL_DestroyTexture(board_texture);
+            board_texture = NULL;
+        }
+        if (game)
+            dirty_mark_all(&game->dirty);
+        return;
+    }
+
+    // Een save op de achtergrond is klaar (ook na het einde van het spel).
+    if (event->type == save_done_event)
+    {
+        SDL_WaitThread(save_thread, NULL);
+        save_thread = NULL;
+        report_save(event->user.code);
+        return;
+    }
+
+    /*
+     * De camera kan ook na het einde van het spel nog bewogen worden:
+     * verslepen met de middelste muisknop, de pijltjestoetsen om te verschuiven en het muiswiel om te zoomen.
+     */
+    switch (event->type)
+    {
+    case SDL_MOUSEBUTTONDOWN:
+        if (event->button.button != SDL_BUTTON_MIDDLE)
             break;
+        dragging = true;
+        drag_start_x = event->button.x;
+        drag_start_y = event->button.y;
+        drag_camera_x = camera_x;
+        drag_camera_y = camera_y;
+        return;
+    case SDL_MOUSEBUTTONUP:
+        if (event->button.button == SDL_BUTTON_MIDDLE)
+            dragging = false;
+        return;
+    case SDL_MOUSEWHEEL:
+    {
+        int mx = 0, my = 0;
+        SDL_GetMouseState(&mx, &my);
+        camera_zoom(event->wheel.y, mx, my);
+        return;
+    }
+    case SDL_KEYDOWN:
+    {
+        // We verschuiven per 1/8 van het venster.
+        int step_x = curr_window_width / 8 > 0 ? curr_window_width / 8 : 1;
+        int step_y = curr_window_height / 8 > 0 ? curr_window_height / 8 : 1;
+        switch (event->key.keysym.sym)
+        {
+        case SDLK_LEFT:
+            camera_move_to(camera_x - step_x, camera_y);
+            return;
+        case SDLK_RIGHT:
+            camera_move_to(camera_x + step_x, camera_y);
+            return;
+        case SDLK_UP:
+            camera_move_to(camera_x, camera_y - step_y);
+            return;
+        case SDLK_DOWN:
+            camera_move_to(camera_x, camera_y + step_y);
+            return;
         }
+        break;
     }
+    }
+
+    if (world)
+    {
+        handle_world_event(event, changed);
+        return;
+    }
+    Board *b = &game->board;
 
     // Wanneer een game al gespeeld is (speler heeft al gewonnen/verloren), dan negeren we alle input en sluiten we het spel af.
-    if ((game_lost || game_won) && event.type != SDL_QUIT)
+    if (game_status(game) != GAME_PLAYING && event->type != SDL_QUIT)
     {
         return;
     }
 
-    switch (event.type)
+    // Vanaf hier kan het spel de mijnen plaatsen, dus moet het speelveld op de achtergrond klaar zijn.
+    finish_pregeneration();
+
+    switch (event->type)
     {
     case SDL_KEYDOWN:
-        if (event.key.keysym.sym == SDLK_p)
+        // De toetsen die elke cell van het speelveld nodig hebben (show_all, save, hint en overlay) werken niet met -z.
+        if (game->sparse && (event->key.keysym.sym == SDLK_p || event->key.keysym.sym == SDLK_s ||
+                             event->key.keysym.sym == SDLK_h || event->key.keysym.sym == SDLK_o))
         {
-            // Tijdelijk uncover alles via 'p' key
-            show_all = !show_all;
-            printf("Toggle show_all: %d\n", show_all);
-            if (show_all)
-            {
-                // sla tijdelijk vorige uncovered state op
-                for (int x = 0; x < map_width; ++x)
-                    for (int y = 0; y < map_height; ++y)
-                        map[y][x].saved_uncovered = map[y][x].uncovered;
-                // Voor de eerste muisklik, zijn er nog geen mijnen geplaatst.
-                // Voordat we alles uncoveren, moeten we dus eerst de mijnen plaatsen.
-                if (!mines_placed)
-                {
-                    create_map();
-                    init_states();
-                    add_mines(-1, -1);
-                    mines_placed = true;
-                }
-                // uncover alles tijdelijk
-                for (int x = 0; x < map_width; ++x)
-                    for (int y = 0; y < map_height; ++y)
-                        map[y][x].uncovered = true;
-                print_view();
-            }
-            else
-            {
-                // terugzetten van vorige uncovered state
-                for (int x = 0; x < map_width; ++x)
-                    for (int y = 0; y < map_height; ++y)
-                        map[y][x].uncovered = map[y][x].saved_uncovered;
-            }
-            changed = true;
+            printf("Not available on a sparse board (-z)\n");
         }
-        else if (event.key.keysym.sym == SDLK_b)
+        else if (event->key.keysym.sym == SDLK_p)
         {
-            // Zorg ervoor dat de map gegenereerd wordt, voordat we de mijnen kunnen tonen.
-            if (!mines_placed)
-            {
-                create_map();
-                init_states();
-                add_mines(-1, -1);
-                mines_placed = true;
-            }
-            show_mines = !show_mines;
-            printf("Toggle show_mines: %d\n", show_mines);
-            changed = true;
+            // Tijdelijk uncover alles via 'p' key (een lopende cascade wordt eerst afgewerkt, en kan het spel winnen)
+            finish_reveal();
+            if (game_status(game) != GAME_PLAYING)
+                break;
+            game_toggle_show_all(game);
+            record_move(JOURNAL_SHOW_ALL, 0, 0);
+            printf("Toggle show_all: %d\n", game->show_all);
+            if (game->show_all)
+                game_print_view(game);
+            *changed = true;
+        }
+        else if (event->key.keysym.sym == SDLK_b)
+        {
+            game_toggle_show_mines(game);
+            record_move(JOURNAL_SHOW_MINES, 0, 0);
+            printf("Toggle show_mines: %d\n", game->show_mines);
+            *changed = true;
+        }
+        else if (event->key.keysym.sym == SDLK_s)
+        {
+            start_save();
+        }
+        else if (event->key.keysym.sym == SDLK_h)
+        {
+            give_hint(changed);
+        }
+        else if (event->key.keysym.sym == SDLK_o && map_cell_count(&game->board) > SOLVER_MAX_CELLS)
+        {
+            printf("No probability overlay on a board with more than %zu cells\n", SOLVER_MAX_CELLS);
         }
-        else if (event.key.keysym.sym == SDLK_s)
+        else if (event->key.keysym.sym == SDLK_o)
         {
-            save_game();
+            // Toggle de heat overlay met de kans op een mijn per covered cell via 'o' key.
+            show_probabilities = !show_probabilities;
+            printf("Toggle probability overlay: %d\n", show_probabilities);
+            redraw_pending = true;
         }
         break;
     case SDL_QUIT:
@@ -286,352 +833,526 @@ void read_input()
          * De speler heeft met de muis geklikt:
          * We slaan de coördinaten van de muisklik op in de variabelen mouse_x en mouse_y.
          */
-        mouse_x = event.button.x;
-        mouse_y = event.button.y;
+        mouse_x = event->button.x;
+        mouse_y = event->button.y;
 
-        // Bereken de coördinaten van de geklikte cell.
-        int clicked_col = mouse_x / cell_w;
-        int clicked_row = mouse_y / cell_h;
+        // Bereken de coördinaten van de geklikte cell, via de camera.
+        int clicked_col, clicked_row;
+        if (!screen_to_cell(mouse_x, mouse_y, &clicked_col, &clicked_row))
+            break;
 
-        if (event.button.button == SDL_BUTTON_RIGHT)
+        if (event->button.button == SDL_BUTTON_RIGHT)
         {
-            /*
-             * Rechter muisknop: toggle een vlag op de cell.
-             * Maar alleen als we niet al het maximale aantal vlaggen hebben geplaatst.
-             */
-            // Zorg ervoor dat de map gegenereerd wordt, voordat we vlaggen kunnen plaatsen.
-            if (!mines_placed)
+            // Rechter muisknop: toggle een vlag op de cell. Een lopende cascade werken we eerst af (en melden we, bv. als ze het spel won).
+            finish_reveal();
+            if (game_status(game) != GAME_PLAYING)
+                break;
+            int result = game_toggle_flag(game, clicked_col, clicked_row);
+            if (result == FLAG_LIMIT_REACHED)
+            {
+                printf("Cannot place more flags (max: %d)\n", b->mines);
+            }
+            else if (result == FLAG_CHANGED)
+            {
+                record_move(JOURNAL_FLAG, clicked_col, clicked_row);
+                printf("Right click at (%d, %d) -> cell (%d, %d) flag: %d\n", mouse_x, mouse_y, clicked_col, clicked_row, (int)cell_has(game_cell(game, clicked_col, clicked_row), CELL_FLAGGED));
+                *changed = true;
+            }
+
+            // Als alle mijnen correct gevlagd zijn, start de win-animatie.
+            if (game_status(game) == GAME_WON)
             {
-                create_map();
-                init_states();
-                add_mines(-1, -1);
-                mines_placed = true;
+                printf("All mines flagged - you win!\n");
+                start_win_animation();
+                *changed = true;
             }
+        }
+        else
+        {
+            // Linker muisknop klik: uncover cell.
+            printf("Left click at (%d, %d) -> cell (%d, %d)\n", mouse_x, mouse_y, clicked_col, clicked_row);
+
+            bool first_click = !game->mines_placed;
+            if (game_reveal(game, clicked_col, clicked_row))
+            {
+                record_move(JOURNAL_REVEAL, clicked_col, clicked_row);
+                *changed = true;
+            }
+            if (first_click && game->no_guess)
+            {
+                if (game->generation_attempts > 0)
+                    printf("No-guess board found after %ld attempts\n", game->generation_attempts);
+                else
+                    printf("No no-guess board found, playing a regular board\n");
+            }
+
+            if (game_status(game) == GAME_LOST)
+            {
+                lose_start_time = SDL_GetTicks();
+                printf("You clicked a mine at (%d, %d) - you lose.\n", clicked_col, clicked_row);
+            }
+            else if (game_status(game) == GAME_WON)
+            {
+                printf("All number cells uncovered - you win!\n");
+                start_win_animation();
+            }
+        }
+        break;
+    }
+}
+
+// Deze functie vangt de input uit de GUI op (muiskliks, muisbewegingen en het indrukken van toetsen).
+void read_input()
+{
+    SDL_Event event;
+    bool changed = false;
+
+    /*
+     * Handelt alle input uit de GUI af.
+     * Telkens de speler een input in de GUI geeft (bv. een muisklik, muis bewegen, toetsindrukken
+     * enz.) wordt er een 'event' (van het type SDL_Event) gegenereerd dat hier wordt afgehandeld.
+     *
+     * Niet al deze events zijn relevant voor jou: als de muis bv. over het venster gesleept wordt, hoef
+     * je niet te reageren op dit event.
+     * We gebruiken daarom de is_relevant_event-functie om niet-gebruikte events weg te
+     * filteren, zonder dat ze de applicatie vertragen of de GUI minder responsief maken.
+     *
+     * In plaats van te pollen blokkeren we in SDL_WaitEventTimeout, zodat het proces niets doet zolang de speler nadenkt.
+     * We worden enkel wakker voor input, of wanneer er een nieuwe frame getekend moet worden (zie next_wakeup).
+     *
+     * Zie ook https://wiki.libsdl.org/SDL_WaitEventTimeout
+     */
+    while (1)
+    {
+        flush_journal(SDL_GetTicks());
+        int timeout = next_wakeup(SDL_GetTicks());
+        int event_polled = timeout < 0 ? SDL_WaitEvent(&event) : SDL_WaitEventTimeout(&event, timeout);
+        if (event_polled == 0)
+        {
+            // De timeout is verstreken: tijd voor een nieuwe frame (animatie of uitgestelde redraw).
+            redraw_pending = true;
+            return;
+        }
+        else if (is_relevant_event(&event))
+        {
+            break;
+        }
+    }
+
+    /*
+     * Daarna verwerken we alle events die nog in de queue staan, in volgorde, vooraleer er opnieuw getekend wordt.
+     * Zo kost een reeks snelle kliks maar 1 frame en 1 print_view, in plaats van 1 per klik.
+     * Opeenvolgende muisbewegingen worden samengevoegd tot de laatste positie, die wordt toegepast vóór het volgende andere event.
+     */
+    bool moved = false;
+    int motion_x = 0, motion_y = 0;
+    do
+    {
+        if (!is_relevant_event(&event))
+            continue;
+        if (event.type == SDL_MOUSEMOTION)
+        {
+            moved = true;
+            motion_x = event.motion.x;
+            motion_y = event.motion.y;
+            continue;
+        }
+        if (moved)
+        {
+            apply_motion(motion_x, motion_y);
+            moved = false;
+        }
+        handle_event(&event, &changed);
+    } while (should_continue && SDL_PollEvent(&event));
+
+    if (moved)
+        apply_motion(motion_x, motion_y);
+
+    if (changed && world)
+    {
+        printf("Score: %llu cells uncovered, %d flags (%zu chunks in memory)\n", (unsigned long long)world->uncovered,
+               world->flags, world->resident);
+        if (world->io_error)
+            fprintf(stderr, "Error writing chunks to %s, keeping them in memory\n", world->directory);
+    }
+    else if (changed)
+    {
+        // Tijdens een cascade printen we het speelveld pas als ze klaar is (zie report_reveal_finished).
+        if (!game_reveal_pending(game))
+            game_print_view(game);
+        probabilities_stale = true;
+    }
+    return;
+}
+
+// De bron-rechthoek van een tegel in de texture atlas.
+static SDL_Rect tile_rect(int tile)
+{
+    SDL_Rect src = {tile * DEFAULT_IMAGE_SIZE, 0, DEFAULT_IMAGE_SIZE, DEFAULT_IMAGE_SIZE};
+    return src;
+}
+
+/*
+ * Stuurt de verzamelde cellen in 1 SDL_RenderGeometry call naar de renderer.
+ * Als de renderer geen geometry ondersteunt (SDL < 2.0.18 of een fout), tekenen we de cellen 1 voor 1 uit de atlas.
+ */
+static void flush_batch()
+{
+    if (batch_cells == 0)
+        return;
+    if (geometry_supported &&
+        SDL_RenderGeometry(renderer, atlas_texture, batch_vertices, batch_cells * 4, batch_indices, batch_cells * 6) != 0)
+    {
+        SDL_Log("SDL_RenderGeometry failed, falling back to SDL_RenderCopy: %s", SDL_GetError());
+        geometry_supported = false;
+    }
+    if (!geometry_supported)
+    {
+        for (int i = 0; i < batch_cells; ++i)
+        {
+            SDL_Vertex *v = &batch_vertices[i * 4];
+            int tile = (int)(v[0].tex_coord.x * TILE_COUNT + 0.5f);
+            SDL_Rect src = tile_rect(tile);
+            SDL_Rect dst = {(int)v[0].position.x, (int)v[0].position.y,
+                            (int)(v[3].position.x - v[0].position.x), (int)(v[3].position.y - v[0].position.y)};
+            SDL_RenderCopy(renderer, atlas_texture, &src, &dst);
+        }
+    }
+    batch_cells = 0;
+}
+
+// Voegt een quad met de gegeven tegel op positie (x, y) in het venster toe aan de batch.
+static void batch_tile(int x, int y, int size, int tile)
+{
+    if (batch_cells == BATCH_MAX_CELLS)
+        flush_batch();
+    float x0 = (float)x, y0 = (float)y;
+    float x1 = x0 + size, y1 = y0 + size;
+    float u0 = (float)tile / TILE_COUNT, u1 = (float)(tile + 1) / TILE_COUNT;
+    SDL_Vertex *v = &batch_vertices[batch_cells * 4];
+    SDL_Color white = {255, 255, 255, 255};
+    v[0] = (SDL_Vertex){{x0, y0}, white, {u0, 0.0f}};
+    v[1] = (SDL_Vertex){{x1, y0}, white, {u1, 0.0f}};
+    v[2] = (SDL_Vertex){{x0, y1}, white, {u0, 1.0f}};
+    v[3] = (SDL_Vertex){{x1, y1}, white, {u1, 1.0f}};
+    batch_cells++;
+}
 
-            bool currently_flagged = map[clicked_row][clicked_col].flagged;
+/*
+ * Bepaalt welke tegel er voor een cell getekend moet worden.
+ * De rode knipperende mijn bij verlies wordt hier als gewone mijn getekend; het knipperen gebeurt elke frame bovenop.
+ */
+static int cell_tile(Cell c)
+{
+    // Tijdens win-animatie verdwijnen verwijderde cellen; die worden wit.
+    if (game && game_status(game) == GAME_WON && cell_has(c, CELL_REMOVED))
+        return TILE_BLANK;
+    // Als de gebruiker heeft gevraagd om mijnen te tonen, dan worden ze hier getekend, zelfs als ze nog niet uncovered zijn.
+    if (game && game->show_mines && cell_is_mine(c))
+        return TILE_MINE;
+    if (cell_has(c, CELL_UNCOVERED))
+        return cell_is_mine(c) ? TILE_MINE : TILE_DIGIT_0 + cell_neighbour_mines(c);
+    return cell_has(c, CELL_FLAGGED) ? TILE_FLAGGED : TILE_COVERED;
+}
 
-            // tellen hoeveel vlaggen er al zijn geplaatst
-            int total_flags = 0;
-            for (int y = 0; y < map_height; ++y)
-            {
-                for (int x = 0; x < map_width; ++x)
-                {
-                    if (map[y][x].flagged)
-                        total_flags++;
-                }
-            }
+// Tekent de cellen [col0, col1] van rij row in de huidige render target, op hun plaats volgens de camera.
+static void batch_row(const Board *b, int row, int col0, int col1)
+{
+    int y = row * cell_size - camera_y;
+    if (game->sparse)
+    {
+        for (int col = col0; col <= col1; ++col)
+            batch_tile(col * cell_size - camera_x, y, cell_size, cell_tile(sparse_cell(game->sparse, col, row)));
+        return;
+    }
+    const Cell *cells = &MAP_CELL(b, 0, row);
+    for (int col = col0; col <= col1; ++col)
+        batch_tile(col * cell_size - camera_x, y, cell_size, cell_tile(cells[col]));
+}
 
-            // Als we een vlag willen plaatsen en al het maximale aantal vlaggen bereikt hebben, wordt de actie genegeerd.
-            if (!currently_flagged && total_flags >= map_mines)
-            {
-                printf("Cannot place more flags (max: %d)\n", map_mines);
-            }
-            else
-            {
-                map[clicked_row][clicked_col].flagged = !map[clicked_row][clicked_col].flagged;
-                printf("Right click at (%d, %d) -> cell (%d, %d) flag: %d\n", mouse_x, mouse_y, clicked_col, clicked_row, (int)map[clicked_row][clicked_col].flagged);
-                changed = true;
-            }
+// Tekent alle zichtbare cellen van het speelveld in de huidige render target, in batches.
+static void draw_visible_cells(const Board *b)
+{
+    int col0, row0, col1, row1;
+    visible_cells(&col0, &row0, &col1, &row1);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderClear(renderer);
+    for (int row = row0; row <= row1; ++row)
+        batch_row(b, row, col0, col1);
+    flush_batch();
+}
 
-            /*
-             * Controleer of de speler gewonnen heeft door alle mijnen correct te vlaggen.
-             * We tellen het totaal aan vlaggen en hoeveel daarvan op een mijn staan.
-             */
-            int correct_flags = 0;
-            int flagged_count = 0;
-            for (int y = 0; y < map_height; ++y)
-            {
-                for (int x = 0; x < map_width; ++x)
-                {
-                    if (map[y][x].flagged)
-                    {
-                        flagged_count++;
-                        if (map[y][x].is_mine)
-                            correct_flags++;
-                    }
-                }
-            }
-            // Als het aantal vlaggen gelijk is aan het aantal mijnen en alle mijnen correct geflagd zijn -> win
-            if (correct_flags == map_mines && flagged_count == map_mines)
-            {
-                printf("All mines flagged - you win!\n");
-                // Start win-animatie: markeer game_won en initialiseer verwijder-lijst
-                game_won = true;
-                win_remaining = map_width * map_height;
-                for (int y = 0; y < map_height; ++y)
-                {
-                    for (int x = 0; x < map_width; ++x)
-                    {
-                        map[y][x].removed = false; // nog niet verwijderd tijdens animatie
-                    }
-                }
-                // Seed de RNG met huidige ticks zodat de verwijdervolgorde random is.
-                srand((unsigned int)SDL_GetTicks());
-                changed = true;
-            }
+// Tekent alle zichtbare cellen van de wereld van -e rechtstreeks in het venster (elke frame, via world_peek).
+static void draw_world_cells()
+{
+    int col0, row0, col1, row1;
+    visible_cells(&col0, &row0, &col1, &row1);
+    for (int row = row0; row <= row1; ++row)
+    {
+        int y = (int)((long long)row * cell_size - camera_y);
+        for (int col = col0; col <= col1; ++col)
+            batch_tile((int)((long long)col * cell_size - camera_x), y, cell_size, cell_tile(world_peek(world, col, row)));
+    }
+    flush_batch();
+}
+
+/*
+ * Werkt de board texture bij: enkel de zichtbare cellen uit de dirty list van het spel worden opnieuw getekend.
+ * De texture is even groot als het venster en toont het speelveld door de camera; als de camera beweegt, is de hele dirty list gemarkeerd.
+ * Als de texture (nog) niet bestaat of verloren ging, wordt ze aangemaakt en volledig getekend.
+ * Geeft false terug als er geen render target texture gebruikt kan worden.
+ */
+static bool update_board_texture(const Board *b)
+{
+    if (!board_texture && board_texture_supported)
+    {
+        board_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                          curr_window_width, curr_window_height);
+        if (!board_texture)
+        {
+            SDL_Log("Failed to create board texture, drawing every cell each frame: %s", SDL_GetError());
+            board_texture_supported = false;
         }
+        dirty_mark_all(&game->dirty);
+    }
+    if (!board_texture)
+        return false;
+
+    DirtyList *dirty = &game->dirty;
+    if (dirty->full || dirty->count > 0)
+    {
+        SDL_SetRenderTarget(renderer, board_texture);
+        if (dirty->full)
+            draw_visible_cells(b);
         else
         {
-            /*
-             * Linker muisknop klik: uncover cell.
-             * Bij de eerste klik plaatsen we eerst de mijnen (exclusief de aangeklikte cell).
-             */
-            printf("Left click at (%d, %d) -> cell (%d, %d)\n", mouse_x, mouse_y, clicked_col, clicked_row);
-
-            if (!mines_placed)
-            {
-                // Dit coördinaat sluiten we uit bij het plaatsen van de mijnen, aangezien de speler hier net als eerste geklikt heeft.
-                add_mines(clicked_col, clicked_row);
-                print_map();
-                printf("\n");
-                mines_placed = true;
-                changed = true;
-            }
-            if (map[clicked_row][clicked_col].is_mine)
-            {
-                /*
-                 * De speler klikte op een mijn -> game over
-                 * Maar niet als show_mines actief is.
-                 */
-                if (!game_lost && !show_mines)
-                {
-                    game_lost = true;
-                    losing_col = clicked_col;
-                    losing_row = clicked_row;
-                    lose_start_time = SDL_GetTicks();
-                    // toon alle mijnen
-                    for (int x = 0; x < map_width; ++x)
-                    {
-                        for (int y = 0; y < map_height; ++y)
-                        {
-                            if (map[y][x].is_mine)
-                                map[y][x].uncovered = true;
-                        }
-                    }
-                    // uncover ook de mijn waarop geklikt werd
-                    map[clicked_row][clicked_col].uncovered = true;
-                    printf("You clicked a mine at (%d, %d) - you lose.\n", clicked_col, clicked_row);
-                    changed = true;
-                }
-            }
-            else if (map[clicked_row][clicked_col].neighbour_mines == 0)
+            // Spans die (deels) buiten beeld vallen, worden bijgeknipt; ze worden getekend zodra de camera erheen beweegt.
+            int col0, row0, col1, row1;
+            visible_cells(&col0, &row0, &col1, &row1);
+            for (size_t i = 0; i < dirty->count; ++i)
             {
-                // Wanneer een nul-cell (zonder aangrenzende mijnen) wordt aangeklikt, worden de naburige cellen ook automatisch ontdekt.
-                // We doen dit d.m.v. een array die als stack fungeert.
-                int size = (int)map_width * (int)map_height;
-                int stack_y[size], stack_x[size];
-                int i = 0;
-                // We pushen de startcel op de stack.
-                stack_y[i] = clicked_row;
-                stack_x[i] = clicked_col;
-                i++;
-
-                while (i > 0)
-                {
-                    // itereer zolang er cellen in de stack zitten
-                    i--;
-                    int curr_y = stack_y[i];
-                    int curr_x = stack_x[i];
-
-                    // bounds check
-                    if (curr_x < 0 || curr_x >= map_width || curr_y < 0 || curr_y >= map_height)
-                        continue;
-                    // als de cell al uncovered is, slaan we ze over
-                    if (map[curr_y][curr_x].uncovered)
-                        continue;
-                    // uncover de cell
-                    map[curr_y][curr_x].uncovered = true;
-                    changed = true;
-                    // als de cell ook 0 aangrenzende mijnen heeft, pushen we alle niet-onthulde en niet-gevlagde buurcellen
-                    if (map[curr_y][curr_x].neighbour_mines == 0)
-                    {
-                        // we pushen alle 8 buurcellen
-                        for (int diag_x = -1; diag_x <= 1; diag_x++)
-                        {
-                            for (int diag_y = -1; diag_y <= 1; diag_y++)
-                            {
-                                if (diag_x == 0 && diag_y == 0)
-                                    continue;
-                                int neighbor_x = curr_x + diag_x;
-                                int neighbor_y = curr_y + diag_y;
-                                if (neighbor_x < 0 || neighbor_x >= map_width || neighbor_y < 0 || neighbor_y >= map_height)
-                                    continue;
-                                if (!map[neighbor_y][neighbor_x].uncovered && !map[neighbor_y][neighbor_x].flagged)
-                                {
-                                    // we pushen de buurcell
-                                    stack_y[i] = neighbor_y;
-                                    stack_x[i] = neighbor_x;
-                                    i++;
-                                }
-                            }
-                        }
-                    }
-                }
+                DirtySpan *span = &dirty->spans[i];
+                if (span->y < row0 || span->y > row1)
+                    continue;
+                int x0 = span->x0 > col0 ? span->x0 : col0;
+                int x1 = span->x1 < col1 ? span->x1 : col1;
+                if (x0 <= x1)
+                    batch_row(b, span->y, x0, x1);
             }
-            else
+            flush_batch();
+        }
+        SDL_SetRenderTarget(renderer, NULL);
+        dirty_clear(dirty);
+    }
+    return true;
+}
+
+/*
+ * Tekent de kansen op een mijn als een heat overlay over de zichtbare covered cellen: van groen (veilig) tot rood (mijn).
+ * De quads gaan zonder texture in batches via SDL_RenderGeometry, of anders 1 voor 1 als gevulde rechthoek.
+ */
+static void draw_probability_overlay()
+{
+    if (!update_probabilities())
+        return;
+    const Board *b = &game->board;
+    int col0, row0, col1, row1;
+    visible_cells(&col0, &row0, &col1, &row1);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    int quads = 0;
+    for (int row = row0; row <= row1; ++row)
+    {
+        for (int col = col0; col <= col1; ++col)
+        {
+            float p = probabilities.probability[(size_t)row * (size_t)b->width + (size_t)col];
+            if (p < 0.0f)
+                continue;
+            SDL_Color color = {(Uint8)(255.0f * p), (Uint8)(255.0f * (1.0f - p)), 0, 110};
+            float x0 = (float)(col * cell_size - camera_x), y0 = (float)(row * cell_size - camera_y);
+            float x1 = x0 + cell_size, y1 = y0 + cell_size;
+            if (!geometry_supported)
             {
-                // uncover een "normale nummer cell"
-                if (!map[clicked_row][clicked_col].uncovered)
-                {
-                    map[clicked_row][clicked_col].uncovered = true;
-                    changed = true;
-                }
+                SDL_Rect rect = {(int)x0, (int)y0, cell_size, cell_size};
+                SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+                SDL_RenderFillRect(renderer, &rect);
+                continue;
             }
-
-            /*
-             * We checken of de speler alle nummer cellen als uncovered heeft aangeklikt -> win
-             * Maar alleen als show_all niet actief is.
-             */
-            if (!game_won && !show_all)
+            SDL_Vertex *v = &batch_vertices[quads * 4];
+            v[0] = (SDL_Vertex){{x0, y0}, color, {0.0f, 0.0f}};
+            v[1] = (SDL_Vertex){{x1, y0}, color, {0.0f, 0.0f}};
+            v[2] = (SDL_Vertex){{x0, y1}, color, {0.0f, 0.0f}};
+            v[3] = (SDL_Vertex){{x1, y1}, color, {0.0f, 0.0f}};
+            if (++quads == BATCH_MAX_CELLS)
             {
-                bool all_number_cells_uncovered = true;
-                for (int y = 0; y < map_height && all_number_cells_uncovered; ++y)
-                {
-                    for (int x = 0; x < map_width && all_number_cells_uncovered; ++x)
-                    {
-                        if (!map[y][x].is_mine && !map[y][x].uncovered)
-                        {
-                            all_number_cells_uncovered = false;
-                        }
-                    }
-                }
-                if (all_number_cells_uncovered)
-                {
-                    printf("All number cells uncovered - you win!\n");
-                    // Start win-animatie: markeer game_won en initialiseer verwijder-lijst
-                    game_won = true;
-                    win_remaining = map_width * map_height;
-                    for (int y = 0; y < map_height; ++y)
-                    {
-                        for (int x = 0; x < map_width; ++x)
-                        {
-                            map[y][x].removed = false; // nog niet verwijderd tijdens animatie
-                        }
-                    }
-                    changed = true;
-                }
+                SDL_RenderGeometry(renderer, NULL, batch_vertices, quads * 4, batch_indices, quads * 6);
+                quads = 0;
             }
         }
-        break;
     }
+    if (quads > 0)
+        SDL_RenderGeometry(renderer, NULL, batch_vertices, quads * 4, batch_indices, quads * 6);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+}
 
-    if (changed)
+/*
+ * Tekent het front van een lopende cascade: de seeds op de worklist zijn de randen van de golf die nog moeten uitdijen.
+ * Elke zichtbare seed krijgt een lichtblauwe gloed (hoogstens BATCH_MAX_CELLS per frame).
+ */
+static void draw_reveal_wave()
+{
+    size_t count = 0;
+    const RevealSeed *seeds = game_reveal_frontier(game, &count);
+    int col0, row0, col1, row1;
+    visible_cells(&col0, &row0, &col1, &row1);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 80, 170, 255, 140);
+    int drawn = 0;
+    for (size_t i = 0; i < count && drawn < BATCH_MAX_CELLS; ++i)
     {
-        print_view();
+        if (seeds[i].x < col0 || seeds[i].x > col1 || seeds[i].y < row0 || seeds[i].y > row1)
+            continue;
+        SDL_Rect rect = {seeds[i].x * cell_size - camera_x, seeds[i].y * cell_size - camera_y, cell_size, cell_size};
+        SDL_RenderFillRect(renderer, &rect);
+        drawn++;
     }
-    return;
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+}
+
+// We tekenen het muiscursor hover effect.
+static void draw_hover_marker()
+{
+    int marker_col, marker_row;
+    if (!screen_to_cell(mouse_x, mouse_y, &marker_col, &marker_row))
+        return;
+    SDL_Rect marker_rect = {(int)((long long)marker_col * cell_size - camera_x), (int)((long long)marker_row * cell_size - camera_y),
+                            cell_size, cell_size};
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 0, 100);
+    SDL_RenderFillRect(renderer, &marker_rect);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+}
+
+// Laat de mijn op (col, row) rood knipperen, elke seconde relatief tov start-verlies tijd.
+static void draw_losing_mine(int col, int row)
+{
+    SDL_Rect rect = {(int)((long long)col * cell_size - camera_x), (int)((long long)row * cell_size - camera_y), cell_size, cell_size};
+    int time = SDL_GetTicks();
+    int elapsed = time - lose_start_time;
+    int visible = ((elapsed / LOSE_BLINK_INTERVAL) % 2) == 0;
+    SDL_Rect src = tile_rect(visible ? TILE_MINE : TILE_COVERED);
+    if (visible)
+    {
+        // rode tint
+        SDL_SetTextureColorMod(atlas_texture, 255, 0, 0);
+        SDL_RenderCopy(renderer, atlas_texture, &src, &rect);
+        // reset de rode tint
+        SDL_SetTextureColorMod(atlas_texture, 255, 255, 255);
+    }
+    else
+    {
+        // Wanneer de cell covered is, tekenen we de covered tegel.
+        SDL_RenderCopy(renderer, atlas_texture, &src, &rect);
+    }
+}
+
+/*
+ * Tekent de wereld van -e: zonder board texture worden de zichtbare cellen elke frame opnieuw getekend,
+ * maar enkel als er iets veranderd is (een klik of een beweging van de camera) of de verloren mijn knippert.
+ */
+static void draw_world_window()
+{
+    uint32_t frame_time = SDL_GetTicks();
+    if (!redraw_pending || frame_time - last_frame_time < frame_interval)
+        return;
+    redraw_pending = false;
+    last_frame_time = frame_time;
+
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderClear(renderer);
+    draw_world_cells();
+    if (world->status == GAME_PLAYING && !dragging)
+        draw_hover_marker();
+    if (world->status == GAME_LOST)
+        draw_losing_mine(world->losing_x, world->losing_y);
+    SDL_RenderPresent(renderer);
 }
 
-// Deze functie tekent het speelveld met alle afbeeldingen e.d.
+/*
+ * Deze functie tekent het speelveld met alle afbeeldingen e.d.
+ * De cellen zelf staan in een persistente board texture waarin enkel veranderde cellen opnieuw getekend worden.
+ * Elke frame kopiëren we die texture naar het venster en tekenen we de hover marker en de animaties erboven.
+ */
 void draw_window()
 {
-    // We berekenen de grootte van elke cell op basis van de rij en kolom aantallen en de huidige window grootte.
-    int grid_rows = map_height, grid_cols = map_width;
-    int cell_w = curr_window_width / grid_cols;
-    int cell_h = curr_window_height / grid_rows;
+    if (world)
+    {
+        draw_world_window();
+        return;
+    }
+    Board *b = &game->board;
+
+    // Er is niets veranderd, of de vorige frame is te recent (FPS limiet): we tekenen niets.
+    uint32_t frame_time = SDL_GetTicks();
+    if (!redraw_pending && !game->dirty.full && game->dirty.count == 0 && !game_reveal_pending(game))
+        return;
+    if (frame_time - last_frame_time < frame_interval)
+        return;
+    redraw_pending = false;
+    last_frame_time = frame_time;
+
+    // Een lopende cascade dijt per frame een stuk verder uit; de nieuw uncovered cellen staan daarna in de dirty list.
+    advance_reveal();
+    bool game_won = game_status(game) == GAME_WON;
+    bool game_lost = game_status(game) == GAME_LOST;
 
     // We wissen de renderbuffer met een witte achtergrond.
     SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
     SDL_RenderClear(renderer);
 
-    if (!game_won && !game_lost)
+    if (update_board_texture(b))
     {
-
-        // We tekenen het muiscursor hover effect.
-        int marker_col = mouse_x / cell_w;
-        int marker_row = mouse_y / cell_h;
-        if (marker_col >= 0 && marker_col < grid_cols && marker_row >= 0 && marker_row < grid_rows)
-        {
-            SDL_Rect marker_rect = {marker_col * cell_w, marker_row * cell_h, cell_w, cell_h};
-            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-            SDL_SetRenderDrawColor(renderer, 255, 255, 0, 100);
-            SDL_RenderFillRect(renderer, &marker_rect);
-            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
-            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-        }
+        SDL_RenderCopy(renderer, board_texture, NULL, NULL);
     }
-
-    // We voeren de win-animatie uit door willekeurige cellen te verwijderen.
-    for (int row = 0; row < grid_rows; ++row)
+    else
     {
-        for (int col = 0; col < grid_cols; ++col)
-        {
-            SDL_Rect rect = {col * cell_w, row * cell_h, cell_w, cell_h};
-            // Tijdens win-animatie verdwijnen verwijderde cellen; anders normaal renderen.
-            if (game_won && map[row][col].removed)
-            {
-                continue; // cell is al verwijderd
-            }
+        // Zonder render target tekenen we elke frame alle zichtbare cellen rechtstreeks in het venster.
+        draw_visible_cells(b);
+        dirty_clear(&game->dirty);
+    }
 
-            // Als de gebruiker heeft gevraagd om mijnen te tonen, dan worden ze hier getekend, zelfs als ze nog niet uncovered zijn.
-            if (show_mines && map[row][col].is_mine)
-            {
-                SDL_RenderCopy(renderer, digit_mine_texture, NULL, &rect);
-                continue;
-            }
+    // Tijdens een cascade tonen we de golf in plaats van de kansen (die zouden elke frame herberekend moeten worden).
+    if (game_reveal_pending(game))
+        draw_reveal_wave();
+    else if (show_probabilities && !game_won && !game_lost)
+        draw_probability_overlay();
 
-            if (map[row][col].uncovered)
-            {
-                if (map[row][col].is_mine)
-                {
-                    // Als de speler verloren heeft, laten we de mijn waarop laatst geklikt werd rood knipperen.
-                    if (game_lost && col == losing_col && row == losing_row)
-                    {
-                        int time = SDL_GetTicks();
-                        int elapsed = time - lose_start_time;
-                        int visible = ((elapsed / 1000) % 2) == 0; // knipper elke seconde relatief tov start-verlies tijd
-                        if (visible)
-                        {
-                            // rode tint
-                            SDL_SetTextureColorMod(digit_mine_texture, 255, 0, 0);
-                            SDL_RenderCopy(renderer, digit_mine_texture, NULL, &rect);
-                            // reset de rode tint
-                            SDL_SetTextureColorMod(digit_mine_texture, 255, 255, 255);
-                        }
-                        else
-                        {
-                            // Wanneer de cell covered is, tekenen we de covered texture, zodat de hover marker of vorige frames terug worden verborgen.
-                            if (digit_covered_texture)
-                                SDL_RenderCopy(renderer, digit_covered_texture, NULL, &rect);
-                        }
-                    }
-                    else
-                        SDL_RenderCopy(renderer, digit_mine_texture, NULL, &rect);
-                }
-                else
-                {
-                    int i = map[row][col].neighbour_mines;
-                    if (i >= 0 && i <= 8 && digit_textures[i])
-                        SDL_RenderCopy(renderer, digit_textures[i], NULL, &rect);
-                    else
-                        SDL_RenderCopy(renderer, digit_covered_texture, NULL, &rect);
-                }
-            }
-            else
-            {
-                if (map[row][col].flagged && digit_flagged_texture)
-                    SDL_RenderCopy(renderer, digit_flagged_texture, NULL, &rect);
-                else if (digit_covered_texture)
-                    SDL_RenderCopy(renderer, digit_covered_texture, NULL, &rect);
-            }
-        }
-    }
+    if (!game_won && !game_lost && !dragging)
+        draw_hover_marker();
+
+    // Als de speler verloren heeft, laten we de mijn waarop laatst geklikt werd rood knipperen.
+    if (game_lost && !game->show_mines)
+        draw_losing_mine(game->losing_col, game->losing_row);
 
     // We voeren de winanimatie uit door willekeurige cellen te verwijderen.
     if (game_won && win_remaining > 0)
     {
         int now = SDL_GetTicks();
-        if (now - win_last_remove >= 20)
+        if (now - win_last_remove >= WIN_REMOVE_INTERVAL)
         {
             // Kies een random overblijvende cel om te verwijderen.
             int tries = 0;
             while (tries < 1000 && win_remaining > 0)
             {
-                int rc_y = rand() % map_height;
-                int rc_x = rand() % map_width;
-                if (!map[rc_y][rc_x].removed)
+                int rc_y = rand() % b->height;
+                int rc_x = rand() % b->width;
+                if (!cell_has(MAP_CELL(b, rc_x, rc_y), CELL_REMOVED))
                 {
-                    map[rc_y][rc_x].removed = true;
+                    cell_set(&MAP_CELL(b, rc_x, rc_y), CELL_REMOVED, true);
+                    // De verwijderde cell wordt in de volgende frame wit getekend in de board texture.
+                    dirty_add(&game->dirty, rc_y, rc_x, rc_x);
                     win_remaining--;
                     break;
                 }
@@ -661,7 +1382,7 @@ void draw_window()
  * - https://wiki.libsdl.org/SDL2/SDL_Log voor SDL_Log
  * - https://wiki.libsdl.org/SDL2/SDL_GetError voor SDL_GetError
  */
-void initialize_window(const char *title, int window_width, int window_height)
+void initialize_window(const char *title, int window_width, int window_height, bool vsync)
 {
     // Vraag de desktop display mode op.
     if (SDL_GetDesktopDisplayMode(0, &dm) != 0)
@@ -680,8 +1401,9 @@ void initialize_window(const char *title, int window_width, int window_height)
         exit(1);
     }
 
-    // Initialiseert de renderer.
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_PRESENTVSYNC);
+    // Initialiseert de renderer. Met vsync wacht SDL_RenderPresent op de verticale refresh van het scherm.
+    renderer = SDL_CreateRenderer(window, -1, vsync ? SDL_RENDERER_PRESENTVSYNC : 0);
+    board_texture_supported = SDL_RenderTargetSupported(renderer) == SDL_TRUE;
     // Zet de huidige window afmetingen juist.
     curr_window_width = window_width;
     curr_window_height = window_height;
@@ -689,84 +1411,160 @@ void initialize_window(const char *title, int window_width, int window_height)
     SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
 }
 
-// Laad alle afbeeldingen die getoond moeten worden in.
+/*
+ * Laad alle afbeeldingen die getoond moeten worden in, en plaats ze naast elkaar in 1 texture atlas.
+ * Ook de index buffer voor het batchen wordt hier eenmalig opgevuld (die is voor elke batch dezelfde).
+ */
 void initialize_textures()
 {
     /*
-     * Laad de nummer afbeeldingen in.
+     * Laad de afbeeldingen in, in de volgorde van de tegels in de atlas.
      * Indien een afbeelding niet kon geladen worden (bv. omdat het pad naar de afbeelding verkeerd is),
-     * geeft SDL_LoadBMP een NULL-pointer terug.
+     * geeft SDL_LoadBMP een NULL-pointer terug en blijft de tegel wit.
      * Zie SDL2 documentatie:
      * - https://wiki.libsdl.org/SDL2/SDL_Log voor SDL_Log
      * - https://wiki.libsdl.org/SDL2/SDL_GetError voor SDL_GetError
      */
-    const char *num_files[9] = {
+    const char *tile_files[TILE_BLANK] = {
         "Images/0.bmp", "Images/1.bmp", "Images/2.bmp",
         "Images/3.bmp", "Images/4.bmp", "Images/5.bmp",
-        "Images/6.bmp", "Images/7.bmp", "Images/8.bmp"};
+        "Images/6.bmp", "Images/7.bmp", "Images/8.bmp",
+        "Images/covered.bmp", "Images/flagged.bmp", "Images/mine.bmp"};
+
+    SDL_Surface *atlas = SDL_CreateRGBSurfaceWithFormat(0, TILE_COUNT * DEFAULT_IMAGE_SIZE, DEFAULT_IMAGE_SIZE, 32, SDL_PIXELFORMAT_RGBA8888);
+    if (!atlas)
+    {
+        SDL_Log("Failed to create texture atlas: %s", SDL_GetError());
+        exit(1);
+    }
+    // De atlas begint volledig wit, zodat de TILE_BLANK tegel (en ontbrekende afbeeldingen) wit zijn.
+    SDL_FillRect(atlas, NULL, SDL_MapRGBA(atlas->format, 255, 255, 255, 255));
 
-    for (int i = 0; i < 9; ++i)
+    for (int i = 0; i < TILE_BLANK; ++i)
     {
-        SDL_Surface *s = SDL_LoadBMP(num_files[i]);
+        SDL_Surface *s = SDL_LoadBMP(tile_files[i]);
         if (s)
         {
-            digit_textures[i] = SDL_CreateTextureFromSurface(renderer, s);
-            if (!digit_textures[i])
-                SDL_Log("Failed to create texture for image %d: %s", i, SDL_GetError());
+            SDL_Rect dst = tile_rect(i);
+            SDL_SetSurfaceBlendMode(s, SDL_BLENDMODE_NONE);
+            if (SDL_BlitScaled(s, NULL, atlas, &dst) != 0)
+                SDL_Log("Failed to copy image %s into the atlas: %s", tile_files[i], SDL_GetError());
             SDL_FreeSurface(s);
         }
         else
         {
-            SDL_Log("Failed to load image %s: %s", num_files[i], SDL_GetError());
-            digit_textures[i] = NULL;
+            SDL_Log("Failed to load image %s: %s", tile_files[i], SDL_GetError());
         }
     }
 
-    // Laad de andere afbeeldingen apart in.
-    SDL_Surface *digit_covered_surface = SDL_LoadBMP("Images/covered.bmp");
-    if (!digit_covered_surface)
-        SDL_Log("Failed to load image covered.bmp: %s", SDL_GetError());
-    SDL_Surface *digit_flagged_surface = SDL_LoadBMP("Images/flagged.bmp");
-    if (!digit_flagged_surface)
-        SDL_Log("Failed to load image flagged.bmp: %s", SDL_GetError());
-    SDL_Surface *digit_mine_surface = SDL_LoadBMP("Images/mine.bmp");
-    if (!digit_mine_surface)
-        SDL_Log("Failed to load image mine.bmp: %s", SDL_GetError());
-
-    digit_covered_texture = SDL_CreateTextureFromSurface(renderer, digit_covered_surface);
-    digit_flagged_texture = SDL_CreateTextureFromSurface(renderer, digit_flagged_surface);
-    digit_mine_texture = SDL_CreateTextureFromSurface(renderer, digit_mine_surface);
+    atlas_texture = SDL_CreateTextureFromSurface(renderer, atlas);
+    if (!atlas_texture)
+        SDL_Log("Failed to create texture for the atlas: %s", SDL_GetError());
+    // Dealloceer de tijdelijke SDL_Surface die werd aangemaakt.
+    SDL_FreeSurface(atlas);
 
-    // Dealloceer de tijdelijke SDL_Surfaces die werden aangemaakt.
-    SDL_FreeSurface(digit_covered_surface);
-    SDL_FreeSurface(digit_flagged_surface);
-    SDL_FreeSurface(digit_mine_surface);
+    batch_vertices = (SDL_Vertex *)malloc(BATCH_MAX_CELLS * 4 * sizeof(SDL_Vertex));
+    batch_indices = (int *)malloc(BATCH_MAX_CELLS * 6 * sizeof(int));
+    if (!batch_vertices || !batch_indices)
+    {
+        SDL_Log("Out of memory allocating the render batch");
+        exit(1);
+    }
+    // Elke quad bestaat uit 2 driehoeken: (0, 1, 2) en (2, 1, 3).
+    for (int i = 0; i < BATCH_MAX_CELLS; ++i)
+    {
+        int *idx = &batch_indices[i * 6];
+        idx[0] = i * 4;
+        idx[1] = i * 4 + 1;
+        idx[2] = i * 4 + 2;
+        idx[3] = i * 4 + 2;
+        idx[4] = i * 4 + 1;
+        idx[5] = i * 4 + 3;
+    }
 }
 
 /*
  * Initialiseert onder het venster waarin het speelveld getoond zal worden, en de texture van de afbeelding die getoond zal worden.
+ * Het meegegeven spel wordt door de GUI getekend en aangestuurd, maar niet gedealloceerd.
+ * Er worden maximaal max_fps frames per seconde getekend (0 = geen limiet); met vsync wordt er gesynchroniseerd met het scherm.
+ * Als journal_file niet NULL is, wordt elke zet in dat journal bijgehouden (zie journal.h).
  * Deze functie moet aangeroepen worden aan het begin van het spel, vooraleer je de spelwereld begint te tekenen.
  */
-void initialize_gui(int window_width, int window_height)
+void initialize_gui(Game *g, int window_width, int window_height, int max_fps, bool vsync, const char *journal_file)
 {
-    initialize_window("Minesweeper", window_width, window_height);
+    game = g;
+    // Een cascade wordt over meerdere frames verdeeld (zie advance_reveal), zodat een grote opening het venster niet bevriest.
+    g->progressive = true;
+    frame_interval = max_fps > 0 ? (uint32_t)(1000 / max_fps) : 0;
+    initialize_window("Minesweeper", window_width, window_height, vsync);
+    // De camera begint linksboven, met de grootste zoom waarbij het speelveld het venster vult.
+    int fit_w = window_width / g->board.width, fit_h = window_height / g->board.height;
+    cell_size = fit_w < fit_h ? fit_w : fit_h;
+    if (cell_size < MIN_IMAGE_SIZE)
+        cell_size = MIN_IMAGE_SIZE;
+    if (cell_size > MAX_CELL_SIZE)
+        cell_size = MAX_CELL_SIZE;
     initialize_textures();
+    save_job_init(&save_job);
+    save_done_event = SDL_RegisterEvents(1);
+    solver_init(&solver);
+    probability_init(&probabilities);
+    probabilities.threads = g->threads;
+    if (journal_file && journal_open(&journal, journal_file, g, g->durable_save) != 0)
+        fprintf(stderr, "Error opening journal %s, moves will not be recorded\n", journal_file);
+    /*
+     * Als de mijnen nog niet geplaatst zijn, genereren we het speelveld al op de achtergrond (met -g hangt het af van de eerste klik).
+     * Een speelveld van -z plaatst de mijnen rond de eerste klik, dus daar ook niet.
+     */
+    if (!g->mines_placed && !g->no_guess && !g->sparse)
+    {
+        pregenerate_thread = SDL_CreateThread(pregenerate_thread_main, "pregenerate", g);
+        if (!pregenerate_thread)
+            SDL_Log("Failed to start pregeneration thread, generating at the first click: %s", SDL_GetError());
+    }
     // Maakt van wit de standaard, blanco achtergrondkleur.
     SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
 }
 
+/*
+ * Initialiseert de GUI voor de wereld van -e (in plaats van initialize_gui), met de camera rond de startcell.
+ * De wereld wordt door de GUI getekend en aangestuurd, maar niet opgeslagen of gedealloceerd.
+ */
+void initialize_world_gui(World *w, int window_width, int window_height, int max_fps, bool vsync)
+{
+    world = w;
+    frame_interval = max_fps > 0 ? (uint32_t)(1000 / max_fps) : 0;
+    initialize_window("Minesweeper (endless)", window_width, window_height, vsync);
+    cell_size = DEFAULT_IMAGE_SIZE;
+    camera_x = WORLD_START_X * cell_size + cell_size / 2 - window_width / 2;
+    camera_y = WORLD_START_Y * cell_size + cell_size / 2 - window_height / 2;
+    initialize_textures();
+    save_job_init(&save_job);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+}
+
 // Dealloceert alle SDL structuren die geïnitialiseerd werden.
 void free_gui()
 {
-    // Dealloceert de afbeeldingen.
-    for (int i = 0; i < 9; ++i)
+    // Een save die nog bezig is, laten we eerst afwerken.
+    if (save_thread)
     {
-        if (digit_textures[i])
-            SDL_DestroyTexture(digit_textures[i]);
+        SDL_WaitThread(save_thread, NULL);
+        save_thread = NULL;
     }
-    SDL_DestroyTexture(digit_covered_texture);
-    SDL_DestroyTexture(digit_flagged_texture);
-    SDL_DestroyTexture(digit_mine_texture);
+    save_job_free(&save_job);
+    finish_pregeneration();
+    // De laatste gebufferde zetten worden nog weggeschreven.
+    journal_close(&journal, game);
+    solver_free(&solver);
+    probability_free(&probabilities);
+    // Dealloceert de texture atlas en de render batch.
+    if (atlas_texture)
+        SDL_DestroyTexture(atlas_texture);
+    free(batch_vertices);
+    free(batch_indices);
+    if (board_texture)
+        SDL_DestroyTexture(board_texture);
     // Dealloceert de renderer.
     SDL_DestroyRenderer(renderer);
     // Dealloceert het venster.
@@ -775,238 +1573,3 @@ void free_gui()
     // Sluit SDL af.
     SDL_Quit();
 }
-
-// Sla het huidige speelveld op in een genummerd bestand met naam: field_<width>x<height>_<n>.txt
-void save_game()
-{
-    char filenamebuf[256];
-    int n = 1;
-    // Blijf proberen tot een geldige bestandsnaam is gevonden.
-    while (1)
-    {
-        snprintf(filenamebuf, sizeof(filenamebuf), "field_%dx%d_%d.txt", map_width, map_height, n);
-        // De functie controleert of het bestand al bestaat door het te proberen openen.
-        FILE *f = fopen(filenamebuf, "r");
-        // Als de bestandsnaam al is ingenomen, sluiten we het bestand en incrementen we de counter n.
-        if (f)
-        {
-            fclose(f);
-            n++;
-            continue;
-        }
-        break;
-    }
-    // Er wordt geheugen gealloceerd voor twee tijdelijke arrays van char pointers.
-    int cells = (int)map_width * (int)map_height;
-    char *f_arr = (char *)malloc(cells); // Deze houdt de status van "flagged" per cell bij.
-    char *u_arr = (char *)malloc(cells); // Deze houdt de status van "uncovered" per cell bij.
-    if (!f_arr || !u_arr)
-    {
-        if (f_arr)
-            free(f_arr);
-        if (u_arr)
-            free(u_arr);
-        perror("Out of memory error!");
-        return;
-    }
-    // Voor elke cell wordt 1 byte gebruikt in de tijdelijke arrays om aan te duiden of deze "flagged" of "uncovered" is.
-    for (int x = 0; x < map_width; ++x)
-    {
-        for (int y = 0; y < map_height; ++y)
-        {
-            int i = y * map_width + x;
-            f_arr[i] = map[y][x].flagged ? 1 : 0;
-            u_arr[i] = map[y][x].uncovered ? 1 : 0;
-        }
-    }
-    // Converteer Cell struct array naar char array voor save_field()
-    char *map_as_char = (char *)malloc(cells);
-    if (!map_as_char)
-    {
-        fprintf(stderr, "Out of memory error!\n");
-        free(f_arr);
-        free(u_arr);
-        return;
-    }
-    for (int y = 0; y < map_height; ++y)
-    {
-        for (int x = 0; x < map_width; ++x)
-        {
-            int i = y * map_width + x;
-            if (map[y][x].is_mine)
-                map_as_char[i] = 'M';
-            else
-                map_as_char[i] = '0' + map[y][x].neighbour_mines;
-        }
-    }
-
-    /*
-     * We slaan het speelveld op via de save_field functie.
-     * Deze functie zal de map, de flagged array en de uncovered array wegschrijven naar een bestand met naam filenamebuf.
-     */
-    if (save_field(filenamebuf, map_width, map_height, map_as_char, f_arr, u_arr) != 0)
-        fprintf(stderr, "Error saving field to %s\n", filenamebuf);
-    else
-        printf("Saved field to %s\n", filenamebuf);
-    free(map_as_char);
-    free(f_arr);
-    free(u_arr);
-}
-
-/*
- * We laden met de load_file functie een spelbestand in.
- * Een spelbestand bestaat uit:
- * - de state van een actief gespeelde map
- * - de uncovered map (oplossing)
- * Verder betekenen de volgende gebruikte letters in het bestand:
- * - U: uncovered
- * - F: flagged
- * - M: mine
- * - #: covered
- */
-int load_file(const char *filename)
-{
-    char **lines = NULL;
-    int count = 0;
-    // We lezen het bestand regel per regel in via read_lines().
-    if (read_lines(filename, &lines, &count) != 0)
-        return -1;
-
-    // We controleren of het bestand minimaal 1 regel bevat.
-    if (count == 0)
-    {
-        free_lines(lines, count);
-        return -1;
-    }
-
-    /*
-     * We zoeken de scheidingsregel (lege regel) tussen het speelveld en de oplossingsmap.
-     * Als sep == -1, dan is er geen oplossingsmap aanwezig.
-     */
-    int sep = -1;
-    for (int i = 0; i < count; ++i)
-        if (lines[i][0] == '\0')
-        {
-            sep = i;
-            break;
-        }
-
-    /*
-     * We bepalen het aantal rijen van het speelveld.
-     * Als er geen scheidingsregel wordt gevonden, dan bevat het bestand enkel het speelveld.
-     */
-    int map_count = (sep == -1) ? count : sep;
-
-    // We bepalen het aantal kolommen door de niet-whitespace karakters in de eerste regel te tellen.
-    int cols = 0;
-    for (int i = 0; lines[0][i] != '\0'; i++)
-    {
-        if (lines[0][i] != ' ' && lines[0][i] != '\t')
-            cols++;
-    }
-
-    // We controleren of er minimaal 1 kolom is.
-    if (cols <= 0)
-    {
-        free_lines(lines, count);
-        return -1;
-    }
-
-    /*
-     * We roepen de init_map functie aan om een speelveld/map te initialiseren met de juiste afmetingen.
-     * We geven 0 mee als het aantal mijnen, zodat er nog geen mijnen random geplaatst worden.
-     * De mijnen worden later immers uit het bestand ingelezen.
-     */
-    if (init_map(cols, map_count, 0) != 0)
-    {
-        free_lines(lines, count);
-        return -1;
-    }
-
-    /*
-     * We gaan door elke regel van het speelveld en vullen ons speelveld in met de juiste waarden.
-     * We tellen ook het aantal mijnen tijdens het inlezen.
-     */
-    int mines = 0;
-    for (int i = 0; i < map_count; ++i)
-    {
-        int col = 0;
-        for (int j = 0; lines[i][j] != '\0' && col < cols; j++)
-        {
-            // sla whitespaces over
-            if (lines[i][j] != ' ' && lines[i][j] != '\t')
-            {
-                char ch = lines[i][j];
-                if (ch == 'M')
-                {
-                    map[i][col].is_mine = true;
-                    map[i][col].neighbour_mines = 0;
-                    mines++;
-                }
-                else if (ch >= '0' && ch <= '8')
-                {
-                    map[i][col].is_mine = false;
-                    map[i][col].neighbour_mines = ch - '0';
-                }
-                col++;
-            }
-        }
-    }
-    map_mines = mines;
-
-    // We initialiseren via init_states() de benodigde game states.
-    if (init_states() != 0)
-    {
-        free_lines(lines, count);
-        free_map();
-        return -1;
-    }
-
-    // We zetten alle uncovered en flagged states standaard op false.
-    for (int x = 0; x < map_width; ++x)
-    {
-        for (int y = 0; y < map_height; ++y)
-        {
-            map[y][x].uncovered = false;
-            map[y][x].flagged = false;
-        }
-    }
-
-    /*
-     * Wanneer er een scheidingsregel is gevonden, bevat het bestand ook een oplossingsmap.
-     * We moeten dus door elke regel van de oplossingsmap gaan en de FLAG/UNC states instellen voor alle cellen.
-     */
-    if (sep != -1)
-    {
-        // We berekenen het aantal rijen van de oplossingsmap.
-        int state_rows = count - (sep + 1);
-        // Als de oplossingsmap meer rijen bevat dan het speelveld, worden de overige rijen genegeerd.
-        int use_rows = state_rows < map_count ? state_rows : map_count;
-
-        // We itereren elke regel van de oplossingsmap en vullen de FLAG/UNC states in.
-        for (int i = 0; i < use_rows; ++i)
-        {
-            int col = 0;
-            for (int j = 0; lines[sep + 1 + i][j] != '\0' && col < cols; j++)
-            {
-                // sla whitespaces over
-                if (lines[sep + 1 + i][j] != ' ' && lines[sep + 1 + i][j] != '\t')
-                {
-                    // deze cell is flagged
-                    if (lines[sep + 1 + i][j] == 'F')
-                        map[i][col].flagged = true;
-                    // deze cell is uncovered
-                    else if (lines[sep + 1 + i][j] == 'U')
-                        map[i][col].uncovered = true;
-                    col++;
-                }
-            }
-        }
-    }
-
-    // We dealloceren het gebruikte geheugen voor de ingelezen lijnen en de bijhorende count.
-    free_lines(lines, count);
-    // De mijnen zijn nu geplaatst.
-    mines_placed = true;
-    return 0;
-}
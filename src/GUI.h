@@ -2,7 +2,8 @@
 #define MINESWEEPER_GUI_H
 
 #include <stdbool.h>
-#include "map.h"
+#include "game.h"
+#include "world.h"
 
 // De hoogte en breedte van het venster (in pixels).
 #define WINDOW_HEIGHT 500
@@ -10,14 +11,23 @@
 
 // De hoogte en breedte (in pixels) van de afbeeldingen voor de vakjes in het speelveld die getoond worden.
 #define DEFAULT_IMAGE_SIZE 50
+
+/*
+ * De grenzen van de cell grootte (in pixels).
+ * Bij het opstarten worden cellen nooit kleiner dan MIN_IMAGE_SIZE; met het muiswiel kan de speler verder uitzoomen tot MIN_CELL_SIZE.
+ */
+#define MIN_IMAGE_SIZE 20
+#define MIN_CELL_SIZE 4
+#define MAX_CELL_SIZE (2 * DEFAULT_IMAGE_SIZE)
+
+// Het standaard maximum aantal frames per seconde (aan te passen via -r, 0 = geen limiet).
+#define DEFAULT_MAX_FPS 60
 int determine_img_win_size(int cols, int rows, int *out_image_size, int *out_window_w, int *out_window_h);
-void initialize_gui(int window_width, int window_height);
+void initialize_gui(Game *game, int window_width, int window_height, int max_fps, bool vsync, const char *journal_file);
+void initialize_world_gui(World *world, int window_width, int window_height, int max_fps, bool vsync);
 void free_gui();
 void draw_window();
 void read_input();
-int init_states();
 extern int should_continue;
-int load_file(const char *filename);
-void save_game();
 
 #endif // MINESWEEPER_GUI_H
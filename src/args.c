@@ -20,6 +20,18 @@ int parse_args(int argc, char *argv[], Args *out_args)
     out_args->w = -1;
     out_args->h = -1;
     out_args->m = -1;
+    out_args->fps = -1;
+    out_args->vsync = 0;
+    out_args->binary = 0;
+    out_args->durable = 0;
+    out_args->journal = NULL;
+    out_args->seed = 0;
+    out_args->has_seed = 0;
+    out_args->threads = 0;
+    out_args->no_guess = 0;
+    out_args->games = 0;
+    out_args->world = NULL;
+    out_args->sparse = 0;
 
     // CLI arguments: zie HOC Slides 3c_advanced.pdf, vanaf dia 4
     for (int i = 1; i < argc; ++i)
@@ -97,26 +109,218 @@ int parse_args(int argc, char *argv[], Args *out_args)
             }
             break;
         }
+        case 'r': // -r <maximum frames per seconde>
+        {
+            if (strcmp(arg, "-r") != 0)
+            {
+                fprintf(stderr, "Unknown argument: %s\n", arg);
+                return 1;
+            }
+            if (i + 1 < argc)
+                out_args->fps = atoi(argv[++i]);
+            else
+            {
+                fprintf(stderr, "Missing frame rate after -r\n");
+                return 1;
+            }
+            if (out_args->fps < 0)
+            {
+                fprintf(stderr, "Frame rate may not be negative\n");
+                return 1;
+            }
+            break;
+        }
+        case 'v': // -v (vsync)
+        {
+            if (strcmp(arg, "-v") != 0)
+            {
+                fprintf(stderr, "Unknown argument: %s\n", arg);
+                return 1;
+            }
+            out_args->vsync = 1;
+            break;
+        }
+        case 'b': // -b (binair opslaan)
+        {
+            if (strcmp(arg, "-b") != 0)
+            {
+                fprintf(stderr, "Unknown argument: %s\n", arg);
+                return 1;
+            }
+            out_args->binary = 1;
+            break;
+        }
+        case 'd': // -d (duurzaam opslaan)
+        {
+            if (strcmp(arg, "-d") != 0)
+            {
+                fprintf(stderr, "Unknown argument: %s\n", arg);
+                return 1;
+            }
+            out_args->durable = 1;
+            break;
+        }
+        case 'a': // -a <journal>
+        {
+            if (strcmp(arg, "-a") != 0)
+            {
+                fprintf(stderr, "Unknown argument: %s\n", arg);
+                return 1;
+            }
+            if (i + 1 < argc)
+                out_args->journal = argv[++i];
+            else
+            {
+                fprintf(stderr, "Missing filename after -a\n");
+                return 1;
+            }
+            break;
+        }
+        case 's': // -s <seed>
+        {
+            if (strcmp(arg, "-s") != 0)
+            {
+                fprintf(stderr, "Unknown argument: %s\n", arg);
+                return 1;
+            }
+            if (i + 1 >= argc)
+            {
+                fprintf(stderr, "Missing seed after -s\n");
+                return 1;
+            }
+            // De seed is een getal van 64 bits; atoi zou grote seeds afkappen.
+            char *end = NULL;
+            const char *value = argv[++i];
+            out_args->seed = strtoull(value, &end, 0);
+            if (end == value || *end != '\0' || value[0] == '-')
+            {
+                fprintf(stderr, "Invalid seed: %s\n", value);
+                return 1;
+            }
+            out_args->has_seed = 1;
+            break;
+        }
+        case 'j': // -j <threads>
+        {
+            if (strcmp(arg, "-j") != 0)
+            {
+                fprintf(stderr, "Unknown argument: %s\n", arg);
+                return 1;
+            }
+            if (i + 1 < argc)
+                out_args->threads = atoi(argv[++i]);
+            else
+            {
+                fprintf(stderr, "Missing number of threads after -j\n");
+                return 1;
+            }
+            if (out_args->threads < 0)
+            {
+                fprintf(stderr, "Number of threads may not be negative\n");
+                return 1;
+            }
+            break;
+        }
+        case 'g': // -g (no-guess speelveld)
+        {
+            if (strcmp(arg, "-g") != 0)
+            {
+                fprintf(stderr, "Unknown argument: %s\n", arg);
+                return 1;
+            }
+            out_args->no_guess = 1;
+            break;
+        }
+        case 'n': // -n <spellen>
+        {
+            if (strcmp(arg, "-n") != 0)
+            {
+                fprintf(stderr, "Unknown argument: %s\n", arg);
+                return 1;
+            }
+            if (i + 1 >= argc)
+            {
+                fprintf(stderr, "Missing number of games after -n\n");
+                return 1;
+            }
+            char *end = NULL;
+            const char *value = argv[++i];
+            out_args->games = strtol(value, &end, 10);
+            if (end == value || *end != '\0' || out_args->games <= 0)
+            {
+                fprintf(stderr, "Invalid number of games: %s\n", value);
+                return 1;
+            }
+            break;
+        }
+        case 'e': // -e <map>
+        {
+            if (strcmp(arg, "-e") != 0)
+            {
+                fprintf(stderr, "Unknown argument: %s\n", arg);
+                return 1;
+            }
+            if (i + 1 < argc)
+                out_args->world = argv[++i];
+            else
+            {
+                fprintf(stderr, "Missing directory after -e\n");
+                return 1;
+            }
+            break;
+        }
+        case 'z': // -z (compact speelveld)
+        {
+            if (strcmp(arg, "-z") != 0)
+            {
+                fprintf(stderr, "Unknown argument: %s\n", arg);
+                return 1;
+            }
+            out_args->sparse = 1;
+            break;
+        }
         default: // ongekend argument
             fprintf(stderr, "Unknown argument: %s\n", arg);
             return 1;
         }
     }
 
-    // Je kan -f niet combineren met -w/-h/-m.
-    if (out_args->file && (out_args->w != -1 || out_args->h != -1 || out_args->m != -1))
+    // Je kan -f niet combineren met -w/-h/-m/-s/-g (de mijnen van een ingeladen spel liggen al vast).
+    if (out_args->file && (out_args->w != -1 || out_args->h != -1 || out_args->m != -1 || out_args->has_seed || out_args->no_guess))
+    {
+        fprintf(stderr, "Cannot combine -f with -w/-h/-m/-s/-g options\n");
+        return 1;
+    }
+
+    // Een simulatie speelt telkens nieuwe spellen, dus niet met een ingeladen spel.
+    if (out_args->file && out_args->games > 0)
+    {
+        fprintf(stderr, "Cannot combine -f with -n\n");
+        return 1;
+    }
+
+    // De wereld van -e heeft geen vaste mijnen (geen -f), geen eerste klik (geen -g) en wordt zelf bewaard (geen -a of -n).
+    if (out_args->world && (out_args->file || out_args->no_guess || out_args->journal || out_args->games > 0))
+    {
+        fprintf(stderr, "Cannot combine -e with -f/-g/-a/-n options\n");
+        return 1;
+    }
+
+    // Het speelveld van -z wordt nieuw gegenereerd (geen -f), rond de eerste klik (geen -g), en kan niet opgeslagen worden (geen -a).
+    if (out_args->sparse && (out_args->file || out_args->no_guess || out_args->journal || out_args->games > 0 || out_args->world))
     {
-        fprintf(stderr, "Cannot combine -f with -w/-h/-m options\n");
+        fprintf(stderr, "Cannot combine -z with -f/-g/-a/-n/-e options\n");
         return 1;
     }
 
     // We checken of de waarden van w, h en m geldig zijn, als er geen file wordt meegegeven.
     if (!out_args->file && out_args->w > 0 && out_args->h > 0 && out_args->m > 0)
     {
-        int total = (int)out_args->w * (int)out_args->h;
-        if ((int)out_args->m > total)
+        // Met -z kan het speelveld meer dan 2^31 cellen hebben.
+        long long total = (long long)out_args->w * (long long)out_args->h;
+        if ((long long)out_args->m > total)
         {
-            fprintf(stderr, "Number of mines (%d) may not exceed number of fields (%d)\n", out_args->m, total);
+            fprintf(stderr, "Number of mines (%d) may not exceed number of fields (%lld)\n", out_args->m, total);
             return 1;
         }
     }
@@ -10,6 +10,18 @@ typedef struct {
     int w; // -w <breedte>
     int h; // -h <hoogte>
     int m; // -m <mijnen>
+    int fps; // -r <maximum frames per seconde>
+    int vsync; // -v
+    int binary; // -b: sla op in het binaire formaat
+    int durable; // -d: sla op via fsync en een atomaire rename
+    const char *journal; // -a <journal>: hou elke zet bij in een journal
+    unsigned long long seed; // -s <seed>: de seed voor het plaatsen van de mijnen
+    int has_seed; // of er een seed werd meegegeven
+    int threads; // -j <threads>: het aantal threads voor het genereren of de simulatie (0 = 1 per core)
+    int no_guess; // -g: genereer een speelveld dat zonder gokken op te lossen is
+    long games; // -n <spellen>: speel zoveel spellen zonder venster (simulatie), 0 = gewoon spelen
+    const char *world; // -e <map>: speel in een oneindige wereld, opgeslagen in deze map
+    int sparse; // -z: sla een enorm speelveld met weinig mijnen compact op (zie sparse.h)
 } Args;
 
 int parse_args(int argc, char *argv[], Args *args);
@@ -0,0 +1,317 @@
+#include <stdlib.h>
+#include <string.h>
+#include "bitplane.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BITPLANE_HAVE_SSE2 1
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define BITPLANE_HAVE_AVX2 1
+#endif
+
+// We alloceren een lege bitplane voor een speelveld van w op h cellen, inclusief de lege randen.
+int bitplane_init(Bitplane *bp, int w, int h)
+{
+    if (!bp || w <= 0 || h <= 0)
+        return -1;
+    bp->width = w;
+    bp->height = h;
+    bp->words = (w + 63) / 64;
+    bp->stride = bp->words + 2;
+    bp->bits = (uint64_t *)calloc((size_t)bp->stride * (size_t)(h + 2), sizeof(uint64_t));
+    if (!bp->bits)
+        return -1;
+    return 0;
+}
+
+void bitplane_free(Bitplane *bp)
+{
+    if (bp && bp->bits)
+    {
+        free(bp->bits);
+        bp->bits = NULL;
+    }
+}
+
+void bitplane_clear(Bitplane *bp)
+{
+    memset(bp->bits, 0, (size_t)bp->stride * (size_t)(bp->height + 2) * sizeof(uint64_t));
+}
+
+/*
+ * We zetten de bit van elke mijn uit de (gepackte) cellen in de rijen [y0, y1) van de bitplane.
+ * Enkel die rijen worden geschreven, zodat verschillende threads elk hun eigen band kunnen invullen.
+ */
+void bitplane_from_mines_rows(Bitplane *bp, const Cell *cells, int y0, int y1)
+{
+    for (int y = y0; y < y1; ++y)
+    {
+        const Cell *row = cells + (size_t)y * (size_t)bp->width;
+        uint64_t *out = bitplane_row(bp, y);
+        memset(out, 0, (size_t)bp->words * sizeof(uint64_t));
+        for (int x = 0; x < bp->width; ++x)
+            out[x >> 6] |= (uint64_t)cell_is_mine(row[x]) << (x & 63);
+    }
+}
+
+// We zetten de bit van elke mijn uit de (gepackte) cellen in de bitplane.
+void bitplane_from_mines(Bitplane *bp, const Cell *cells)
+{
+    bitplane_clear(bp);
+    bitplane_from_mines_rows(bp, cells, 0, bp->height);
+}
+
+/*
+ * Telt 8 vectoren van 1 bit per cell op tot een getal van 4 bits per cell (o0 = laagste bit).
+ * Dit is een netwerk van full/half adders dat op alle bits tegelijk werkt (bit-slice optelling).
+ * De macro wordt gedeeld door de scalaire, SSE2 en AVX2 versie, die elk hun eigen XOR/AND/OR meegeven.
+ */
+#define BITSLICE_SUM8(T, XOR, AND, OR, a, b, c, d, e, f, g, h, o0, o1, o2, o3) \
+    do                                                                          \
+    {                                                                           \
+        T ab_ = XOR(a, b), s1_ = XOR(ab_, c);                                   \
+        T c1_ = OR(AND(a, b), AND(c, ab_));                                     \
+        T de_ = XOR(d, e), s2_ = XOR(de_, f);                                   \
+        T c2_ = OR(AND(d, e), AND(f, de_));                                     \
+        T ss_ = XOR(s1_, s2_), s3_ = XOR(ss_, g);                               \
+        T c3_ = OR(AND(s1_, s2_), AND(g, ss_));                                 \
+        o0 = XOR(s3_, h);                                                       \
+        T c4_ = AND(s3_, h);                                                    \
+        T cc_ = XOR(c1_, c2_), t_ = XOR(cc_, c3_);                              \
+        T u_ = OR(AND(c1_, c2_), AND(c3_, cc_));                                \
+        o1 = XOR(t_, c4_);                                                      \
+        T v_ = AND(t_, c4_);                                                    \
+        o2 = XOR(u_, v_);                                                       \
+        o3 = AND(u_, v_);                                                       \
+    } while (0)
+
+#define SCALAR_XOR(a, b) ((a) ^ (b))
+#define SCALAR_AND(a, b) ((a) & (b))
+#define SCALAR_OR(a, b) ((a) | (b))
+
+typedef void (*CountRowFn)(const uint64_t *up, const uint64_t *mid, const uint64_t *down, int words, uint64_t *s[4]);
+
+/*
+ * Berekent de 4 bit-slices van het aantal aangrenzende mijnen voor woorden [from, words) van 1 rij.
+ * De linker- en rechterburen worden bekomen door de rij 1 bit te verschuiven, met de overdracht uit het vorige/volgende woord.
+ */
+static void count_row_scalar_from(const uint64_t *up, const uint64_t *mid, const uint64_t *down, int from, int words, uint64_t *s[4])
+{
+    for (int i = from; i < words; ++i)
+    {
+        uint64_t u = up[i], ul = (u << 1) | (up[i - 1] >> 63), ur = (u >> 1) | (up[i + 1] << 63);
+        uint64_t ml = (mid[i] << 1) | (mid[i - 1] >> 63), mr = (mid[i] >> 1) | (mid[i + 1] << 63);
+        uint64_t d = down[i], dl = (d << 1) | (down[i - 1] >> 63), dr = (d >> 1) | (down[i + 1] << 63);
+        BITSLICE_SUM8(uint64_t, SCALAR_XOR, SCALAR_AND, SCALAR_OR, u, ul, ur, ml, mr, d, dl, dr,
+                      s[0][i], s[1][i], s[2][i], s[3][i]);
+    }
+}
+
+static void count_row_scalar(const uint64_t *up, const uint64_t *mid, const uint64_t *down, int words, uint64_t *s[4])
+{
+    count_row_scalar_from(up, mid, down, 0, words, s);
+}
+
+#ifdef BITPLANE_HAVE_SSE2
+// SSE2 versie: verwerkt 2 woorden (128 cellen) per iteratie, de rest gaat via de scalaire versie.
+static void count_row_sse2(const uint64_t *up, const uint64_t *mid, const uint64_t *down, int words, uint64_t *s[4])
+{
+    int i = 0;
+    for (; i + 2 <= words; i += 2)
+    {
+#define SSE_ROW(p, c, l, r)                                                      \
+    __m128i c = _mm_loadu_si128((const __m128i *)((p) + i));                     \
+    __m128i l = _mm_or_si128(_mm_slli_epi64(c, 1),                               \
+                             _mm_srli_epi64(_mm_loadu_si128((const __m128i *)((p) + i - 1)), 63)); \
+    __m128i r = _mm_or_si128(_mm_srli_epi64(c, 1),                               \
+                             _mm_slli_epi64(_mm_loadu_si128((const __m128i *)((p) + i + 1)), 63))
+        SSE_ROW(up, u, ul, ur);
+        SSE_ROW(mid, m, ml, mr);
+        SSE_ROW(down, d, dl, dr);
+#undef SSE_ROW
+        (void)m;
+        __m128i o0, o1, o2, o3;
+        BITSLICE_SUM8(__m128i, _mm_xor_si128, _mm_and_si128, _mm_or_si128, u, ul, ur, ml, mr, d, dl, dr,
+                      o0, o1, o2, o3);
+        _mm_storeu_si128((__m128i *)(s[0] + i), o0);
+        _mm_storeu_si128((__m128i *)(s[1] + i), o1);
+        _mm_storeu_si128((__m128i *)(s[2] + i), o2);
+        _mm_storeu_si128((__m128i *)(s[3] + i), o3);
+    }
+    count_row_scalar_from(up, mid, down, i, words, s);
+}
+#endif
+
+#ifdef BITPLANE_HAVE_AVX2
+// AVX2 versie: verwerkt 4 woorden (256 cellen) per iteratie. Deze wordt enkel gekozen als de CPU AVX2 ondersteunt.
+__attribute__((target("avx2"))) static void count_row_avx2(const uint64_t *up, const uint64_t *mid, const uint64_t *down, int words, uint64_t *s[4])
+{
+    int i = 0;
+    for (; i + 4 <= words; i += 4)
+    {
+#define AVX_ROW(p, c, l, r)                                                            \
+    __m256i c = _mm256_loadu_si256((const __m256i *)((p) + i));                        \
+    __m256i l = _mm256_or_si256(_mm256_slli_epi64(c, 1),                               \
+                                _mm256_srli_epi64(_mm256_loadu_si256((const __m256i *)((p) + i - 1)), 63)); \
+    __m256i r = _mm256_or_si256(_mm256_srli_epi64(c, 1),                               \
+                                _mm256_slli_epi64(_mm256_loadu_si256((const __m256i *)((p) + i + 1)), 63))
+        AVX_ROW(up, u, ul, ur);
+        AVX_ROW(mid, m, ml, mr);
+        AVX_ROW(down, d, dl, dr);
+#undef AVX_ROW
+        (void)m;
+        __m256i o0, o1, o2, o3;
+        BITSLICE_SUM8(__m256i, _mm256_xor_si256, _mm256_and_si256, _mm256_or_si256, u, ul, ur, ml, mr, d, dl, dr,
+                      o0, o1, o2, o3);
+        _mm256_storeu_si256((__m256i *)(s[0] + i), o0);
+        _mm256_storeu_si256((__m256i *)(s[1] + i), o1);
+        _mm256_storeu_si256((__m256i *)(s[2] + i), o2);
+        _mm256_storeu_si256((__m256i *)(s[3] + i), o3);
+    }
+    count_row_scalar_from(up, mid, down, i, words, s);
+}
+#endif
+
+// We kiezen eenmalig de snelste beschikbare versie van de kernel voor deze CPU.
+static CountRowFn select_count_row()
+{
+#ifdef BITPLANE_HAVE_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return count_row_avx2;
+#endif
+#ifdef BITPLANE_HAVE_SSE2
+    return count_row_sse2;
+#else
+    return count_row_scalar;
+#endif
+}
+
+/*
+ * Tabel die 8 bits uitspreidt over 8 bytes (bit j -> byte j met waarde 0 of 1).
+ * De tabel wordt byte per byte opgebouwd, zodat ze klopt ongeacht de endianness van het platform.
+ */
+static uint64_t spread_table[256];
+static bool spread_table_ready = false;
+
+static void init_spread_table()
+{
+    for (int v = 0; v < 256; ++v)
+    {
+        uint8_t bytes[8];
+        for (int j = 0; j < 8; ++j)
+            bytes[j] = (v >> j) & 1;
+        memcpy(&spread_table[v], bytes, sizeof(bytes));
+    }
+    spread_table_ready = true;
+}
+
+static CountRowFn count_row = NULL;
+
+/*
+ * Kiest de kernel en bouwt de spread_table op. Dit gebeurt lui bij het eerste gebruik, maar moet op 1 thread gebeurd zijn
+ * vooraleer bitplane_count_neighbours_rows vanuit meerdere threads tegelijk aangeroepen wordt (anders schrijven ze
+ * tegelijk in dezelfde statics).
+ */
+void bitplane_setup()
+{
+    if (!count_row)
+        count_row = select_count_row();
+    if (!spread_table_ready)
+        init_spread_table();
+}
+
+/*
+ * Forceert een bepaalde versie van de kernel, zodat de tests elke versie kunnen vergelijken met de referentie.
+ * Geeft -1 terug als die versie niet in deze build zit of niet door de CPU ondersteund wordt.
+ */
+int bitplane_use_kernel(BitplaneKernel kernel)
+{
+    switch (kernel)
+    {
+    case BITPLANE_KERNEL_AUTO:
+        count_row = select_count_row();
+        return 0;
+    case BITPLANE_KERNEL_SCALAR:
+        count_row = count_row_scalar;
+        return 0;
+    case BITPLANE_KERNEL_SSE2:
+#ifdef BITPLANE_HAVE_SSE2
+        count_row = count_row_sse2;
+        return 0;
+#else
+        return -1;
+#endif
+    case BITPLANE_KERNEL_AVX2:
+#ifdef BITPLANE_HAVE_AVX2
+        __builtin_cpu_init();
+        if (!__builtin_cpu_supports("avx2"))
+            return -1;
+        count_row = count_row_avx2;
+        return 0;
+#else
+        return -1;
+#endif
+    }
+    return -1;
+}
+
+/*
+ * Berekent voor de rijen [y0, y1) het aantal aangrenzende mijnen op basis van de mijnen-bitplane.
+ * De rijen y0 - 1 en y1 (de halo) worden enkel gelezen: zolang de bitplane niet meer verandert,
+ * kunnen threads zo elk een eigen band van het speelveld berekenen.
+ * Het resultaat wordt in de onderste 4 bits van elke cell geschreven (CELL_MINE voor mijnen), de toestand-bits blijven behouden.
+ * Per 8 cellen worden de bit-slices via de spread_table in 1 keer omgezet naar 8 bytes.
+ */
+void bitplane_count_neighbours_rows(const Bitplane *mines, Cell *cells, int y0, int y1)
+{
+    bitplane_setup();
+
+    int words = mines->words;
+    uint64_t *slices = (uint64_t *)malloc((size_t)words * 4 * sizeof(uint64_t));
+    if (!slices)
+        return;
+    uint64_t *s[4] = {slices, slices + words, slices + 2 * words, slices + 3 * words};
+    const uint64_t state_mask = 0xF0F0F0F0F0F0F0F0ULL;
+
+    for (int y = y0; y < y1; ++y)
+    {
+        const uint64_t *mid = bitplane_row(mines, y);
+        count_row(bitplane_row(mines, y - 1), mid, bitplane_row(mines, y + 1), words, s);
+
+        Cell *row = cells + (size_t)y * (size_t)mines->width;
+        for (int x = 0; x < mines->width; x += 8)
+        {
+            int wi = x >> 6, shift = x & 63;
+            uint64_t value = spread_table[(s[0][wi] >> shift) & 0xFF] |
+                             (spread_table[(s[1][wi] >> shift) & 0xFF] << 1) |
+                             (spread_table[(s[2][wi] >> shift) & 0xFF] << 2) |
+                             (spread_table[(s[3][wi] >> shift) & 0xFF] << 3) |
+                             (spread_table[(mid[wi] >> shift) & 0xFF] * CELL_MINE);
+            int n = mines->width - x < 8 ? mines->width - x : 8;
+            if (n == 8)
+            {
+                uint64_t old;
+                memcpy(&old, row + x, 8);
+                old = (old & state_mask) | value;
+                memcpy(row + x, &old, 8);
+            }
+            else
+            {
+                uint8_t bytes[8];
+                memcpy(bytes, &value, 8);
+                for (int j = 0; j < n; ++j)
+                    row[x + j] = (Cell)((row[x + j] & CELL_STATE_MASK) | bytes[j]);
+            }
+        }
+    }
+    free(slices);
+}
+
+// Berekent voor alle cellen het aantal aangrenzende mijnen (zie bitplane_count_neighbours_rows).
+void bitplane_count_neighbours(const Bitplane *mines, Cell *cells)
+{
+    bitplane_count_neighbours_rows(mines, cells, 0, mines->height);
+}
@@ -0,0 +1,59 @@
+#ifndef MINESWEEPER_BITPLANE_H
+#define MINESWEEPER_BITPLANE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "map.h"
+
+/*
+ * Een bitplane slaat 1 bit per cell op (bv. "is een mijn").
+ * Elke rij wordt opgevuld tot een veelvoud van 64 bits en krijgt links en rechts een extra leeg woord.
+ * Boven en onder het speelveld is er ook telkens een lege rij.
+ * Zo kan de buren-kernel over de randen lezen zonder bounds checks.
+ */
+typedef struct
+{
+    int width;
+    int height;
+    int words;  // aantal 64-bit woorden met data per rij
+    int stride; // aantal woorden per rij, inclusief de 2 lege randwoorden
+    uint64_t *bits;
+} Bitplane;
+
+int bitplane_init(Bitplane *bp, int w, int h);
+void bitplane_free(Bitplane *bp);
+void bitplane_clear(Bitplane *bp);
+
+// Geeft een pointer naar het eerste data-woord van rij y (y mag -1 of height zijn voor de lege randrijen).
+static inline uint64_t *bitplane_row(const Bitplane *bp, int y)
+{
+    return bp->bits + (size_t)(y + 1) * (size_t)bp->stride + 1;
+}
+
+static inline void bitplane_set(Bitplane *bp, int x, int y)
+{
+    bitplane_row(bp, y)[x >> 6] |= (uint64_t)1 << (x & 63);
+}
+
+static inline bool bitplane_test(const Bitplane *bp, int x, int y)
+{
+    return (bitplane_row(bp, y)[x >> 6] >> (x & 63)) & 1;
+}
+
+// De verschillende versies van de buren-kernel, AUTO kiest de snelste die de CPU ondersteunt.
+typedef enum
+{
+    BITPLANE_KERNEL_AUTO,
+    BITPLANE_KERNEL_SCALAR,
+    BITPLANE_KERNEL_SSE2,
+    BITPLANE_KERNEL_AVX2
+} BitplaneKernel;
+
+void bitplane_setup();
+int bitplane_use_kernel(BitplaneKernel kernel);
+void bitplane_from_mines(Bitplane *bp, const Cell *cells);
+void bitplane_from_mines_rows(Bitplane *bp, const Cell *cells, int y0, int y1);
+void bitplane_count_neighbours(const Bitplane *mines, Cell *cells);
+void bitplane_count_neighbours_rows(const Bitplane *mines, Cell *cells, int y0, int y1);
+
+#endif // MINESWEEPER_BITPLANE_H
@@ -0,0 +1,58 @@
+#include <stdlib.h>
+#include "dirty.h"
+
+// Een nieuwe dirty list begint met een volledige redraw, aangezien er nog niets getekend werd.
+void dirty_init(DirtyList *list)
+{
+    list->spans = NULL;
+    list->count = 0;
+    list->capacity = 0;
+    list->full = true;
+}
+
+void dirty_free(DirtyList *list)
+{
+    free(list->spans);
+    list->spans = NULL;
+    list->count = 0;
+    list->capacity = 0;
+}
+
+// Wordt door de GUI aangeroepen nadat alle veranderde cellen getekend zijn.
+void dirty_clear(DirtyList *list)
+{
+    list->count = 0;
+    list->full = false;
+}
+
+void dirty_mark_all(DirtyList *list)
+{
+    list->count = 0;
+    list->full = true;
+}
+
+/*
+ * Voegt een span toe aan de lijst.
+ * Als de lijst te groot wordt (of er geen geheugen meer is), schakelen we over op een volledige redraw.
+ */
+void dirty_add(DirtyList *list, int y, int x0, int x1)
+{
+    if (!list || list->full)
+        return;
+    if (list->count == list->capacity)
+    {
+        size_t capacity = list->capacity ? list->capacity * 2 : 64;
+        DirtySpan *spans = capacity <= DIRTY_MAX_SPANS ? (DirtySpan *)realloc(list->spans, capacity * sizeof(DirtySpan)) : NULL;
+        if (!spans)
+        {
+            dirty_mark_all(list);
+            return;
+        }
+        list->spans = spans;
+        list->capacity = capacity;
+    }
+    list->spans[list->count].y = y;
+    list->spans[list->count].x0 = x0;
+    list->spans[list->count].x1 = x1;
+    list->count++;
+}
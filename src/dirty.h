@@ -0,0 +1,37 @@
+#ifndef MINESWEEPER_DIRTY_H
+#define MINESWEEPER_DIRTY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Het maximaal aantal spans in de lijst; daarboven tekenen we gewoon het volledige speelveld opnieuw.
+#define DIRTY_MAX_SPANS 65536
+
+// Een horizontale reeks cellen [x0, x1] in rij y waarvan de toestand veranderd is.
+typedef struct
+{
+    int y;
+    int x0;
+    int x1;
+} DirtySpan;
+
+/*
+ * De dirty list houdt bij welke cellen sinds de laatste frame veranderd zijn.
+ * De game core vult de lijst bij elke toestandsverandering, de GUI tekent enkel die cellen opnieuw.
+ * Wanneer full waar is, moet het volledige speelveld opnieuw getekend worden.
+ */
+typedef struct
+{
+    DirtySpan *spans;
+    size_t count;
+    size_t capacity;
+    bool full;
+} DirtyList;
+
+void dirty_init(DirtyList *list);
+void dirty_free(DirtyList *list);
+void dirty_clear(DirtyList *list);
+void dirty_mark_all(DirtyList *list);
+void dirty_add(DirtyList *list, int y, int x0, int x1);
+
+#endif // MINESWEEPER_DIRTY_H
@@ -1,145 +1,712 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include "files.h"
+#include "bitplane.h"
 
-/*
- * Deze functie leest alle lijnen van een bestand uit en slaat deze op in een dynamisch gealloceerde array van char pointers.
- * De gelezen lijnen worden teruggegeven via de out_lines en het aantal lijnen via out_count.
- * Zie HOC Slides 4_input_output:
- * - dia 16 voor FILE
- * - dia 58 voor fopen
- * - dia 18 voor fclose
- * - dia 31 voor fgets
- * Zie HOC Slides 3b_structures:
- * - dia 37 voor malloc
- * - dia 49 voor realloc
- * Zie HOC Slides 3c_advanced:
- * - dia 49 voor memcpy
- */
-int read_lines(const char *filename, char ***out_lines, int *out_count)
+// We mappen het volledige bestand in het geheugen. Een leeg bestand kan niet gemapt worden en geeft ook een fout.
+int map_file(const char *filename, MappedFile *out)
 {
-    if (!filename || !out_lines || !out_count)
+    memset(out, 0, sizeof(*out));
+#ifdef _WIN32
+    out->file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (out->file == INVALID_HANDLE_VALUE)
         return -1;
-    FILE *f = fopen(filename, "r");
-    if (!f)
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(out->file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(out->file);
         return -1;
-    // We alloceren geheugen voor het inlezen van 22 lijnen van char arrays (pointers).
-    int max = 22; // max aantal lijnen die gelezen worden
-    char **lines = malloc(max * sizeof(char *));
-    if (!lines)
+    }
+    out->mapping = CreateFileMappingA(out->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!out->mapping)
+    {
+        CloseHandle(out->file);
+        return -1;
+    }
+    out->data = (const char *)MapViewOfFile(out->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!out->data)
     {
-        fclose(f);
+        CloseHandle(out->mapping);
+        CloseHandle(out->file);
         return -1;
     }
+    out->size = (size_t)size.QuadPart;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return -1;
+    }
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // De mapping blijft geldig nadat de file descriptor gesloten is.
+    close(fd);
+    if (data == MAP_FAILED)
+        return -1;
+    // We lezen het bestand 1 keer van voor naar achter.
+    madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+    out->data = (const char *)data;
+    out->size = (size_t)st.st_size;
+#endif
+    return 0;
+}
+
+void unmap_file(MappedFile *f)
+{
+    if (!f->data)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(f->data);
+    CloseHandle(f->mapping);
+    CloseHandle(f->file);
+#else
+    munmap((void *)f->data, f->size);
+#endif
+    f->data = NULL;
+}
+
+/*
+ * De klasse van elk karakter in een speelveld-bestand, via een opzoektabel zodat de parser per byte maar 1 keer vertakt.
+ * Waarden 0 t.e.m. 15 zijn de bits die in de cell gezet worden; de overige waarden zijn speciale klassen.
+ */
+#define CHAR_INVALID 0xFF
+#define CHAR_SPACE 0xFE
+#define CHAR_NEWLINE 0xFD
+
+static uint8_t field_chars[256];
+static uint8_t state_chars[256];
+static bool char_tables_ready = false;
 
-    // buffer voor het opslaan van een lijn
-    // elke lijn heeft max 22 chars + null terminator
-    char buffer[23];
-    // aantal gelezen lijnen
-    int count = 0;
-    // We lezen de lijnen uit het bestand via fgets.
-    while (fgets(buffer, sizeof(buffer), f))
+static void init_char_tables()
+{
+    memset(field_chars, CHAR_INVALID, sizeof(field_chars));
+    memset(state_chars, CHAR_INVALID, sizeof(state_chars));
+    const unsigned char whitespace[] = {' ', '\t', '\r'};
+    for (size_t i = 0; i < sizeof(whitespace); ++i)
     {
-        /*
-         * In een bestand zijn telkens 2 speelvelden opgeslagen (covered en uncovered).
-         * Deze speelvelden worden gescheiden door een lege lijn.
-         * Elke lijn van een speelveld heeft een newline character op het einde.
-         * Om op de juiste manier een lijn te lezen, moeten we dus de eind terminators verwijderen.
-         */
-        int len = strlen(buffer);
-        while (len > 0 && (buffer[len - 1] == '\n' || buffer[len - 1] == '\r'))
-            buffer[--len] = '\0';
+        field_chars[whitespace[i]] = CHAR_SPACE;
+        state_chars[whitespace[i]] = CHAR_SPACE;
+    }
+    field_chars['\n'] = CHAR_NEWLINE;
+    state_chars['\n'] = CHAR_NEWLINE;
+    for (int d = 0; d <= 8; ++d)
+        field_chars['0' + d] = (uint8_t)d;
+    field_chars['M'] = CELL_MINE;
+    state_chars['#'] = 0;
+    state_chars['U'] = CELL_UNCOVERED;
+    state_chars['F'] = CELL_FLAGGED;
+    char_tables_ready = true;
+}
 
-        // We alloceren geheugen voor het opslaan van de gelezen lijn.
-        char *line = malloc(len + 1); // + 1 voor de null terminator
-        if (!line)
+/*
+ * Parset 1 lijn vanaf positie *pos en schrijft maximaal max_cells cellen naar row (OR met de bits uit de tabel).
+ * Na afloop staat *pos op het begin van de volgende lijn. Geeft het aantal cellen op de lijn terug,
+ * of -1 bij een ongeldig karakter of te veel cellen (de fout wordt dan uitgeprint met lijn- en kolomnummer).
+ */
+static long parse_line(const char *filename, const MappedFile *f, size_t *pos, long line, const uint8_t *table,
+                       const char *expected, Cell *row, long max_cells)
+{
+    size_t start = *pos, i = start;
+    long cells = 0;
+    // Snel pad voor het formaat dat save_field schrijft: telkens 1 karakter gevolgd door 1 spatie.
+    while (cells < max_cells && i + 1 < f->size && f->data[i + 1] == ' ')
+    {
+        uint8_t v = table[(unsigned char)f->data[i]];
+        if (v > CELL_VALUE_MASK)
+            break;
+        row[cells++] |= v;
+        i += 2;
+    }
+    // De rest van de lijn (andere witruimte, het einde van de lijn of een fout) gaat via de algemene lus.
+    for (; i < f->size; ++i)
+    {
+        uint8_t v = table[(unsigned char)f->data[i]];
+        if (v == CHAR_SPACE)
+            continue;
+        if (v == CHAR_NEWLINE)
+            break;
+        if (v == CHAR_INVALID)
         {
-            for (int i = 0; i < count; ++i)
-            {
-                free(lines[i]);
-            }
-            free(lines);
-            fclose(f);
+            fprintf(stderr, "%s:%ld:%zu: unexpected character '%c' (expected %s)\n", filename, line, i - start + 1, f->data[i], expected);
+            return -1;
+        }
+        if (cells == max_cells)
+        {
+            fprintf(stderr, "%s:%ld:%zu: row has more than %ld cells\n", filename, line, i - start + 1, max_cells);
             return -1;
         }
+        row[cells++] |= v;
+    }
+    *pos = i < f->size ? i + 1 : i;
+    return cells;
+}
+
+/*
+ * Telt het aantal cellen op de lijn vanaf pos (enkel gebruikt voor de eerste lijn, om de breedte te kennen).
+ * De lengte van de lijn (inclusief newline) wordt via out_length teruggegeven.
+ */
+static long count_line_cells(const MappedFile *f, size_t pos, size_t *out_length)
+{
+    size_t start = pos;
+    long cells = 0;
+    for (; pos < f->size && f->data[pos] != '\n'; ++pos)
+        if (field_chars[(unsigned char)f->data[pos]] != CHAR_SPACE)
+            cells++;
+    *out_length = pos - start + 1;
+    return cells;
+}
+
+/*
+ * Schrijft size bytes in 1 keer naar het bestand.
+ * Met durable schrijven we eerst naar een tijdelijk bestand, dat we naar de schijf flushen (fsync) en daarna
+ * atomair hernoemen: na een crash bestaat het bestand dan ofwel volledig, ofwel niet.
+ */
+int write_file(const char *filename, const void *data, size_t size, bool durable)
+{
+    char tmp[1024];
+    const char *path = filename;
+    if (durable)
+    {
+        if (snprintf(tmp, sizeof(tmp), "%s.tmp", filename) >= (int)sizeof(tmp))
+            return -1;
+        path = tmp;
+    }
+    FILE *out = fopen(path, "wb");
+    if (!out)
+        return -1;
+    bool ok = fwrite(data, 1, size, out) == size;
+    if (ok && durable)
+    {
+        ok = fflush(out) == 0;
+#ifdef _WIN32
+        ok = ok && _commit(_fileno(out)) == 0;
+#else
+        ok = ok && fsync(fileno(out)) == 0;
+#endif
+    }
+    ok = fclose(out) == 0 && ok;
+    if (durable)
+    {
+#ifdef _WIN32
+        ok = ok && MoveFileExA(path, filename, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+        ok = ok && rename(path, filename) == 0;
+#endif
+        if (!ok)
+            remove(path);
+    }
+    return ok ? 0 : -1;
+}
 
-        // We kopiëren de gelezen lijn naar het gealloceerde geheugen van line.
-        memcpy(line, buffer, len + 1);
-        // We slaan de lijn op in de lines array.
-        lines[count++] = line;
+/*
+ * Het binaire formaat (zie files.h voor de layout en de header). Alle getallen worden little-endian opgeslagen,
+ * byte per byte, zodat het bestand op elk platform hetzelfde is.
+ */
+
+// De 2-bit toestanden in de state plane: bit 0 = uncovered, bit 1 = flagged (beide kan, bv. een gevlagde cell die mee open ging).
+#define STATE_COVERED 0
+#define STATE_UNCOVERED 1
+#define STATE_FLAGGED 2
+
+// Schrijft v als varint (7 bits per byte, de hoogste bit geeft aan dat er nog een byte volgt). Geeft het aantal bytes terug.
+static size_t put_varint(uint8_t *p, uint64_t v)
+{
+    size_t n = 0;
+    while (v >= 0x80)
+    {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
     }
+    p[n++] = (uint8_t)v;
+    return n;
+}
 
-    fclose(f);
-    *out_lines = lines;
-    *out_count = count;
+// Leest een varint vanaf *pos; geeft -1 terug als de buffer te vroeg eindigt of de varint te lang is.
+static int get_varint(const uint8_t *data, size_t size, size_t *pos, uint64_t *out)
+{
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (*pos >= size)
+            return -1;
+        uint8_t byte = data[(*pos)++];
+        v |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            *out = v;
+            return 0;
+        }
+    }
+    return -1;
+}
 
-    return 0;
+/*
+ * Leest n (<= 64) bits vanaf bitpositie bit uit een bit-packed plane van size bytes.
+ * Bytes voorbij het einde van de plane tellen als 0.
+ */
+static uint64_t read_bits(const uint8_t *plane, size_t size, size_t bit, int n)
+{
+    size_t byte = bit / 8;
+    int shift = (int)(bit % 8);
+    uint64_t v = 0;
+    for (int i = 0; i < 8 && byte + i < size; ++i)
+        v |= (uint64_t)plane[byte + i] << (8 * i);
+    v >>= shift;
+    if (shift && byte + 8 < size)
+        v |= (uint64_t)plane[byte + 8] << (64 - shift);
+    return n == 64 ? v : v & (((uint64_t)1 << n) - 1);
 }
 
-// We dealloceren het geheugen gebruikt voor het inlezen van de "lines" uit een bestand.
-void free_lines(char **lines, int count)
+static inline int popcount64(uint64_t v)
 {
-    if (!lines)
-        return;
-    for (int i = 0; i < count; ++i)
+#if defined(__GNUC__)
+    return __builtin_popcountll(v);
+#else
+    int n = 0;
+    for (; v; v &= v - 1)
+        n++;
+    return n;
+#endif
+}
+
+// De 2-bit toestand van een cell; uncovered_bit is de bit die als uncovered geldt (zie encode_field_binary).
+static inline unsigned cell_state(Cell c, Cell uncovered_bit)
+{
+    return (cell_has(c, uncovered_bit) ? STATE_UNCOVERED : 0) | (cell_has(c, CELL_FLAGGED) ? STATE_FLAGGED : 0);
+}
+
+// Het minimum aantal covered cellen op rij vooraleer we een run beginnen (een kortere run kost meer dan de 2-bit cellen zelf).
+#define RLE_MIN_RUN 16
+
+/*
+ * Codeert de toestanden met run-length encoding van lange reeksen covered cellen.
+ * Het resultaat is een opeenvolging van paren (varint covered, varint n, n cellen van 2 bits) tot alle cellen beschreven zijn.
+ * Geeft de lengte van de gecodeerde data terug, of 0 als die niet korter zou zijn dan de gewone state plane (max bytes).
+ */
+static size_t encode_states_rle(const Board *b, Cell uncovered_bit, uint8_t *out, size_t max)
+{
+    size_t cells = map_cell_count(b), i = 0, len = 0;
+    while (i < cells)
     {
-        if (lines[i])
-            free(lines[i]);
+        size_t run = 0;
+        while (i + run < cells && cell_state(b->cells[i + run], uncovered_bit) == STATE_COVERED)
+            run++;
+        // We zoeken het einde van de letterlijke reeks: de volgende run van minstens RLE_MIN_RUN covered cellen.
+        size_t start = i + run, end = start, covered = 0;
+        while (end < cells && covered < RLE_MIN_RUN)
+        {
+            covered = cell_state(b->cells[end], uncovered_bit) == STATE_COVERED ? covered + 1 : 0;
+            end++;
+        }
+        if (covered >= RLE_MIN_RUN)
+            end -= covered;
+        size_t literal = end - start;
+        // Een paar kost maximaal 2 varints van 10 bytes, plus de letterlijke cellen.
+        if (len + 20 + (literal + 3) / 4 > max)
+            return 0;
+        len += put_varint(out + len, run);
+        len += put_varint(out + len, literal);
+        memset(out + len, 0, (literal + 3) / 4);
+        for (size_t k = 0; k < literal; ++k)
+            out[len + k / 4] |= (uint8_t)(cell_state(b->cells[start + k], uncovered_bit) << (2 * (k % 4)));
+        len += (literal + 3) / 4;
+        i = end;
     }
-    free(lines);
+    return len;
 }
 
 /*
- * Sla het speelveld op in een bestand via de 's' key.
- * Zie HOC Slides 4_input_output:
- * - dia 16 voor FILE
- * - dia 58 voor fopen
- * - dia 57 voor fputc
+ * Codeert het speelveld in het binaire formaat in 1 nieuwe buffer (vrij te geven met free), en geeft de lengte terug via out_size.
+ * uncovered_bit is de bit die als uncovered opgeslagen wordt: normaal CELL_UNCOVERED, maar terwijl show_all actief is
+ * staat de echte toestand in CELL_SAVED_UNCOVERED.
  */
-int save_field(const char *filename, int w, int h, const char *map, char *flagged, char *uncovered)
+uint8_t *encode_field_binary(const Board *b, uint64_t seed, Cell uncovered_bit, size_t *out_size)
 {
-    if (!filename || !map)
+    size_t cells = map_cell_count(b);
+    size_t mine_bytes = (cells + 7) / 8, state_bytes = (cells + 3) / 4;
+    uint8_t *buf = (uint8_t *)calloc(BINARY_HEADER_SIZE + mine_bytes + state_bytes, 1);
+    if (!buf)
+        return NULL;
+
+    uint8_t *mines = buf + BINARY_HEADER_SIZE;
+    for (size_t i = 0; i < cells; ++i)
+        mines[i / 8] |= (uint8_t)(cell_is_mine(b->cells[i]) << (i % 8));
+
+    // Eerst proberen we de RLE codering; als die niet korter is, schrijven we de gewone state plane.
+    uint8_t *states = mines + mine_bytes;
+    uint16_t flags = 0;
+    size_t len = encode_states_rle(b, uncovered_bit, states, state_bytes);
+    if (len > 0)
+        flags |= BINARY_FLAG_RLE;
+    else
+    {
+        memset(states, 0, state_bytes);
+        for (size_t i = 0; i < cells; ++i)
+            states[i / 4] |= (uint8_t)(cell_state(b->cells[i], uncovered_bit) << (2 * (i % 4)));
+        len = state_bytes;
+    }
+
+    memcpy(buf, BINARY_MAGIC, 4);
+    put_u16(buf + 4, BINARY_VERSION);
+    put_u16(buf + 6, flags);
+    put_u32(buf + 8, (uint32_t)b->width);
+    put_u32(buf + 12, (uint32_t)b->height);
+    put_u32(buf + 16, (uint32_t)b->mines);
+    put_u32(buf + 20, 0);
+    put_u64(buf + 24, seed);
+    *out_size = BINARY_HEADER_SIZE + mine_bytes + len;
+    return buf;
+}
+
+/*
+ * Slaat het speelveld op in het binaire formaat.
+ * Het volledige bestand wordt eerst in 1 buffer opgebouwd en daarna in 1 keer weggeschreven.
+ */
+int save_field_binary(const char *filename, const Board *b, uint64_t seed, bool durable)
+{
+    if (!filename || !b)
         return -1;
-    // We openen het aangemaakte bestand voor "writing".
-    FILE *out = fopen(filename, "w");
-    if (!out)
+    size_t size = 0;
+    uint8_t *buf = encode_field_binary(b, seed, CELL_UNCOVERED, &size);
+    if (!buf)
+        return -1;
+    int result = write_file(filename, buf, size, durable);
+    free(buf);
+    return result;
+}
+
+/*
+ * Parset size bytes in het binaire formaat (vanaf BINARY_MAGIC) in het bord out.
+ * De data staat al in het geheugen: een gemapt bestand, of een momentopname in een journal (zie journal.c).
+ * filename wordt enkel gebruikt in de foutmeldingen.
+ */
+int parse_field_binary(const char *filename, const uint8_t *data, size_t size, Board *out, uint64_t *out_seed)
+{
+    if (size < BINARY_HEADER_SIZE)
+    {
+        fprintf(stderr, "%s: truncated header (%zu bytes)\n", filename, size);
+        return -1;
+    }
+    if (memcmp(data, BINARY_MAGIC, 4) != 0)
+    {
+        fprintf(stderr, "%s: not a binary field (bad magic)\n", filename);
+        return -1;
+    }
+    uint16_t version = get_u16(data + 4), flags = get_u16(data + 6);
+    uint32_t w = get_u32(data + 8), h = get_u32(data + 12), mines = get_u32(data + 16);
+    if (version != BINARY_VERSION)
+    {
+        fprintf(stderr, "%s: unsupported version %u (expected %u)\n", filename, version, BINARY_VERSION);
+        return -1;
+    }
+    if (flags & ~BINARY_FLAG_RLE)
+    {
+        fprintf(stderr, "%s: unknown flags 0x%04x\n", filename, flags);
+        return -1;
+    }
+    if (w == 0 || h == 0 || w > INT_MAX || h > INT_MAX || (uint64_t)w * h > SIZE_MAX / 4)
+    {
+        fprintf(stderr, "%s: invalid dimensions %ux%u\n", filename, w, h);
+        return -1;
+    }
+    size_t cells = (size_t)w * h, mine_bytes = (cells + 7) / 8;
+    if (size < BINARY_HEADER_SIZE + mine_bytes)
+    {
+        fprintf(stderr, "%s: truncated mine plane\n", filename);
+        return -1;
+    }
+
+    /*
+     * De mijnen zijn al bit-packed: we kopiëren ze per 64 cellen rechtstreeks naar een bitplane,
+     * waaruit de kernel daarna de getallen (en de mijnen) in de cellen schrijft.
+     */
+    Bitplane bp;
+    if (bitplane_init(&bp, (int)w, (int)h) != 0)
+        return -1;
+    Cell *board = (Cell *)calloc(cells, sizeof(Cell));
+    if (!board)
+    {
+        bitplane_free(&bp);
+        return -1;
+    }
+    const uint8_t *plane = data + BINARY_HEADER_SIZE;
+    size_t counted = 0;
+    for (uint32_t y = 0; y < h; ++y)
+    {
+        uint64_t *row = bitplane_row(&bp, (int)y);
+        for (int k = 0; k < bp.words; ++k)
+        {
+            int n = (int)w - 64 * k < 64 ? (int)w - 64 * k : 64;
+            row[k] = read_bits(plane, mine_bytes, (size_t)y * w + 64 * (size_t)k, n);
+            counted += popcount64(row[k]);
+        }
+    }
+    if (counted != mines)
+    {
+        fprintf(stderr, "%s: header says %u mines, mine plane has %zu\n", filename, mines, counted);
+        bitplane_free(&bp);
+        free(board);
+        return -1;
+    }
+
+    // De toestanden: ofwel RLE gecodeerd, ofwel een gewone plane van 2 bits per cell.
+    static const Cell state_bits[4] = {0, CELL_UNCOVERED, CELL_FLAGGED, CELL_UNCOVERED | CELL_FLAGGED};
+    size_t pos = BINARY_HEADER_SIZE + mine_bytes, i = 0;
+    const char *error = NULL;
+    while (i < cells && !error)
+    {
+        uint64_t run = 0, literal = cells - i;
+        if (flags & BINARY_FLAG_RLE)
+        {
+            if (get_varint(data, size, &pos, &run) != 0 || get_varint(data, size, &pos, &literal) != 0)
+                error = "truncated state runs";
+            else if (run > cells - i || literal > cells - i - run)
+                error = "state runs exceed the board";
+            if (error)
+                break;
+            i += run;
+        }
+        if (size - pos < (literal + 3) / 4)
+        {
+            error = "truncated state plane";
+            break;
+        }
+        for (size_t k = 0; k < literal; ++k)
+            board[i + k] |= state_bits[(data[pos + k / 4] >> (2 * (k % 4))) & 3];
+        pos += (literal + 3) / 4;
+        i += literal;
+    }
+    if (!error && pos != size)
+        error = "unexpected data after the state plane";
+    if (error)
+    {
+        fprintf(stderr, "%s:%zu: %s\n", filename, pos, error);
+        bitplane_free(&bp);
+        free(board);
+        return -1;
+    }
+
+    // De getallen worden niet opgeslagen; we berekenen ze opnieuw uit de mijnen (de toestand-bits blijven behouden).
+    bitplane_count_neighbours(&bp, board);
+    bitplane_free(&bp);
+    out->width = (int)w;
+    out->height = (int)h;
+    out->mines = (int)mines;
+    out->cells = board;
+    if (out_seed)
+        *out_seed = get_u64(data + 24);
+    return 0;
+}
+
+/*
+ * Laadt een opgeslagen speelveld in het bord out. Bestanden in het binaire formaat worden herkend aan hun magic.
+ * Het bestand bevat eerst het speelveld (0-8 of M per cell), dan optioneel een lege lijn gevolgd door de toestand
+ * van elke cell (U = uncovered, F = flagged, # = covered). Cellen worden gescheiden door spaties.
+ * Het bestand wordt gemapt en in 1 doorloop rechtstreeks in de cellen van het bord geparset; de afmetingen zijn willekeurig.
+ * Bij een fout wordt een precieze foutmelding (bestand:lijn:kolom) uitgeprint en geven we -1 terug.
+ */
+int load_field(const char *filename, Board *out, uint64_t *out_seed)
+{
+    if (!filename || !out)
         return -1;
-    // We schrijven het covered speelveld (map) naar het bestand.
-    for (int x = 0; x < w; ++x)
+    if (!char_tables_ready)
+        init_char_tables();
+
+    MappedFile f;
+    if (map_file(filename, &f) != 0)
     {
-        for (int y = 0; y < h; ++y)
+        fprintf(stderr, "%s: cannot open file or file is empty\n", filename);
+        return -1;
+    }
+    if (out_seed)
+        *out_seed = 0;
+    if (f.size >= 4 && memcmp(f.data, BINARY_MAGIC, 4) == 0)
+    {
+        int result = parse_field_binary(filename, (const uint8_t *)f.data, f.size, out, out_seed);
+        unmap_file(&f);
+        return result;
+    }
+
+    /*
+     * De breedte volgt uit de eerste lijn; de hoogte kennen we pas aan het einde van het speelveld.
+     * We schatten het aantal rijen op basis van de lengte van de eerste lijn (met de toestanden erbij is dit het dubbele,
+     * maar niet-aangeraakte pagina's van calloc kosten niets). Klopt de schatting niet, dan groeit de buffer per verdubbeling.
+     */
+    size_t line_length = 0;
+    long cols = count_line_cells(&f, 0, &line_length);
+    if (cols <= 0)
+    {
+        fprintf(stderr, "%s:1: the first row of the field is empty\n", filename);
+        unmap_file(&f);
+        return -1;
+    }
+    if (cols > INT_MAX)
+    {
+        fprintf(stderr, "%s:1: the field is too wide (%ld cells)\n", filename, cols);
+        unmap_file(&f);
+        return -1;
+    }
+    size_t capacity = f.size / line_length + 1;
+    Cell *cells = (Cell *)calloc(capacity * (size_t)cols, sizeof(Cell));
+    if (!cells)
+    {
+        unmap_file(&f);
+        return -1;
+    }
+
+    size_t pos = 0;
+    long line = 0, rows = 0;
+    bool has_states = false;
+    while (pos < f.size)
+    {
+        ++line;
+        if ((size_t)rows == capacity)
+        {
+            Cell *grown = (Cell *)realloc(cells, capacity * 2 * (size_t)cols * sizeof(Cell));
+            if (!grown)
+                goto fail;
+            memset(grown + capacity * (size_t)cols, 0, capacity * (size_t)cols * sizeof(Cell));
+            cells = grown;
+            capacity *= 2;
+        }
+        long n = parse_line(filename, &f, &pos, line, field_chars, "0-8 or M", cells + (size_t)rows * (size_t)cols, cols);
+        if (n < 0)
+            goto fail;
+        // Een lege lijn scheidt het speelveld van de toestanden.
+        if (n == 0)
+        {
+            has_states = true;
+            break;
+        }
+        if (n != cols)
+        {
+            fprintf(stderr, "%s:%ld: row has %ld cells, expected %ld\n", filename, line, n, cols);
+            goto fail;
+        }
+        if (++rows > INT_MAX)
         {
-            fputc(map[y * w + x], out);
-            fputc(' ', out);
+            fprintf(stderr, "%s:%ld: the field is too high\n", filename, line);
+            goto fail;
         }
-        fputc('\n', out);
     }
-    fputc('\n', out);
-    // We schrijven het uncovered speelveld naar het bestand.
-    for (int x = 0; x < w; ++x)
+
+    // Als er na de lege lijn niets meer volgt, bevat het bestand enkel het speelveld.
+    if (has_states)
+    {
+        size_t rest = pos;
+        while (rest < f.size && (field_chars[(unsigned char)f.data[rest]] == CHAR_SPACE || f.data[rest] == '\n'))
+            ++rest;
+        has_states = rest < f.size;
+    }
+    if (has_states)
     {
-        for (int y = 0; y < h; ++y)
+        for (long row = 0; row < rows; ++row)
         {
-            int i = y * w + x;
-            if (flagged && flagged[i])
+            ++line;
+            if (pos >= f.size)
             {
-                fputc('F', out);
-                fputc(' ', out);
+                fprintf(stderr, "%s:%ld: the state grid has %ld rows, expected %ld\n", filename, line, row, rows);
+                goto fail;
             }
-            else if (uncovered && uncovered[i])
+            long n = parse_line(filename, &f, &pos, line, state_chars, "U, F or #", cells + (size_t)row * (size_t)cols, cols);
+            if (n < 0)
+                goto fail;
+            if (n != cols)
             {
-                fputc('U', out);
-                fputc(' ', out);
+                fprintf(stderr, "%s:%ld: state row has %ld cells, expected %ld\n", filename, line, n, cols);
+                goto fail;
             }
-            else
+        }
+        // Na de toestanden mogen enkel nog lege lijnen volgen.
+        for (; pos < f.size; ++pos)
+        {
+            if (f.data[pos] == '\n')
+                ++line;
+            else if (field_chars[(unsigned char)f.data[pos]] != CHAR_SPACE)
             {
-                fputc('#', out);
-                fputc(' ', out);
+                fprintf(stderr, "%s:%ld: unexpected content after the state grid\n", filename, line + 1);
+                goto fail;
             }
         }
-        fputc('\n', out);
     }
-    fclose(out);
+    unmap_file(&f);
+
+    // We geven de ongebruikte capaciteit terug en tellen de mijnen.
+    Cell *shrunk = (Cell *)realloc(cells, (size_t)rows * (size_t)cols * sizeof(Cell));
+    if (shrunk)
+        cells = shrunk;
+    out->width = (int)cols;
+    out->height = (int)rows;
+    out->cells = cells;
+    out->mines = 0;
+    size_t count = map_cell_count(out);
+    for (size_t i = 0; i < count; ++i)
+        out->mines += cell_is_mine(cells[i]);
     return 0;
+
+fail:
+    free(cells);
+    unmap_file(&f);
+    return -1;
+}
+
+/*
+ * Sla het speelveld op in een bestand via de 's' key.
+ * Beide roosters (de getallen en de toestanden) worden rij per rij in 1 vooraf gealloceerde buffer opgebouwd,
+ * zodat we de cellen lineair doorlopen, en daarna in 1 keer weggeschreven via write_file.
+ * Elke cell wordt 1 karakter gevolgd door een spatie; elke rij eindigt op een newline en een lege lijn scheidt de roosters.
+ */
+int save_field(const char *filename, const Board *b, bool durable)
+{
+    if (!filename || !b)
+        return -1;
+    // Het karakter voor de waarde (onderste 4 bits) en voor de toestand (flagged/uncovered bits) van een cell.
+    static const char value_chars[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '?', '?', '?', '?', '?', '?', 'M'};
+    static const char state_chars[4] = {'#', 'F', 'U', 'F'};
+
+    size_t line = 2 * (size_t)b->width + 1;
+    size_t size = 2 * line * (size_t)b->height + 1;
+    char *buf = (char *)malloc(size);
+    if (!buf)
+        return -1;
+    char *p = buf;
+    for (int y = 0; y < b->height; ++y)
+    {
+        const Cell *row = &MAP_CELL(b, 0, y);
+        for (int x = 0; x < b->width; ++x)
+        {
+            *p++ = value_chars[row[x] & CELL_VALUE_MASK];
+            *p++ = ' ';
+        }
+        *p++ = '\n';
+    }
+    *p++ = '\n';
+    for (int y = 0; y < b->height; ++y)
+    {
+        const Cell *row = &MAP_CELL(b, 0, y);
+        for (int x = 0; x < b->width; ++x)
+        {
+            *p++ = state_chars[(row[x] >> 4) & 3];
+            *p++ = ' ';
+        }
+        *p++ = '\n';
+    }
+
+    int result = write_file(filename, buf, size, durable);
+    free(buf);
+    return result;
 }
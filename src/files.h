@@ -1,8 +1,87 @@
 #ifndef MINESWEEPER_FILEHANDLER_H
 #define MINESWEEPER_FILEHANDLER_H
 
-int read_lines(const char *filename, char ***out_lines, int *out_count);
-void free_lines(char **lines, int count);
-int save_field(const char *filename, int w, int h, const char *map, char *flagged, char *uncovered);
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "map.h"
+
+/*
+ * Het binaire formaat voor opgeslagen speelvelden (versie 1):
+ * - een header van 32 bytes: magic "MSWB", versie (u16), flags (u16), breedte, hoogte en aantal mijnen (u32),
+ *   4 gereserveerde bytes en de seed van de RNG (u64); alles little-endian
+ * - de mijnen: 1 bit per cell, rij per rij
+ * - de toestanden: 2 bits per cell (bit 0 = uncovered, bit 1 = flagged), of met BINARY_FLAG_RLE
+ *   een reeks paren (varint aantal covered cellen, varint n, n toestanden van 2 bits)
+ * De getallen van de cellen worden niet opgeslagen, die volgen uit de mijnen.
+ */
+#define BINARY_MAGIC "MSWB"
+#define BINARY_VERSION 1
+#define BINARY_HEADER_SIZE 32
+#define BINARY_FLAG_RLE 0x0001
+
+/*
+ * Een bestand dat volledig in het geheugen gemapt is (read-only).
+ * We lezen het bestand zo zonder kopieën of tussenbuffers: de parser loopt rechtstreeks over de gemapte bytes.
+ */
+typedef struct
+{
+    const char *data;
+    size_t size;
+#ifdef _WIN32
+    void *file;    // HANDLE van het bestand
+    void *mapping; // HANDLE van de mapping
+#endif
+} MappedFile;
+
+int map_file(const char *filename, MappedFile *out);
+void unmap_file(MappedFile *f);
+int write_file(const char *filename, const void *data, size_t size, bool durable);
+
+// Little-endian getallen, byte per byte, zodat de bestanden op elk platform hetzelfde zijn.
+static inline void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put_u32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i)
+        p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static inline void put_u64(uint8_t *p, uint64_t v)
+{
+    for (int i = 0; i < 8; ++i)
+        p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static inline uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t get_u32(const uint8_t *p)
+{
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; --i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+static inline uint64_t get_u64(const uint8_t *p)
+{
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+uint8_t *encode_field_binary(const Board *b, uint64_t seed, Cell uncovered_bit, size_t *out_size);
+int parse_field_binary(const char *filename, const uint8_t *data, size_t size, Board *out, uint64_t *out_seed);
+int load_field(const char *filename, Board *out, uint64_t *out_seed);
+int save_field_binary(const char *filename, const Board *b, uint64_t seed, bool durable);
+int save_field(const char *filename, const Board *b, bool durable);
 
 #endif // MINESWEEPER_FILEHANDLER_H
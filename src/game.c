@@ -0,0 +1,715 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "game.h"
+#include "files.h"
+#include "save.h"
+#include "journal.h"
+#include "rng.h"
+#include "noguess.h"
+
+// We alloceren een spel zonder speelveld; de aanroeper vult game->board in.
+static Game *game_alloc()
+{
+    Game *game = (Game *)calloc(1, sizeof(Game));
+    if (!game)
+        return NULL;
+    reveal_init(&game->reveal);
+    dirty_init(&game->dirty);
+    game->status = GAME_PLAYING;
+    game->losing_col = -1;
+    game->losing_row = -1;
+    return game;
+}
+
+/*
+ * We alloceren een nieuw spel met een leeg speelveld van w op h cellen.
+ * De mijnen worden pas geplaatst bij de eerste klik (of wanneer ze nodig zijn), via game_ensure_mines of game_reveal.
+ * Het spel krijgt een willekeurige seed; wie een speelveld wil herhalen, zet game->seed voor de eerste klik (zie -s).
+ */
+Game *game_new(int w, int h, int mines)
+{
+    Game *game = game_alloc();
+    if (!game)
+        return NULL;
+    if (init_map(&game->board, w, h, mines) != 0)
+    {
+        free(game);
+        return NULL;
+    }
+    game->seed = rng_random_seed();
+    return game;
+}
+
+/*
+ * We alloceren een nieuw spel met een leeg speelveld van -z (zie sparse.h): voor enorme speelvelden met weinig mijnen.
+ * Er wordt geen Cell per cell gealloceerd; game->board bevat enkel de dimensies en het aantal mijnen.
+ */
+Game *game_new_sparse(int w, int h, int mines)
+{
+    Game *game = game_alloc();
+    if (!game)
+        return NULL;
+    game->sparse = (SparseBoard *)malloc(sizeof(SparseBoard));
+    if (!game->sparse || sparse_init(game->sparse, w, h) != 0)
+    {
+        free(game->sparse);
+        free(game);
+        return NULL;
+    }
+    game->board.width = w;
+    game->board.height = h;
+    game->board.mines = mines;
+    game->seed = rng_random_seed();
+    return game;
+}
+
+// Dealloceert het spel en zijn speelveld.
+void game_free(Game *game)
+{
+    if (!game)
+        return;
+    if (game->sparse)
+    {
+        sparse_free(game->sparse);
+        free(game->sparse);
+    }
+    free_map(&game->board);
+    free_map(&game->pregenerated);
+    reveal_free(&game->reveal);
+    dirty_free(&game->dirty);
+    free(game);
+}
+
+/*
+ * Zet het spel terug naar het begin, met een nieuwe seed, zonder het speelveld opnieuw te alloceren.
+ * Bedoeld om veel spellen na elkaar op hetzelfde speelveld te spelen (zie simulate).
+ */
+void game_reset(Game *game, uint64_t seed)
+{
+    memset(game->board.cells, 0, map_cell_count(&game->board));
+    free_map(&game->pregenerated);
+    dirty_clear(&game->dirty);
+    game->mines_placed = false;
+    game->show_mines = false;
+    game->show_all = false;
+    game->status = GAME_PLAYING;
+    game->losing_col = -1;
+    game->losing_row = -1;
+    game->seed = seed;
+    game->generation_attempts = 0;
+    reveal_reset(&game->reveal);
+    game->uncovered_safe = 0;
+    game->flags_placed = 0;
+    game->correct_flags = 0;
+}
+
+GameStatus game_status(const Game *game)
+{
+    return game->status;
+}
+
+// Het aantal cellen dat de speler moet uncoveren om te winnen.
+static long long safe_cell_count(const Game *game)
+{
+    return (long long)game->board.width * game->board.height - game->board.mines;
+}
+
+// Uncover de cell (x, y) en werk de tellers en de dirty list bij.
+static void uncover_cell(Game *game, int x, int y)
+{
+    if (game->sparse)
+    {
+        if (sparse_uncover(game->sparse, x, y))
+        {
+            if (!sparse_is_mine(game->sparse, x, y))
+                game->uncovered_safe++;
+            dirty_add(&game->dirty, y, x, x);
+        }
+        return;
+    }
+    Cell *c = &MAP_CELL(&game->board, x, y);
+    if (cell_has(*c, CELL_UNCOVERED))
+        return;
+    *c |= CELL_UNCOVERED;
+    if (!cell_is_mine(*c))
+        game->uncovered_safe++;
+    dirty_add(&game->dirty, y, x, x);
+}
+
+// Zet of verwijder de vlag van de cell (x, y) en werk de tellers en de dirty list bij.
+static void set_flag(Game *game, int x, int y, bool on)
+{
+    if (game->sparse)
+    {
+        if (!sparse_set_flag(game->sparse, x, y, on))
+            return;
+        dirty_add(&game->dirty, y, x, x);
+        int delta = on ? 1 : -1;
+        game->flags_placed += delta;
+        if (sparse_is_mine(game->sparse, x, y))
+            game->correct_flags += delta;
+        return;
+    }
+    Cell *c = &MAP_CELL(&game->board, x, y);
+    if (cell_has(*c, CELL_FLAGGED) == on)
+        return;
+    cell_set(c, CELL_FLAGGED, on);
+    dirty_add(&game->dirty, y, x, x);
+    int delta = on ? 1 : -1;
+    game->flags_placed += delta;
+    if (cell_is_mine(*c))
+        game->correct_flags += delta;
+}
+
+/*
+ * Telt de tellers opnieuw met een volledige scan van het speelveld (bij het inladen, en ter controle in debug builds).
+ * De lus is zonder vertakkingen geschreven: bij een willekeurig speelveld zou de CPU anders bij bijna elke cell verkeerd gokken.
+ */
+static void count_cells(const Game *game, long long *uncovered_safe, long long *flags_placed, long long *correct_flags)
+{
+    const Board *b = &game->board;
+    size_t cells = map_cell_count(b);
+    size_t uncovered = 0, flags = 0, correct = 0;
+    for (size_t i = 0; i < cells; ++i)
+    {
+        Cell c = b->cells[i];
+        unsigned mine = (c & CELL_VALUE_MASK) == CELL_MINE;
+        unsigned flag = (c & CELL_FLAGGED) != 0;
+        uncovered += ((c & CELL_UNCOVERED) != 0) & !mine;
+        flags += flag;
+        correct += flag & mine;
+    }
+    *uncovered_safe = (long long)uncovered;
+    *flags_placed = (long long)flags;
+    *correct_flags = (long long)correct;
+}
+
+// Zet de tellers van het spel opnieuw op basis van de toestanden in het speelveld (na het inladen of afspelen van een journal).
+void game_recount(Game *game)
+{
+    count_cells(game, &game->uncovered_safe, &game->flags_placed, &game->correct_flags);
+}
+
+#ifdef MINESWEEPER_DEBUG
+// Vergelijkt de lopende tellers met een volledige scan van het speelveld (niet voor een speelveld van -z: dat zijn te veel cellen).
+static void check_counters(const Game *game)
+{
+    if (game->sparse)
+        return;
+    long long uncovered_safe, flags_placed, correct_flags;
+    count_cells(game, &uncovered_safe, &flags_placed, &correct_flags);
+    if (uncovered_safe != game->uncovered_safe || flags_placed != game->flags_placed || correct_flags != game->correct_flags)
+        fprintf(stderr, "Counter mismatch: uncovered %lld/%lld, flags %lld/%lld, correct %lld/%lld\n",
+                game->uncovered_safe, uncovered_safe, game->flags_placed, flags_placed, game->correct_flags, correct_flags);
+}
+#define CHECK_COUNTERS(game) check_counters(game)
+#else
+#define CHECK_COUNTERS(game) ((void)0)
+#endif
+
+/*
+ * Genereert het speelveld van het spel op voorhand in game->pregenerated, zonder uitgesloten cell.
+ * Dit is bedoeld voor een achtergrondthread terwijl het venster opent: de functie leest enkel de (vaste) dimensies,
+ * de seed en het aantal threads van het spel. Tot ze klaar is, mag het spel zelf geen mijnen plaatsen.
+ */
+int game_pregenerate(Game *game)
+{
+    const Board *b = &game->board;
+    Board pregenerated;
+    if (init_map(&pregenerated, b->width, b->height, b->mines) != 0)
+        return -1;
+    add_mines(&pregenerated, game->seed, game->threads, -1, -1);
+    game->pregenerated = pregenerated;
+    return 0;
+}
+
+// Na het plaatsen van de mijnen: er zijn nog geen toestanden en het hele speelveld moet opnieuw getekend worden.
+static void finish_placement(Game *game)
+{
+    game->mines_placed = true;
+    dirty_mark_all(&game->dirty);
+    game->uncovered_safe = 0;
+    game->flags_placed = 0;
+    game->correct_flags = 0;
+}
+
+/*
+ * Plaatst de mijnen van een speelveld van -z, niet op (x, y) (de eerste klik, of (-1, -1) als er nog niet geklikt werd).
+ * Als er geen geheugen is voor de index van de mijnen, wordt het een speelveld zonder mijnen.
+ */
+static void place_sparse_mines(Game *game, int x, int y)
+{
+    int mines = sparse_place_mines(game->sparse, game->board.mines, game->seed, x, y);
+    if (mines < 0)
+    {
+        fprintf(stderr, "Not enough memory for %d mines\n", game->board.mines);
+        mines = 0;
+    }
+    game->board.mines = mines;
+    finish_placement(game);
+}
+
+/*
+ * Plaatst de mijnen: het op voorhand gegenereerde speelveld wordt overgenomen (1 pointer swap),
+ * of als dat er niet is, wordt het nu gegenereerd. In beide gevallen is het speelveld hetzelfde voor dezelfde seed.
+ * Vóór het plaatsen van de mijnen zijn er nog geen toestanden (vlaggen en 'p' plaatsen eerst de mijnen).
+ */
+static void place_mines(Game *game)
+{
+    Board *b = &game->board;
+    if (game->sparse)
+    {
+        place_sparse_mines(game, -1, -1);
+        return;
+    }
+    if (!game->pregenerated.cells)
+        game_pregenerate(game);
+    if (game->pregenerated.cells)
+    {
+        free_map(b);
+        *b = game->pregenerated;
+        game->pregenerated.cells = NULL;
+    }
+    finish_placement(game);
+}
+
+/*
+ * Plaatst met -g een speelveld dat vanaf de eerste klik (x, y) zonder gokken op te lossen is.
+ * Geeft false terug als dat niet lukt; de aanroeper plaatst dan een gewoon speelveld.
+ */
+static bool place_no_guess_mines(Game *game, int x, int y)
+{
+    // Het op voorhand gegenereerde speelveld hangt niet af van de klik, dus dat kunnen we hier niet gebruiken.
+    free_map(&game->pregenerated);
+    if (generate_no_guess(&game->board, game->seed, game->threads, x, y, &game->generation_attempts) != 0)
+    {
+        game->generation_attempts = -1;
+        return false;
+    }
+    finish_placement(game);
+    return true;
+}
+
+// Telt de getallen van de (niet-mijn) buren van (x, y) op met delta (+1 bij een nieuwe mijn, -1 bij een verwijderde).
+static void patch_neighbours(Board *b, int x, int y, int delta)
+{
+    for (int ny = y - 1; ny <= y + 1; ++ny)
+    {
+        for (int nx = x - 1; nx <= x + 1; ++nx)
+        {
+            if ((nx == x && ny == y) || !map_in_bounds(b, nx, ny))
+                continue;
+            Cell *c = &MAP_CELL(b, nx, ny);
+            if (!cell_is_mine(*c))
+                cell_set_value(c, cell_neighbour_mines(*c) + delta);
+        }
+    }
+}
+
+// Zoekt een cell zonder mijn, verschillend van (x, y), voor relocate_mine. Geeft -1 terug als er geen is.
+static long find_free_cell(const Game *game, int x, int y)
+{
+    const Board *b = &game->board;
+    size_t cells = map_cell_count(b), clicked = (size_t)y * (size_t)b->width + (size_t)x;
+    if ((size_t)b->mines >= cells)
+        return -1;
+    // Een eigen stroom van de seed (de banden van add_mines gebruiken de stromen vanaf 1), zodat de keuze reproduceerbaar is.
+    Rng rng;
+    rng_seed_stream(&rng, game->seed, 0);
+    size_t start = (size_t)rng_bounded(&rng, cells);
+    // Meestal is een willekeurige cell meteen vrij; enkel bij een bijna vol speelveld zoeken we verder.
+    for (int attempt = 0; attempt < 64; ++attempt)
+    {
+        size_t i = (size_t)rng_bounded(&rng, cells);
+        if (i != clicked && !cell_is_mine(b->cells[i]))
+            return (long)i;
+    }
+    for (size_t k = 0; k < cells; ++k)
+    {
+        size_t i = (start + k) % cells;
+        if (i != clicked && !cell_is_mine(b->cells[i]))
+            return (long)i;
+    }
+    return -1;
+}
+
+/*
+ * De eerste klik mag geen mijn zijn. Ligt er toch een mijn op (x, y), dan verplaatsen we enkel die mijn naar een vrije cell
+ * en passen we de getallen van de 2 buurten aan, in plaats van het speelveld opnieuw te genereren: O(1) in plaats van O(cellen).
+ * Is er geen vrije cell (een vol speelveld), dan verdwijnt de mijn.
+ */
+static void relocate_mine(Game *game, int x, int y)
+{
+    Board *b = &game->board;
+    Cell *clicked = &MAP_CELL(b, x, y);
+    if (!cell_is_mine(*clicked))
+        return;
+    long target = find_free_cell(game, x, y);
+    if (target >= 0)
+    {
+        int tx = (int)(target % b->width), ty = (int)(target / b->width);
+        cell_set_value(&b->cells[target], CELL_MINE);
+        patch_neighbours(b, tx, ty, 1);
+    }
+    else
+        b->mines--;
+
+    // De mijn op (x, y) verdwijnt: de buren tellen 1 mijn minder en de cell zelf krijgt het aantal aangrenzende mijnen.
+    patch_neighbours(b, x, y, -1);
+    int count = 0;
+    for (int ny = y - 1; ny <= y + 1; ++ny)
+    {
+        for (int nx = x - 1; nx <= x + 1; ++nx)
+        {
+            if ((nx != x || ny != y) && map_in_bounds(b, nx, ny) && cell_is_mine(MAP_CELL(b, nx, ny)))
+                count++;
+        }
+    }
+    cell_set_value(clicked, count);
+}
+
+// Zorg ervoor dat de map gegenereerd wordt, voor acties die de mijnen nodig hebben (vlaggen, 'b' en 'p').
+void game_ensure_mines(Game *game)
+{
+    if (game->mines_placed)
+        return;
+    place_mines(game);
+}
+
+// We controleren of alle cellen die geen mijn zijn uncovered zijn.
+static bool all_number_cells_uncovered(const Game *game)
+{
+    return game->uncovered_safe == safe_cell_count(game);
+}
+
+/*
+ * We checken of de speler alle nummer cellen als uncovered heeft aangeklikt -> win
+ * Maar alleen als show_all niet actief is, en pas als de cascade volledig afgewerkt is.
+ */
+static bool check_win(Game *game)
+{
+    if (game->show_all || game_reveal_pending(game) || !all_number_cells_uncovered(game))
+        return false;
+    game->status = GAME_WON;
+    return true;
+}
+
+// Of er nog een cascade bezig is: met game->progressive wordt die over meerdere aanroepen van game_reveal_step verdeeld.
+bool game_reveal_pending(const Game *game)
+{
+    return game->sparse ? game->sparse->seed_count > 0 : reveal_pending(&game->reveal);
+}
+
+/*
+ * Werkt hoogstens budget seeds (spans) van de lopende cascade af (alles als budget < 0) en werkt de tellers bij.
+ * Als de cascade daarmee klaar is, volgt de win-detectie. Geeft het aantal nieuw uncovered cellen terug.
+ * Is het spel intussen gedaan (bv. gewonnen met vlaggen), dan wordt de rest van de cascade weggegooid.
+ */
+long long game_reveal_step(Game *game, long budget)
+{
+    if (!game_reveal_pending(game))
+        return 0;
+    if (game->status != GAME_PLAYING)
+    {
+        if (game->sparse)
+            sparse_cascade_reset(game->sparse);
+        else
+            reveal_reset(&game->reveal);
+        return 0;
+    }
+    long long uncovered = game->sparse ? sparse_cascade_continue(game->sparse, budget, &game->dirty)
+                                       : reveal_continue(&game->reveal, &game->board, budget, &game->dirty);
+    game->uncovered_safe += uncovered;
+    check_win(game);
+    CHECK_COUNTERS(game);
+    return uncovered;
+}
+
+// Werkt de lopende cascade in 1 keer af, voor acties die de volledige toestand nodig hebben (show_all, een save, een hint).
+void game_reveal_finish(Game *game)
+{
+    game_reveal_step(game, -1);
+}
+
+// De seeds die nog op de worklist van de lopende cascade staan (het front van de golf), bv. om te tekenen of te journalen.
+const RevealSeed *game_reveal_frontier(const Game *game, size_t *out_count)
+{
+    if (game->sparse)
+    {
+        *out_count = game->sparse->seed_count;
+        return game->sparse->seeds;
+    }
+    *out_count = game->reveal.count;
+    return game->reveal.seeds;
+}
+
+/*
+ * Linker muisknop klik: uncover de cell op (x, y).
+ * Bij de eerste klik plaatsen we eerst de mijnen (exclusief de aangeklikte cell).
+ * De functie geeft terug of het speelveld veranderd is.
+ */
+bool game_reveal(Game *game, int x, int y)
+{
+    Board *b = &game->board;
+    if (game->status != GAME_PLAYING || !map_in_bounds(b, x, y))
+        return false;
+
+    bool changed = false;
+    if (!game->mines_placed)
+    {
+        // De speler klikt hier als eerste: ligt er een mijn, dan wordt die verplaatst (zie relocate_mine).
+        // Op een speelveld van -z wordt de aangeklikte cell meteen uitgesloten bij het plaatsen.
+        if (game->sparse)
+            place_sparse_mines(game, x, y);
+        else if (!game->no_guess || !place_no_guess_mines(game, x, y))
+        {
+            place_mines(game);
+            relocate_mine(game, x, y);
+        }
+        changed = true;
+    }
+
+    Cell c = game_cell(game, x, y);
+    if (cell_is_mine(c))
+    {
+        /*
+         * De speler klikte op een mijn -> game over
+         * Maar niet als show_mines actief is.
+         */
+        if (!game->show_mines)
+        {
+            game->status = GAME_LOST;
+            game->losing_col = x;
+            game->losing_row = y;
+            // Een lopende cascade wordt niet meer afgewerkt (game_reveal_step gooit ze weg zodra het spel gedaan is).
+            game_reveal_step(game, 0);
+            // toon alle mijnen (ook de mijn waarop geklikt werd); op een speelveld van -z met 1 vlag in plaats van per mijn
+            size_t cells = map_cell_count(b);
+            if (game->sparse)
+                game->sparse->mines_uncovered = true;
+            for (size_t i = 0; i < cells && !game->sparse; ++i)
+            {
+                if (cell_is_mine(b->cells[i]))
+                    b->cells[i] |= CELL_UNCOVERED;
+            }
+            dirty_mark_all(&game->dirty);
+            CHECK_COUNTERS(game);
+            return true;
+        }
+    }
+    else if (cell_neighbour_mines(c) == 0)
+    {
+        /*
+         * Wanneer een nul-cell wordt aangeklikt, worden de naburige cellen via de reveal engine automatisch ontdekt.
+         * De span van de aangeklikte cell wordt meteen uncovered; met game->progressive volgt de rest via game_reveal_step.
+         */
+        long long uncovered = game->sparse ? sparse_cascade_begin(game->sparse, x, y, &game->dirty)
+                                           : reveal_begin(&game->reveal, b, x, y, &game->dirty);
+        game->uncovered_safe += uncovered;
+        if (!game->progressive)
+            game_reveal_finish(game);
+        changed |= uncovered > 0;
+    }
+    else if (!cell_has(c, CELL_UNCOVERED))
+    {
+        // uncover een "normale nummer cell"
+        uncover_cell(game, x, y);
+        changed = true;
+    }
+
+    changed |= check_win(game);
+    CHECK_COUNTERS(game);
+    return changed;
+}
+
+/*
+ * Rechter muisknop: toggle een vlag op de cell (x, y).
+ * Maar alleen als we niet al het maximale aantal vlaggen hebben geplaatst (dan geven we FLAG_LIMIT_REACHED terug).
+ * Wanneer alle mijnen correct gevlagd zijn, heeft de speler gewonnen.
+ */
+int game_toggle_flag(Game *game, int x, int y)
+{
+    Board *b = &game->board;
+    if (game->status != GAME_PLAYING || !map_in_bounds(b, x, y))
+        return FLAG_UNCHANGED;
+
+    // De cascade moet klaar zijn: een seed die nog op de worklist staat en nu gevlagd wordt, zou ze anders overslaan
+    // (terwijl ze als bezocht gemarkeerd blijft), en een synchrone replay van het journal zou er wel doorheen lopen.
+    game_reveal_finish(game);
+    if (game->status != GAME_PLAYING)
+        return FLAG_UNCHANGED;
+
+    // Zorg ervoor dat de map gegenereerd wordt, voordat we vlaggen kunnen plaatsen.
+    game_ensure_mines(game);
+
+    bool currently_flagged = cell_has(game_cell(game, x, y), CELL_FLAGGED);
+
+    // Als we een vlag willen plaatsen en al het maximale aantal vlaggen bereikt hebben, wordt de actie genegeerd.
+    int result = FLAG_CHANGED;
+    if (!currently_flagged && game->flags_placed >= b->mines)
+        result = FLAG_LIMIT_REACHED;
+    else
+        set_flag(game, x, y, !currently_flagged);
+
+    // Als het aantal vlaggen gelijk is aan het aantal mijnen en alle mijnen correct geflagd zijn -> win
+    if (game->correct_flags == b->mines && game->flags_placed == b->mines)
+        game->status = GAME_WON;
+    CHECK_COUNTERS(game);
+    return result;
+}
+
+/*
+ * Tijdelijk uncover alles via 'p' key.
+ * De vorige uncovered state wordt opgeslagen in de CELL_SAVED_UNCOVERED bit en terug gezet bij de volgende toggle.
+ */
+void game_toggle_show_all(Game *game)
+{
+    // Op een speelveld van -z zou dit elke cell uncoveren (en onthouden); dat doen we niet.
+    if (game->sparse)
+        return;
+    // De cascade moet klaar zijn: die zou anders de tijdelijk uncovered cellen als grens zien.
+    game_reveal_finish(game);
+    Board *b = &game->board;
+    size_t cells = map_cell_count(b);
+    game->show_all = !game->show_all;
+    if (game->show_all)
+    {
+        // Voor de eerste muisklik, zijn er nog geen mijnen geplaatst.
+        // Voordat we alles uncoveren, moeten we dus eerst de mijnen plaatsen.
+        game_ensure_mines(game);
+        for (size_t i = 0; i < cells; ++i)
+        {
+            // sla tijdelijk vorige uncovered state op en uncover alles tijdelijk
+            cell_set(&b->cells[i], CELL_SAVED_UNCOVERED, cell_has(b->cells[i], CELL_UNCOVERED));
+            b->cells[i] |= CELL_UNCOVERED;
+        }
+        game->uncovered_safe = safe_cell_count(game);
+    }
+    else
+    {
+        // terugzetten van vorige uncovered state, en de teller opnieuw opbouwen in dezelfde lus
+        long long uncovered_safe = 0;
+        for (size_t i = 0; i < cells; ++i)
+        {
+            bool uncovered = cell_has(b->cells[i], CELL_SAVED_UNCOVERED);
+            cell_set(&b->cells[i], CELL_UNCOVERED, uncovered);
+            if (uncovered && !cell_is_mine(b->cells[i]))
+                uncovered_safe++;
+        }
+        game->uncovered_safe = uncovered_safe;
+    }
+    dirty_mark_all(&game->dirty);
+    CHECK_COUNTERS(game);
+}
+
+// Toon alle mijnen via 'b' key. Zorg ervoor dat de map gegenereerd wordt, voordat we de mijnen kunnen tonen.
+void game_toggle_show_mines(Game *game)
+{
+    game_ensure_mines(game);
+    game->show_mines = !game->show_mines;
+    dirty_mark_all(&game->dirty);
+}
+
+/*
+ * Bij elke interactie, wordt het speeldveld in de console geprint.
+ * Zie HOC Slides 4_input_output dia 10 voor putchar.
+ */
+void game_print_view(const Game *game)
+{
+    const Board *b = &game->board;
+    // Een speelveld van -z is te groot om te printen: we printen enkel de stand.
+    if (game->sparse)
+    {
+        printf("%dx%d: %lld/%lld cells uncovered, %lld flags (%zu bytes)\n\n", b->width, b->height, game->uncovered_safe,
+               safe_cell_count(game), game->flags_placed, sparse_memory(game->sparse));
+        return;
+    }
+    for (int y = 0; y < b->height; ++y)
+    {
+        for (int x = 0; x < b->width; ++x)
+        {
+            Cell c = MAP_CELL(b, x, y);
+            if (cell_has(c, CELL_UNCOVERED))
+            {
+                if (cell_is_mine(c))
+                    putchar('M');
+                else
+                    putchar('0' + cell_neighbour_mines(c));
+            }
+            else if (cell_has(c, CELL_FLAGGED))
+            {
+                putchar('F');
+            }
+            else if (game->show_mines && cell_is_mine(c))
+            {
+                putchar('M');
+            }
+            else
+            {
+                putchar('#');
+            }
+            putchar(' ');
+        }
+        putchar('\n');
+    }
+    putchar('\n');
+}
+
+/*
+ * Sla het huidige speelveld op in een genummerd bestand met naam: field_<width>x<height>_<n>.txt (of .msb voor het binaire formaat)
+ * De gekozen bestandsnaam wordt teruggegeven via out_filename. Dit gebeurt synchroon; de GUI gebruikt een SaveJob op de achtergrond.
+ */
+int game_save(const Game *game, char *out_filename, size_t size)
+{
+    const Board *b = &game->board;
+    // Een speelveld van -z heeft geen cellen om weg te schrijven.
+    if (game->sparse)
+        return -1;
+    // De bestandsnaam wordt gekozen met 1 scan van de huidige map (zie save_next_filename).
+    if (save_next_filename(b->width, b->height, game->save_format, out_filename, size) != 0)
+        return -1;
+    // Beide formaten worden rechtstreeks uit de gepackte cellen geschreven.
+    if (game->save_format == SAVE_BINARY)
+        return save_field_binary(out_filename, b, game->seed, game->durable_save);
+    return save_field(out_filename, b, game->durable_save);
+}
+
+/*
+ * We laden met de game_load functie een spelbestand in.
+ * Een spelbestand bestaat uit:
+ * - de state van een actief gespeelde map
+ * - de uncovered map (oplossing)
+ * Verder betekenen de volgende gebruikte letters in het bestand:
+ * - U: uncovered
+ * - F: flagged
+ * - M: mine
+ * - #: covered
+ */
+Game *game_load(const char *filename)
+{
+    Game *game = game_alloc();
+    if (!game)
+        return NULL;
+    // Een journal wordt vanaf zijn momentopname opnieuw afgespeeld tot de laatste zet (zie journal_replay).
+    if (journal_detect(filename))
+    {
+        if (journal_replay(game, filename) != 0)
+        {
+            game_free(game);
+            return NULL;
+        }
+        return game;
+    }
+    // Het speelveld en de toestanden worden in 1 doorloop uit het gemapte bestand ingelezen (zie load_field), tekst of binair.
+    if (load_field(filename, &game->board, &game->seed) != 0)
+    {
+        game_free(game);
+        return NULL;
+    }
+    // De mijnen zijn nu geplaatst; de tellers volgen uit de ingelezen toestanden.
+    game->mines_placed = true;
+    game_recount(game);
+    CHECK_COUNTERS(game);
+    return game;
+}
@@ -0,0 +1,93 @@
+#ifndef MINESWEEPER_GAME_H
+#define MINESWEEPER_GAME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "map.h"
+#include "reveal.h"
+#include "dirty.h"
+#include "sparse.h"
+
+/*
+ * De headless game core: alle spelregels (uncoveren, flood fill, vlaggen, win/verlies detectie en het
+ * uitgestelde plaatsen van de mijnen) zitten hier, zonder enige afhankelijkheid van SDL.
+ * De GUI is een client van deze API, maar een spel kan ook volledig zonder venster gespeeld worden.
+ */
+
+// De mogelijke toestanden van een spel.
+typedef enum
+{
+    GAME_PLAYING,
+    GAME_WON,
+    GAME_LOST
+} GameStatus;
+
+// Het formaat waarin game_save het speelveld wegschrijft (te kiezen via -b).
+typedef enum
+{
+    SAVE_TEXT,
+    SAVE_BINARY
+} SaveFormat;
+
+// Het resultaat van game_toggle_flag.
+#define FLAG_UNCHANGED 0
+#define FLAG_CHANGED 1
+#define FLAG_LIMIT_REACHED -1
+
+typedef struct
+{
+    Board board;
+    bool mines_placed; // of de mijnen reeds geplaatst zijn via add_mines
+    bool show_mines;   // via 'b' key: een mijn aanklikken doet niet verliezen
+    bool show_all;     // via 'p' key: alles is tijdelijk uncovered
+    GameStatus status;
+    int losing_col, losing_row; // de mijn waarop geklikt werd bij verlies
+    RevealEngine reveal;        // de (herbruikbare) worklist en visited bitset voor de cascade bij een nul-cell
+    DirtyList dirty;            // de cellen die veranderd zijn sinds de GUI ze laatst getekend heeft
+    SaveFormat save_format;     // het formaat voor game_save
+    bool durable_save;          // game_save schrijft via een tijdelijk bestand met fsync en rename (via -d)
+    uint64_t seed;              // de seed waarmee de mijnen geplaatst worden (via -s), wordt mee opgeslagen in het binaire formaat
+    int threads;                // het aantal threads voor het genereren van het speelveld (via -j, 0 = 1 per core)
+    Board pregenerated;         // het op voorhand gegenereerde speelveld (cells == NULL als er geen is), zie game_pregenerate
+    bool no_guess;              // de eerste klik genereert een speelveld dat zonder gokken op te lossen is (via -g, zie noguess.h)
+    long generation_attempts;   // het aantal kandidaten voor het no-guess speelveld (0 = niet gevraagd, -1 = niet gevonden)
+    SparseBoard *sparse;        // het speelveld van -z (zie sparse.h), of NULL; board.cells is dan NULL en board bevat enkel de dimensies
+    bool progressive;           // game_reveal start een cascade enkel; de rest volgt in stukken via game_reveal_step (zie de GUI)
+
+    /*
+     * Lopende tellers, bijgewerkt bij elke toestandsverandering van een cell.
+     * Zo is de win-detectie constant in tijd, in plaats van een volledige scan van het speelveld per klik.
+     * Met -DMINESWEEPER_DEBUG worden ze na elke actie vergeleken met een volledige scan.
+     */
+    long long uncovered_safe; // aantal uncovered cellen die geen mijn zijn (een speelveld van -z kan meer dan 2^31 cellen hebben)
+    long long flags_placed;   // aantal geplaatste vlaggen
+    long long correct_flags;  // aantal vlaggen die op een mijn staan
+} Game;
+
+// De cell (x, y) van het spel, zowel voor een gewoon speelveld als voor een speelveld van -z.
+static inline Cell game_cell(const Game *game, int x, int y)
+{
+    return game->sparse ? sparse_cell(game->sparse, x, y) : MAP_CELL(&game->board, x, y);
+}
+
+Game *game_new(int w, int h, int mines);
+Game *game_new_sparse(int w, int h, int mines);
+Game *game_load(const char *filename);
+void game_free(Game *game);
+void game_reset(Game *game, uint64_t seed);
+void game_ensure_mines(Game *game);
+int game_pregenerate(Game *game);
+bool game_reveal(Game *game, int x, int y);
+bool game_reveal_pending(const Game *game);
+long long game_reveal_step(Game *game, long budget);
+void game_reveal_finish(Game *game);
+const RevealSeed *game_reveal_frontier(const Game *game, size_t *out_count);
+int game_toggle_flag(Game *game, int x, int y);
+GameStatus game_status(const Game *game);
+void game_recount(Game *game);
+void game_toggle_show_all(Game *game);
+void game_toggle_show_mines(Game *game);
+int game_save(const Game *game, char *out_filename, size_t size);
+void game_print_view(const Game *game);
+
+#endif // MINESWEEPER_GAME_H
@@ -0,0 +1,301 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include "journal.h"
+#include "files.h"
+
+bool journal_is_open(const Journal *journal)
+{
+    return journal->file != NULL;
+}
+
+// Kijkt aan de magic of het bestand een journal is (en geen tekst- of binair speelveld).
+bool journal_detect(const char *filename)
+{
+    FILE *in = fopen(filename, "rb");
+    if (!in)
+        return false;
+    char magic[4];
+    bool detected = fread(magic, 1, sizeof(magic), in) == sizeof(magic) && memcmp(magic, JOURNAL_MAGIC, 4) == 0;
+    fclose(in);
+    return detected;
+}
+
+// Schrijft een record achteraan in de buffer (zonder het bestand aan te raken).
+static void buffer_record(Journal *journal, JournalRecordType type, int x, int y)
+{
+    uint8_t *p = journal->buffer + (size_t)journal->pending * JOURNAL_RECORD_SIZE;
+    memset(p, 0, JOURNAL_RECORD_SIZE);
+    p[0] = (uint8_t)type;
+    put_u32(p + 4, (uint32_t)x);
+    put_u32(p + 8, (uint32_t)y);
+    journal->pending++;
+}
+
+/*
+ * Herschrijft het journal als 1 momentopname van het huidige spel, zonder records.
+ * Dit gebeurt via write_file met een tijdelijk bestand en een atomaire rename: na een crash bestaat ofwel het oude journal,
+ * ofwel het nieuwe. Records die nog in de buffer zitten zijn vervat in de momentopname en vervallen.
+ * Kost O(speelveld), maar gebeurt pas als de records samen groter zijn dan de momentopname (zie journal_flush).
+ * Is er nog een cascade bezig (zie game_reveal_step), dan volgen de seeds op de worklist als reveal records:
+ * bij het afspelen maken die de cascade af, met hetzelfde resultaat.
+ */
+int journal_compact(Journal *journal, const Game *game)
+{
+    const Board *b = &game->board;
+    // Terwijl show_all actief is, staat de echte uncovered toestand in CELL_SAVED_UNCOVERED.
+    Cell uncovered_bit = game->show_all ? CELL_SAVED_UNCOVERED : CELL_UNCOVERED;
+    size_t snapshot_size = 0;
+    uint8_t *snapshot = NULL;
+    if (game->mines_placed)
+    {
+        snapshot = encode_field_binary(b, game->seed, uncovered_bit, &snapshot_size);
+        if (!snapshot)
+            return -1;
+    }
+
+    // De seeds van een lopende cascade, behalve de cellen die intussen gevlagd zijn (die slaat de cascade ook over).
+    size_t frontier_count = 0, seeds = 0;
+    const RevealSeed *frontier = game_reveal_frontier(game, &frontier_count);
+    for (size_t i = 0; i < frontier_count; ++i)
+        seeds += !cell_has(game_cell(game, frontier[i].x, frontier[i].y), CELL_FLAGGED);
+
+    // De tijdelijke toggles zitten niet in de momentopname; die volgen als records (na de cascade, die show_all niet verdraagt).
+    size_t toggles = (size_t)game->show_all + (size_t)game->show_mines;
+    size_t size = JOURNAL_HEADER_SIZE + snapshot_size + (seeds + toggles) * JOURNAL_RECORD_SIZE;
+    uint8_t *buf = (uint8_t *)calloc(size, 1);
+    if (!buf)
+    {
+        free(snapshot);
+        return -1;
+    }
+    memcpy(buf, JOURNAL_MAGIC, 4);
+    put_u16(buf + 4, JOURNAL_VERSION);
+    put_u16(buf + 6, game->mines_placed ? JOURNAL_FLAG_MINES : 0);
+    put_u32(buf + 8, (uint32_t)b->width);
+    put_u32(buf + 12, (uint32_t)b->height);
+    put_u32(buf + 16, (uint32_t)b->mines);
+    put_u32(buf + 20, 0);
+    put_u64(buf + 24, snapshot_size);
+    if (snapshot)
+        memcpy(buf + JOURNAL_HEADER_SIZE, snapshot, snapshot_size);
+    free(snapshot);
+    uint8_t *record = buf + JOURNAL_HEADER_SIZE + snapshot_size;
+    for (size_t i = 0; i < frontier_count; ++i)
+    {
+        if (cell_has(game_cell(game, frontier[i].x, frontier[i].y), CELL_FLAGGED))
+            continue;
+        record[0] = JOURNAL_REVEAL;
+        put_u32(record + 4, (uint32_t)frontier[i].x);
+        put_u32(record + 8, (uint32_t)frontier[i].y);
+        record += JOURNAL_RECORD_SIZE;
+    }
+    if (game->show_all)
+    {
+        record[0] = JOURNAL_SHOW_ALL;
+        record += JOURNAL_RECORD_SIZE;
+    }
+    if (game->show_mines)
+        record[0] = JOURNAL_SHOW_MINES;
+
+    // Het bestand moet dicht zijn voor de rename (op Windows kan een geopend bestand niet vervangen worden).
+    if (journal->file)
+    {
+        fclose(journal->file);
+        journal->file = NULL;
+    }
+    int result = write_file(journal->filename, buf, size, true);
+    free(buf);
+    if (result == 0)
+    {
+        journal->has_mines = game->mines_placed;
+        journal->snapshot_size = snapshot_size;
+        journal->record_bytes = (seeds + toggles) * JOURNAL_RECORD_SIZE;
+        journal->pending = 0;
+    }
+    // Bij een fout blijven het oude journal en de gebufferde records gewoon geldig.
+    journal->file = fopen(journal->filename, "ab");
+    if (!journal->file)
+        return -1;
+    return result;
+}
+
+/*
+ * Opent (of maakt) het journal voor het gegeven spel. Het bestand wordt meteen herschreven als momentopname
+ * van het huidige spel, zodat een journal dat net afgespeeld werd niet blijft groeien.
+ * Met durable wordt elke flush ook naar de schijf geflusht.
+ */
+int journal_open(Journal *journal, const char *filename, const Game *game, bool durable)
+{
+    memset(journal, 0, sizeof(*journal));
+    if (snprintf(journal->filename, sizeof(journal->filename), "%s", filename) >= (int)sizeof(journal->filename))
+        return -1;
+    journal->durable = durable;
+    if (journal_compact(journal, game) != 0)
+    {
+        journal_close(journal, NULL);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Voegt 1 zet toe aan het journal, na het uitvoeren ervan op het spel. Het record komt enkel in de buffer;
+ * een volle buffer wordt weggeschreven. Als deze zet de mijnen geplaatst heeft, kan de zet niet opnieuw afgespeeld
+ * worden (de mijnen zijn willekeurig), dus compacteren we meteen tot een momentopname met de mijnen.
+ */
+int journal_record(Journal *journal, const Game *game, JournalRecordType type, int x, int y)
+{
+    if (!journal->file)
+        return -1;
+    if (game->mines_placed && !journal->has_mines)
+        return journal_compact(journal, game);
+    buffer_record(journal, type, x, y);
+    if (journal->pending == JOURNAL_BUFFER_RECORDS)
+        return journal_flush(journal, game);
+    return 0;
+}
+
+/*
+ * Schrijft de gebufferde records in 1 keer achteraan in het bestand (en met durable ook naar de schijf).
+ * Zijn de records daarna groter dan de momentopname, dan compacteren we: zo blijft het bestand hoogstens
+ * ongeveer 2 keer de grootte van het speelveld, en kost het bewaren van een sessie per zet maar 1 record.
+ */
+int journal_flush(Journal *journal, const Game *game)
+{
+    if (!journal->file)
+        return -1;
+    if (journal->pending == 0)
+        return 0;
+    size_t size = (size_t)journal->pending * JOURNAL_RECORD_SIZE;
+    bool ok = fwrite(journal->buffer, 1, size, journal->file) == size && fflush(journal->file) == 0;
+    if (ok && journal->durable)
+    {
+#ifdef _WIN32
+        ok = _commit(_fileno(journal->file)) == 0;
+#else
+        ok = fsync(fileno(journal->file)) == 0;
+#endif
+    }
+    if (!ok)
+        return -1;
+    journal->pending = 0;
+    journal->record_bytes += size;
+    if (journal->record_bytes > journal->snapshot_size && journal->record_bytes >= JOURNAL_MIN_COMPACT_SIZE)
+        return journal_compact(journal, game);
+    return 0;
+}
+
+// Schrijft de laatste records weg (als game niet NULL is) en sluit het journal.
+void journal_close(Journal *journal, const Game *game)
+{
+    if (journal->file && game)
+        journal_flush(journal, game);
+    if (journal->file)
+        fclose(journal->file);
+    journal->file = NULL;
+}
+
+/*
+ * Speelt een journal af in het (lege) spel game: eerst wordt de momentopname ingelezen, daarna worden de records
+ * in volgorde uitgevoerd via dezelfde functies als de GUI. Het bestand wordt gemapt en in 1 doorloop afgespeeld.
+ * Een onvolledig laatste record (bv. na een crash tijdens het schrijven) wordt genegeerd.
+ */
+int journal_replay(Game *game, const char *filename)
+{
+    MappedFile f;
+    if (map_file(filename, &f) != 0)
+    {
+        fprintf(stderr, "%s: cannot open file or file is empty\n", filename);
+        return -1;
+    }
+    const uint8_t *data = (const uint8_t *)f.data;
+    const char *error = NULL;
+    uint64_t snapshot_size = 0;
+    if (f.size < JOURNAL_HEADER_SIZE || memcmp(data, JOURNAL_MAGIC, 4) != 0)
+        error = "truncated journal header";
+    else if (get_u16(data + 4) != JOURNAL_VERSION)
+        error = "unsupported journal version";
+    else if (get_u16(data + 6) & ~JOURNAL_FLAG_MINES)
+        error = "unknown journal flags";
+    else if ((snapshot_size = get_u64(data + 24)) > f.size - JOURNAL_HEADER_SIZE)
+        error = "truncated snapshot";
+    if (error)
+    {
+        fprintf(stderr, "%s: %s\n", filename, error);
+        unmap_file(&f);
+        return -1;
+    }
+
+    uint32_t w = get_u32(data + 8), h = get_u32(data + 12), mines = get_u32(data + 16);
+    if (get_u16(data + 6) & JOURNAL_FLAG_MINES)
+    {
+        if (parse_field_binary(filename, data + JOURNAL_HEADER_SIZE, (size_t)snapshot_size, &game->board, &game->seed) != 0)
+        {
+            unmap_file(&f);
+            return -1;
+        }
+        if ((uint32_t)game->board.width != w || (uint32_t)game->board.height != h)
+            error = "snapshot dimensions do not match the header";
+        game->mines_placed = true;
+    }
+    // Zonder mijnen is het speelveld nog leeg (zoals bij game_new).
+    else if (w == 0 || h == 0 || w > INT_MAX || h > INT_MAX || (uint64_t)mines > (uint64_t)w * h ||
+             init_map(&game->board, (int)w, (int)h, (int)mines) != 0)
+        error = "invalid dimensions";
+    if (error)
+    {
+        fprintf(stderr, "%s: %s\n", filename, error);
+        unmap_file(&f);
+        return -1;
+    }
+    game_recount(game);
+
+    // Zonder momentopname met mijnen kunnen er geen zetten zijn: de mijnen zouden bij het afspelen anders liggen.
+    size_t pos = JOURNAL_HEADER_SIZE + (size_t)snapshot_size, records = 0;
+    if (!game->mines_placed && f.size - pos >= JOURNAL_RECORD_SIZE)
+    {
+        fprintf(stderr, "%s: journal has moves but no snapshot of the mines\n", filename);
+        unmap_file(&f);
+        return -1;
+    }
+    for (; f.size - pos >= JOURNAL_RECORD_SIZE; pos += JOURNAL_RECORD_SIZE, ++records)
+    {
+        const uint8_t *record = data + pos;
+        int x = (int)get_u32(record + 4), y = (int)get_u32(record + 8);
+        switch (record[0])
+        {
+        case JOURNAL_REVEAL:
+            game_reveal(game, x, y);
+            break;
+        case JOURNAL_FLAG:
+            game_toggle_flag(game, x, y);
+            break;
+        case JOURNAL_SHOW_ALL:
+            game_toggle_show_all(game);
+            break;
+        case JOURNAL_SHOW_MINES:
+            game_toggle_show_mines(game);
+            break;
+        default:
+            fprintf(stderr, "%s:%zu: unknown record type %u\n", filename, pos, record[0]);
+            unmap_file(&f);
+            return -1;
+        }
+    }
+    if (pos != f.size)
+        fprintf(stderr, "%s: ignoring a truncated record at the end of the journal\n", filename);
+    unmap_file(&f);
+
+    // Het volledige speelveld wordt bij de eerste frame getekend; de spans van het afspelen zijn overbodig.
+    dirty_clear(&game->dirty);
+    dirty_mark_all(&game->dirty);
+    printf("Replayed %zu moves from %s\n", records, filename);
+    return 0;
+}
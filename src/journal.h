@@ -0,0 +1,64 @@
+#ifndef MINESWEEPER_JOURNAL_H
+#define MINESWEEPER_JOURNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "game.h"
+
+/*
+ * Het journal: een bestand waarin elke zet van de speler als een klein record van vaste grootte achteraan
+ * wordt toegevoegd, zodat een lange sessie bewaard blijft zonder telkens het volledige speelveld weg te schrijven.
+ * Het formaat (versie 1, alles little-endian):
+ * - een header van 32 bytes: magic "MSWJ", versie (u16), flags (u16), breedte, hoogte en aantal mijnen (u32),
+ *   4 gereserveerde bytes en de grootte van de momentopname (u64)
+ * - met JOURNAL_FLAG_MINES: een momentopname van het speelveld in het binaire formaat (zie files.h);
+ *   zonder zijn de mijnen nog niet geplaatst en is het speelveld leeg
+ * - de records: elk JOURNAL_RECORD_SIZE bytes (type (u8), 3 bytes opvulling, x en y (u32))
+ * De records worden per batch weggeschreven (journal_flush); als ze samen groter worden dan de momentopname,
+ * wordt het journal gecompacteerd tot 1 nieuwe momentopname zonder records (journal_compact).
+ */
+#define JOURNAL_MAGIC "MSWJ"
+#define JOURNAL_VERSION 1
+#define JOURNAL_HEADER_SIZE 32
+#define JOURNAL_RECORD_SIZE 12
+#define JOURNAL_FLAG_MINES 0x0001
+
+// Het aantal records dat in het geheugen gebufferd wordt vooraleer ze naar het bestand geschreven worden.
+#define JOURNAL_BUFFER_RECORDS 256
+
+// De records zijn nooit groter dan dit aantal bytes zonder compactie, ook als de momentopname kleiner is.
+#define JOURNAL_MIN_COMPACT_SIZE (64 * 1024)
+
+// De soorten zetten in het journal.
+typedef enum
+{
+    JOURNAL_REVEAL = 1,
+    JOURNAL_FLAG = 2,
+    JOURNAL_SHOW_ALL = 3,
+    JOURNAL_SHOW_MINES = 4
+} JournalRecordType;
+
+typedef struct
+{
+    FILE *file; // het bestand, geopend om records achteraan toe te voegen
+    char filename[256];
+    bool durable;          // elke flush wordt ook naar de schijf geflusht (fsync)
+    bool has_mines;        // of de momentopname in het bestand de mijnen bevat
+    size_t snapshot_size;  // de grootte van de momentopname in het bestand
+    size_t record_bytes;   // de grootte van de records na de momentopname in het bestand
+    int pending;           // het aantal records in buffer dat nog niet weggeschreven is
+    uint8_t buffer[JOURNAL_BUFFER_RECORDS * JOURNAL_RECORD_SIZE];
+} Journal;
+
+int journal_open(Journal *journal, const char *filename, const Game *game, bool durable);
+int journal_record(Journal *journal, const Game *game, JournalRecordType type, int x, int y);
+int journal_flush(Journal *journal, const Game *game);
+int journal_compact(Journal *journal, const Game *game);
+void journal_close(Journal *journal, const Game *game);
+bool journal_is_open(const Journal *journal);
+bool journal_detect(const char *filename);
+int journal_replay(Game *game, const char *filename);
+
+#endif // MINESWEEPER_JOURNAL_H
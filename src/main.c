@@ -1,7 +1,101 @@
+#include <stdbool.h>
 #include <stdio.h>
 #include "GUI.h"
 #include "args.h"
-#include "map.h"
+#include "game.h"
+#include "journal.h"
+#include "simulate.h"
+#include "rng.h"
+#include "world.h"
+
+/*
+ * Simuleert args->games spellen met de configuratie van -w/-h/-m (of de standaard), de seed van -s en de threads van -j.
+ * Zonder -s kiezen we een willekeurige seed en printen we die, zodat de simulatie herhaald kan worden.
+ */
+static int run_simulation(const Args *args)
+{
+    SimulationConfig config;
+    bool custom = args->w > 0 && args->h > 0 && args->m > 0;
+    config.width = custom ? args->w : DEFAULT_MAP_WIDTH;
+    config.height = custom ? args->h : DEFAULT_MAP_HEIGHT;
+    config.mines = custom ? args->m : DEFAULT_MAP_MINES;
+    config.games = args->games;
+    config.seed = args->has_seed ? (uint64_t)args->seed : rng_random_seed();
+    config.threads = args->threads;
+    config.no_guess = args->no_guess != 0;
+
+    SimulationResult result;
+    if (simulate(&config, &result) != 0)
+    {
+        fprintf(stderr, "Failed to run the simulation\n");
+        return 1;
+    }
+    printf("Simulated %ld games of %dx%d with %d mines on %d threads (seed %llu)\n", result.games, config.width,
+           config.height, config.mines, result.threads, (unsigned long long)config.seed);
+    printf("Win rate: %.2f%% (%ld/%ld), %.2f guesses per game\n", 100.0 * (double)result.wins / (double)result.games,
+           result.wins, result.games, (double)result.guesses / (double)result.games);
+    printf("Throughput: %.1f games/sec\n", result.seconds > 0 ? (double)result.games / result.seconds : 0.0);
+    printf("Time per game: p50 %.3f ms, p99 %.3f ms\n", result.p50, result.p99);
+    printf("First click: %.3f ms on average\n", result.first_click_ms);
+    if (config.no_guess)
+    {
+        long found = result.games - result.fallbacks;
+        printf("No-guess boards: %.2f attempts per board (%ld not found)\n",
+               found > 0 ? (double)result.attempts / (double)found : 0.0, result.fallbacks);
+    }
+    return 0;
+}
+
+/*
+ * Speelt in de oneindige wereld in de map args->world (zie world.h). Een bestaande wereld wordt verder gespeeld.
+ * Met -w/-h/-m kiezen we de dichtheid van de mijnen (omgerekend naar een chunk, en begrensd), anders de standaard.
+ * Bij het afsluiten wordt de wereld opgeslagen.
+ */
+static int run_world(const Args *args)
+{
+    int chunk_mines = WORLD_DEFAULT_CHUNK_MINES;
+    if (args->w > 0 && args->h > 0 && args->m > 0)
+    {
+        long long cells = (long long)args->w * args->h;
+        chunk_mines = (int)(((long long)args->m * WORLD_CHUNK_CELLS + cells / 2) / cells);
+        if (chunk_mines < WORLD_MIN_CHUNK_MINES || chunk_mines > WORLD_MAX_CHUNK_MINES)
+        {
+            chunk_mines = chunk_mines < WORLD_MIN_CHUNK_MINES ? WORLD_MIN_CHUNK_MINES : WORLD_MAX_CHUNK_MINES;
+            printf("Mine density adjusted to %d mines per %dx%d chunk\n", chunk_mines, WORLD_CHUNK_SIZE, WORLD_CHUNK_SIZE);
+        }
+    }
+    uint64_t seed = args->has_seed ? (uint64_t)args->seed : rng_random_seed();
+
+    World world;
+    bool resumed = false;
+    if (world_open(&world, args->world, seed, chunk_mines, WORLD_DEFAULT_MAX_CHUNKS, &resumed) != 0)
+    {
+        fprintf(stderr, "Failed to open world %s\n", args->world);
+        return 1;
+    }
+    world.durable = args->durable != 0;
+    if (resumed)
+        printf("Resumed world %s (seed %llu, score %llu)\n", args->world, (unsigned long long)world.seed,
+               (unsigned long long)world.uncovered);
+    else
+        printf("Seed: %llu\n", (unsigned long long)world.seed);
+
+    initialize_world_gui(&world, WINDOW_WIDTH, WINDOW_HEIGHT, args->fps >= 0 ? args->fps : DEFAULT_MAX_FPS, args->vsync != 0);
+    while (should_continue)
+    {
+        draw_window();
+        read_input();
+    }
+    free_gui();
+    int result = 0;
+    if (world_save(&world) != 0)
+    {
+        fprintf(stderr, "Error saving world to %s\n", args->world);
+        result = 1;
+    }
+    world_close(&world);
+    return result;
+}
 
 // Beginfunctie van de gehele applicatie. Hierin worden alle andere functies aangeroepen.
 int main(int argc, char *argv[])
@@ -9,19 +103,28 @@ int main(int argc, char *argv[])
     /*
      * Args: we instantiëren de args variabele om daarna te kunnen gebruiken in de functie en daar buiten.
      * We parsen de CLI argumenten met de parse_args functie en printen een eventuele error.
-     * Zie HOC Slides 4_input_output dia 29 voor perror.
      */
     Args args;
     if (parse_args(argc, argv, &args) != 0)
         return 1;
 
+    // Met -n spelen we zonder venster een reeks spellen en rapporteren we de statistieken.
+    if (args.games > 0)
+        return run_simulation(&args);
+
+    // Met -e spelen we in een oneindige wereld in plaats van op een speelveld.
+    if (args.world)
+        return run_world(&args);
+
     /*
      * We kijken na of er een bestand werd meegegeven via args (dit wordt meegegeven args.file).
-     * Zo ja, dan laden we de map vanuit het bestand in met load_file.
+     * Zo ja, dan laden we het spel vanuit het bestand in met game_load.
      */
+    Game *game = NULL;
     if (args.file)
     {
-        if (load_file(args.file) != 0)
+        game = game_load(args.file);
+        if (!game)
         {
             fprintf(stderr, "Failed to load map from %s\n", args.file);
             return 1;
@@ -30,35 +133,52 @@ int main(int argc, char *argv[])
     /*
      * Als er geen bestand wordt meegegeven, wordt er gekeken of er een breedte, hoogte en aantal mijnen worden meegegeven.
      * Ook wordt er gecheckt of deze waarden geldig zijn (breedte en hoogte groter dan 0, aantal mijnen groter of gelijk aan 0).
-     * Indien van wel, dan creëren we een map met init_map en create_map.
+     * Indien van wel, dan creëren we een nieuw spel met game_new.
      */
     else if (args.w > 0 && args.h > 0 && args.m > 0)
     {
-        if (init_map(args.w, args.h, args.m) != 0)
+        // Met -z wordt het speelveld compact opgeslagen: enkel de mijnen en de uncovered en gevlagde gebieden (zie sparse.h).
+        game = args.sparse ? game_new_sparse(args.w, args.h, args.m) : game_new(args.w, args.h, args.m);
+        if (!game)
         {
             fprintf(stderr, "Failed to initialize map %dx%d\n", args.w, args.h);
             return 1;
         }
-        create_map();
-        // We alloceren de nodige game states met init_states en printen een eventuele error.
-        if (init_states() != 0)
-        {
-            perror("Failed to allocate game states");
-            return 1;
-        }
     }
     // Als er geen bestand of breedte, hoogte of aantal mijnen wordt meegegeven, creëren we een standaard map van 10x10 met 10 mijnen.
     else
     {
-        create_map();
-        // We alloceren de nodige game states met init_states en printen een eventuele error.
-        if (init_states() != 0)
+        game = args.sparse ? game_new_sparse(DEFAULT_MAP_WIDTH, DEFAULT_MAP_HEIGHT, DEFAULT_MAP_MINES)
+                           : game_new(DEFAULT_MAP_WIDTH, DEFAULT_MAP_HEIGHT, DEFAULT_MAP_MINES);
+        if (!game)
         {
-            perror("Failed to allocate game states");
+            fprintf(stderr, "Failed to initialize map %dx%d\n", DEFAULT_MAP_WIDTH, DEFAULT_MAP_HEIGHT);
             return 1;
         }
     }
 
+    /*
+     * Met -s worden de mijnen geplaatst met een vaste seed, zodat hetzelfde speelveld opnieuw gespeeld kan worden.
+     * Zonder -s printen we de willekeurige seed, zodat de speler een speelveld later kan herhalen.
+     */
+    if (!args.file)
+    {
+        if (args.has_seed)
+            game->seed = (uint64_t)args.seed;
+        printf("Seed: %llu\n", (unsigned long long)game->seed);
+    }
+
+    // Met -g genereert de eerste klik een speelveld dat zonder gokken op te lossen is.
+    game->no_guess = args.no_guess != 0;
+
+    // Met -j kiezen we het aantal threads waarmee een groot speelveld gegenereerd wordt (het resultaat is altijd hetzelfde).
+    game->threads = args.threads;
+
+    // Met -b slaat de 's' key het speelveld op in het compacte binaire formaat (game_load herkent beide formaten).
+    game->save_format = args.binary ? SAVE_BINARY : SAVE_TEXT;
+    // Met -d wordt elke save eerst naar een tijdelijk bestand geschreven, naar de schijf geflusht en dan hernoemd.
+    game->durable_save = args.durable != 0;
+
     /*
      * We initialiseren de dimensies van de window en bepalen een geschikte image size.
      * We doen dit door de functie determine_img_win_size aan te roepen.
@@ -66,24 +186,33 @@ int main(int argc, char *argv[])
     int img_size = 0;
     int window_width = WINDOW_WIDTH;
     int window_height = WINDOW_HEIGHT;
-    if (determine_img_win_size(map_width, map_height, &img_size, &window_width, &window_height) != 0)
+    if (determine_img_win_size(game->board.width, game->board.height, &img_size, &window_width, &window_height) != 0)
     {
         // Indien deze functie faalt, gebruiken we de standaardwaarden.
         window_width = WINDOW_WIDTH;
         window_height = WINDOW_HEIGHT;
     }
     /*
-     * Daarna initialiseren we de GUI met de juiste window breedte en hoogte.
+     * Daarna initialiseren we de GUI met het spel, de juiste window breedte en hoogte en de frame pacing opties.
      * De game loop wordt dan gestart, waarin we blijven tekenen en input lezen zolang should_continue waar is.
+     * read_input blokkeert tot er input is of een animatie een nieuwe frame nodig heeft; draw_window tekent enkel als er iets veranderd is.
+     */
+    int max_fps = args.fps >= 0 ? args.fps : DEFAULT_MAX_FPS;
+    /*
+     * Met -a wordt elke zet bijgehouden in een journal, dat met -f opnieuw ingeladen kan worden.
+     * Als we een journal inladen zonder -a, spelen we verder in hetzelfde journal.
      */
-    initialize_gui(window_width, window_height);
+    const char *journal_file = args.journal;
+    if (!journal_file && args.file && journal_detect(args.file))
+        journal_file = args.file;
+    initialize_gui(game, window_width, window_height, max_fps, args.vsync != 0, journal_file);
     while (should_continue)
     {
         draw_window();
         read_input();
     }
-    // We dealloceren al het gebruikte geheugen voor de GUI, de game states en de map.
+    // We dealloceren al het gebruikte geheugen voor de GUI en het spel (met zijn map).
     free_gui();
-    free_map();
+    game_free(game);
     return 0;
 }
@@ -1,156 +1,255 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 #include "map.h"
-
-// We instantieren de standaardwaarden van het speelveld.
-int map_width = 10;
-int map_height = 10;
-int map_mines = 10;
-// We instantieren een speelveld als 2D array van Cell structs.
-Cell **map = NULL;
+#include "bitplane.h"
+#include "rng.h"
+#include "parallel.h"
 
 /*
  * We checken de waarden van w en h of deze mogelijk zijn.
- * Zo ja, dan worden deze toegekend aan map_width en map_height.
- * We alloceren geheugen voor de standaard map van size map_width * map_height.
+ * Zo ja, dan worden deze toegekend aan de breedte en hoogte van het speelveld b.
+ * We alloceren geheugen voor de map van size w * h, als 1 aaneengesloten buffer.
  */
-int init_map(int w, int h, int mines)
+int init_map(Board *b, int w, int h, int mines)
 {
-    if (w <= 0 || h <= 0)
+    if (!b || w <= 0 || h <= 0)
         return -1;
-    map_width = w;
-    map_height = h;
-    map_mines = mines;
-    if (map)
-        free_map();
-
-    // We alloceren geheugen voor de maps (2D array van Cell pointers).
-    map = (Cell **)malloc(h * sizeof(Cell *));
-    if (!map)
+    b->width = w;
+    b->height = h;
+    b->mines = mines;
+
+    // We alloceren geheugen voor alle cellen in 1 blok, zodat een volledige scan lineair door het geheugen loopt.
+    b->cells = (Cell *)calloc((size_t)w * (size_t)h, sizeof(Cell));
+    if (!b->cells)
         return -1;
+    return 0;
+}
 
-    // We alloceren geheugen voor elke rij in de map.
-    for (int i = 0; i < h; i++)
+// De aangemaakte map wordt opgevuld met lege cellen (zonder mijnen).
+void create_map(Board *b)
+{
+    size_t cells = map_cell_count(b);
+    for (size_t i = 0; i < cells; i++)
+        cell_set_value(&b->cells[i], 0);
+}
+
+// We initialiseren alle cell states op false (de waarde van de cell blijft behouden).
+void init_states(Board *b)
+{
+    size_t cells = map_cell_count(b);
+    for (size_t i = 0; i < cells; ++i)
+        b->cells[i] &= CELL_VALUE_MASK;
+}
+
+// Om de map in de console uit te printen.
+void print_map(const Board *b)
+{
+    for (int y = 0; y < b->height; y++)
     {
-        map[i] = (Cell *)malloc(w * sizeof(Cell));
-        if (!map[i])
+        for (int x = 0; x < b->width; x++)
         {
-            // We dealloceren eerder gealloceerde Cells bij een eventuele fout.
-            for (int j = 0; j < i; j++)
-                free(map[j]);
-            free(map);
-            map = NULL;
-            return -1;
+            if (cell_is_mine(MAP_CELL(b, x, y)))
+                printf("M ");
+            else
+                printf("%d ", cell_neighbour_mines(MAP_CELL(b, x, y)));
         }
+        printf("\n");
     }
-    return 0;
 }
 
-// De aangemaakte map wordt opgevuld met Cell structs (zonder mijnen).
-void create_map()
+#ifdef MINESWEEPER_DEBUG
+/*
+ * Referentie-implementatie van fill_map: voor elke cell die geen mijn is, worden de 8 aangrenzende cellen gecontroleerd op mijnen.
+ * In debug builds vergelijken we het resultaat van de bitplane kernel hiermee.
+ */
+static int count_neighbour_mines(const Board *b, int x, int y)
 {
-    if (map == NULL)
-        init_map(map_width, map_height, map_mines);
-    for (int y = 0; y < map_height; y++)
+    int count = 0;
+    for (int ay = -1; ay <= 1; ay++)
     {
-        for (int x = 0; x < map_width; x++)
+        for (int ax = -1; ax <= 1; ax++)
         {
-            map[y][x].is_mine = false;
-            map[y][x].neighbour_mines = 0;
+            if (ax == 0 && ay == 0)
+                continue;
+            int by = y + ay, bx = x + ax;
+            if (map_in_bounds(b, bx, by))
+            {
+                if (cell_is_mine(MAP_CELL(b, bx, by)))
+                    count++;
+            }
         }
     }
+    return count;
 }
 
-// Om de map in de console uit te printen.
-void print_map()
+// Vergelijkt de getallen in alle cellen met de referentie-implementatie.
+static void check_numbers(const Board *b)
 {
-    for (int y = 0; y < map_height; y++)
+    for (int y = 0; y < b->height; y++)
     {
-        for (int x = 0; x < map_width; x++)
+        for (int x = 0; x < b->width; x++)
         {
-            if (map[y][x].is_mine)
-                printf("M ");
-            else
-                printf("%d ", map[y][x].neighbour_mines);
+            Cell c = MAP_CELL(b, x, y);
+            if (!cell_is_mine(c) && cell_neighbour_mines(c) != count_neighbour_mines(b, x, y))
+                fprintf(stderr, "fill_map mismatch at (%d, %d): %d != %d\n", x, y, cell_neighbour_mines(c), count_neighbour_mines(b, x, y));
         }
-        printf("\n");
     }
 }
+#define CHECK_NUMBERS(b) check_numbers(b)
+#else
+#define CHECK_NUMBERS(b) ((void)0)
+#endif
 
 // Deze functie zal de map opvullen met nummers, rekening houdend met de reeds gelegde mijnen.
-void fill_map()
+void fill_map(Board *b)
 {
     /*
-     * We itereren over alle cellen op het speelveld.
-     * Voor elke cell die geen mijn is, worden de 8 aangrenzende cellen gecontroleerd op mijnen.
-     * Als er een mijn is gevonden, wordt de counter van de cell met 1 verhoogd.
+     * We zetten de mijnen eerst om naar een bitplane (1 bit per cell).
+     * Daarna berekent de bitplane kernel voor alle cellen tegelijk het aantal aangrenzende mijnen,
+     * door de 8 verschoven bitplanes bit-slice op te tellen (zonder bounds checks in de binnenste lus).
+     * Het aantal mijnen in de omgeving van een cell wordt opgeslagen in de onderste 4 bits van elke cell.
      */
-    for (int y = 0; y < map_height; y++)
+    Bitplane mines;
+    if (bitplane_init(&mines, b->width, b->height) != 0)
+        return;
+    bitplane_from_mines(&mines, b->cells);
+    bitplane_count_neighbours(&mines, b->cells);
+    bitplane_free(&mines);
+    CHECK_NUMBERS(b);
+}
+
+/*
+ * Het speelveld wordt per band van MAP_BAND_ROWS rijen gegenereerd, elk met een eigen stroom van de RNG.
+ * De banden liggen vast (onafhankelijk van het aantal threads), dus dezelfde seed geeft altijd hetzelfde speelveld.
+ */
+#define MAP_BAND_ROWS 64
+
+// Onder dit aantal cellen kost het starten van threads meer dan het genereren zelf.
+#define MAP_PARALLEL_MIN_CELLS (1 << 20)
+
+typedef struct
+{
+    Board *b;
+    uint64_t seed;
+    size_t excluded;          // de index van de uitgesloten cell (of het aantal cellen als er geen is)
+    const size_t *band_mines; // het aantal mijnen per band
+    Bitplane plane;           // de mijnen als bitplane, voor de getallen
+} MineGenerator;
+
+static void band_rows(const Board *b, int band, int *y0, int *y1)
+{
+    *y0 = band * MAP_BAND_ROWS;
+    *y1 = *y0 + MAP_BAND_ROWS < b->height ? *y0 + MAP_BAND_ROWS : b->height;
+}
+
+/*
+ * Plaatst de mijnen van 1 band met het algoritme van Floyd: voor j van n - k tot n - 1 trekken we t uit [0, j];
+ * is t al een mijn, dan nemen we j zelf. Dat geeft een uniforme keuze van k uit n cellen in precies k trekkingen,
+ * ook bij een dichtheid van 99%. Of een cell al gekozen is, zien we aan de cell zelf.
+ * Daarna zetten we de mijnen van de band in de bitplane.
+ */
+static void place_band(void *context, int band)
+{
+    MineGenerator *gen = (MineGenerator *)context;
+    Board *b = gen->b;
+    int y0, y1;
+    band_rows(b, band, &y0, &y1);
+    size_t first = (size_t)y0 * (size_t)b->width, count = (size_t)(y1 - y0) * (size_t)b->width;
+    Cell *cells = b->cells + first;
+    // De kandidaten zijn alle cellen van de band behalve de uitgesloten cell: indices vanaf excluded schuiven 1 op.
+    bool exclude = gen->excluded >= first && gen->excluded < first + count;
+    size_t excluded = exclude ? gen->excluded - first : count;
+    size_t n = count - (exclude ? 1 : 0);
+
+    Rng rng;
+    rng_seed_stream(&rng, gen->seed, (uint64_t)band + 1);
+    for (size_t j = n - gen->band_mines[band]; j < n; ++j)
     {
-        for (int x = 0; x < map_width; x++)
-        {
-            /*
-             * Het aantal mijnen in de omgeving van een cell wordt opgeslagen in het `neighbour_mines` attribute van elke cell.
-             * Cellen die zelf een mijn zijn, worden overgeslagen
-             */
-            if (map[y][x].is_mine)
-                continue;
-            int count = 0;
-            for (int ay = -1; ay <= 1; ay++)
-            {
-                for (int ax = -1; ax <= 1; ax++)
-                {
-                    if (ax == 0 && ay == 0)
-                        continue;
-                    int by = y + ay, bx = x + ax;
-                    if (by >= 0 && by < map_height && bx >= 0 && bx < map_width)
-                    {
-                        if (map[by][bx].is_mine)
-                            count++;
-                    }
-                }
-            }
-            map[y][x].neighbour_mines = count;
-        }
+        size_t t = (size_t)rng_bounded(&rng, (uint64_t)j + 1);
+        size_t i = t >= excluded ? t + 1 : t;
+        if (cell_is_mine(cells[i]))
+            i = j >= excluded ? j + 1 : j;
+        cell_set_value(&cells[i], CELL_MINE);
     }
+    bitplane_from_mines_rows(&gen->plane, b->cells, y0, y1);
+}
+
+// Berekent de getallen van 1 band; de rijen net boven en onder de band (de halo) worden enkel gelezen.
+static void count_band(void *context, int band)
+{
+    MineGenerator *gen = (MineGenerator *)context;
+    int y0, y1;
+    band_rows(gen->b, band, &y0, &y1);
+    bitplane_count_neighbours_rows(&gen->plane, gen->b->cells, y0, y1);
 }
 
 /*
  * In het begin, na het klikken op de eerste cell, wordt de map aangemaakt en random opgevuld met mijnen.
- * Daarna wordt de fill_map functie aangeroepen om de map verder op te vullen met nummers.
+ * Eerst verdelen we de mijnen over de banden: het aantal in elke band volgt een hypergeometrische verdeling
+ * (getrokken uit de hoofdstroom van de seed), zodat het geheel een uniforme keuze van de mijnen blijft.
+ * Daarna plaatst elke band zijn mijnen met zijn eigen stroom, en worden de getallen per band berekend,
+ * beide verdeeld over threads threads (0 = 1 per core). De cell (exclude_x, exclude_y) wordt overgeslagen.
+ * Met dezelfde seed (en dezelfde uitgesloten cell) krijgen we altijd hetzelfde speelveld, ongeacht het aantal threads.
  */
-void add_mines(int exclude_x, int exclude_y)
+void add_mines(Board *b, uint64_t seed, int threads, int exclude_x, int exclude_y)
 {
-    srand((unsigned int)time(NULL));
-    int placed = 0;
-    while (placed < map_mines)
+    size_t cells = map_cell_count(b);
+    bool exclude = map_in_bounds(b, exclude_x, exclude_y);
+    size_t excluded = exclude ? (size_t)exclude_y * (size_t)b->width + (size_t)exclude_x : cells;
+    size_t n = cells - (exclude ? 1 : 0);
+    // Als er meer mijnen zijn dan vrije cellen (bv. een vol speelveld met een uitgesloten cell), vullen we alle vrije cellen.
+    if ((size_t)b->mines > n)
+        b->mines = (int)n;
+
+    MineGenerator gen;
+    int bands = (b->height + MAP_BAND_ROWS - 1) / MAP_BAND_ROWS;
+    size_t *band_mines = (size_t *)malloc((size_t)bands * sizeof(size_t));
+    if (!band_mines)
+        return;
+    if (bitplane_init(&gen.plane, b->width, b->height) != 0)
     {
-        int x = rand() % map_width;
-        int y = rand() % map_height;
-        if (exclude_x >= 0 && x == exclude_x && y == exclude_y)
-            continue;
-        if (!map[y][x].is_mine)
-        {
-            map[y][x].is_mine = true;
-            placed++;
-        }
+        free(band_mines);
+        return;
     }
-    fill_map();
+
+    Rng rng;
+    rng_seed(&rng, seed);
+    size_t remaining_cells = n, remaining_mines = (size_t)b->mines;
+    for (int band = 0; band < bands; ++band)
+    {
+        int y0, y1;
+        band_rows(b, band, &y0, &y1);
+        size_t first = (size_t)y0 * (size_t)b->width, count = (size_t)(y1 - y0) * (size_t)b->width;
+        if (excluded >= first && excluded < first + count)
+            count--;
+        band_mines[band] = (size_t)rng_hypergeometric(&rng, remaining_cells, count, remaining_mines);
+        remaining_cells -= count;
+        remaining_mines -= band_mines[band];
+    }
+
+    gen.b = b;
+    gen.seed = seed;
+    gen.excluded = excluded;
+    gen.band_mines = band_mines;
+    if (cells < MAP_PARALLEL_MIN_CELLS)
+        threads = 1;
+    // De kernels moeten gekozen zijn vooraleer meerdere threads ze gebruiken.
+    bitplane_setup();
+    // Het tellen begint pas als alle banden hun mijnen in de bitplane gezet hebben (de halo komt uit de buurbanden).
+    parallel_for(bands, threads, place_band, &gen);
+    parallel_for(bands, threads, count_band, &gen);
+    bitplane_free(&gen.plane);
+    free(band_mines);
+    CHECK_NUMBERS(b);
 }
 
 // Om de map te dealloceren, nadat het spel afgelopen is.
-void free_map()
+void free_map(Board *b)
 {
-    if (map)
+    if (b && b->cells)
     {
-        for (int i = 0; i < map_height; i++)
-        {
-            if (map[i])
-                free(map[i]);
-        }
-        free(map);
-        map = NULL;
+        free(b->cells);
+        b->cells = NULL;
     }
-}
\ No newline at end of file
+}
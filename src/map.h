@@ -2,30 +2,90 @@
 #define MINESWEEPER_map_height
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
-// We declareren globale/externe variabelen voor de map dimensies en het aantal mijnen.
-extern int map_width;
-extern int map_height;
-extern int map_mines;
-int init_map(int w, int h, int mines);
-void create_map();
-void free_map();
+// De standaardwaarden van het speelveld, wanneer er geen dimensies of bestand worden meegegeven.
+#define DEFAULT_MAP_WIDTH 10
+#define DEFAULT_MAP_HEIGHT 10
+#define DEFAULT_MAP_MINES 10
 
-// We declareren een struct om de waarden/eigenschappen van een cell mee op te slaan.
+/*
+ * Elke cell wordt opgeslagen in 1 byte.
+ * De onderste 4 bits bevatten het aantal aangrenzende mijnen (0-8), of de waarde CELL_MINE als de cell zelf een mijn is.
+ * De bovenste 4 bits zijn vlaggen voor de toestand van de cell.
+ */
+typedef uint8_t Cell;
+
+#define CELL_VALUE_MASK 0x0F
+#define CELL_MINE 0x0F
+#define CELL_FLAGGED 0x10
+#define CELL_UNCOVERED 0x20
+#define CELL_REMOVED 0x40
+#define CELL_SAVED_UNCOVERED 0x80
+#define CELL_STATE_MASK 0xF0
+
+/*
+ * We gebruiken een struct om een speelveld met zijn dimensies en het aantal mijnen door te geven.
+ * De cellen worden rij per rij opgeslagen in 1 aaneengesloten buffer van width * height cellen.
+ */
 typedef struct
 {
-    bool is_mine;
-    int neighbour_mines;
-    bool uncovered;
-    bool flagged;
-    bool removed;
-    bool saved_uncovered;
-} Cell;
-
-void add_mines(int exclude_x, int exclude_y);
-void fill_map();
-// We declareren een globale/externe 2D array van Cell structs om het speelveld in op te slaan.
-extern Cell **map;
-void print_map();
-
-#endif // MINESWEEPER_map_height
\ No newline at end of file
+    int width;
+    int height;
+    int mines;
+    Cell *cells;
+} Board;
+
+// Geeft de cell op positie (x, y) van het speelveld b terug.
+#define MAP_CELL(b, x, y) ((b)->cells[(size_t)(y) * (size_t)(b)->width + (size_t)(x)])
+
+// Accessors om de velden van een gepackte cell uit te lezen en aan te passen.
+static inline bool cell_is_mine(Cell c)
+{
+    return (c & CELL_VALUE_MASK) == CELL_MINE;
+}
+
+static inline int cell_neighbour_mines(Cell c)
+{
+    return cell_is_mine(c) ? 0 : (c & CELL_VALUE_MASK);
+}
+
+static inline bool cell_has(Cell c, Cell flag)
+{
+    return (c & flag) != 0;
+}
+
+static inline void cell_set(Cell *c, Cell flag, bool on)
+{
+    if (on)
+        *c |= flag;
+    else
+        *c &= (Cell)~flag;
+}
+
+// Zet de waarde (mijn of aantal aangrenzende mijnen) van een cell, zonder de toestand te wijzigen.
+static inline void cell_set_value(Cell *c, int value)
+{
+    *c = (Cell)((*c & CELL_STATE_MASK) | (value & CELL_VALUE_MASK));
+}
+
+static inline size_t map_cell_count(const Board *b)
+{
+    return (size_t)b->width * (size_t)b->height;
+}
+
+static inline bool map_in_bounds(const Board *b, int x, int y)
+{
+    return x >= 0 && x < b->width && y >= 0 && y < b->height;
+}
+
+int init_map(Board *b, int w, int h, int mines);
+void create_map(Board *b);
+void init_states(Board *b);
+void free_map(Board *b);
+void add_mines(Board *b, uint64_t seed, int threads, int exclude_x, int exclude_y);
+void fill_map(Board *b);
+void print_map(const Board *b);
+
+#endif // MINESWEEPER_map_height
@@ -0,0 +1,158 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "noguess.h"
+#include "bitplane.h"
+#include "game.h"
+#include "parallel.h"
+#include "rng.h"
+#include "solver.h"
+
+// Wordt met de seed gemengd, zodat de kandidaten andere stromen gebruiken dan het gewone speelveld van dezelfde seed.
+#define NO_GUESS_SALT 0x6E6F67756573735FULL
+
+// De werkruimte van 1 thread: een spel om de kandidaat op te spelen en een solver, hergebruikt over de rondes.
+typedef struct
+{
+    Game *game;
+    Solver solver;
+    bool solved;
+} NoGuessWorker;
+
+typedef struct
+{
+    uint64_t seed;
+    int x, y;
+    long first; // de index van de eerste kandidaat van deze ronde
+    NoGuessWorker *workers;
+} NoGuessRound;
+
+/*
+ * Maakt kandidaat attempt in b (met lege toestanden): een gewoon speelveld zonder mijn op (x, y),
+ * waarna de mijnen uit de 3x3 rond (x, y) naar willekeurige vrije cellen daarbuiten verhuizen.
+ */
+static void make_candidate(Board *b, uint64_t seed, long attempt, int x, int y)
+{
+    Rng rng;
+    rng_seed_stream(&rng, seed ^ NO_GUESS_SALT, (uint64_t)attempt);
+    memset(b->cells, 0, map_cell_count(b));
+    add_mines(b, rng_next(&rng), 1, x, y);
+
+    size_t cells = map_cell_count(b);
+    for (int ny = y - 1; ny <= y + 1; ++ny)
+    {
+        for (int nx = x - 1; nx <= x + 1; ++nx)
+        {
+            if (!map_in_bounds(b, nx, ny) || !cell_is_mine(MAP_CELL(b, nx, ny)))
+                continue;
+            // generate_no_guess zorgt dat er buiten de 3x3 nog vrije cellen zijn.
+            for (;;)
+            {
+                size_t i = (size_t)rng_bounded(&rng, cells);
+                int tx = (int)(i % (size_t)b->width), ty = (int)(i / (size_t)b->width);
+                bool inside = tx >= x - 1 && tx <= x + 1 && ty >= y - 1 && ty <= y + 1;
+                if (!inside && !cell_is_mine(b->cells[i]))
+                {
+                    cell_set_value(&b->cells[i], CELL_MINE);
+                    break;
+                }
+            }
+            cell_set_value(&MAP_CELL(b, nx, ny), 0);
+        }
+    }
+    fill_map(b);
+}
+
+// Speelt de kandidaat met de solver vanaf (x, y): enkel zekere zetten. Geeft terug of hij zo gewonnen wordt.
+static bool solvable(NoGuessWorker *worker, int x, int y)
+{
+    Game *game = worker->game;
+    game->mines_placed = true;
+    game_reveal(game, x, y);
+    while (game_status(game) == GAME_PLAYING)
+    {
+        if (solver_step(&worker->solver, game) != 0 || worker->solver.safe_count == 0)
+            return false;
+        int width = game->board.width;
+        for (size_t i = 0; i < worker->solver.safe_count; ++i)
+            game_reveal(game, worker->solver.safe[i] % width, worker->solver.safe[i] / width);
+    }
+    return game_status(game) == GAME_WON;
+}
+
+// Taak per thread: maakt en controleert kandidaat first + worker.
+static void check_candidate(void *context, int task)
+{
+    NoGuessRound *round = (NoGuessRound *)context;
+    NoGuessWorker *worker = &round->workers[task];
+    game_reset(worker->game, 0);
+    make_candidate(&worker->game->board, round->seed, round->first + task, round->x, round->y);
+    worker->solved = solvable(worker, round->x, round->y);
+}
+
+/*
+ * Plaatst in b (met mijnen, maar nog zonder toestanden) een speelveld dat vanaf (x, y) zonder gokken op te lossen is.
+ * In *out_attempts komt het aantal kandidaten tot en met de geslaagde.
+ * Geeft -1 terug als er geen gevonden is na NO_GUESS_MAX_ATTEMPTS kandidaten (of als het niet kan), zonder b te wijzigen.
+ */
+int generate_no_guess(Board *b, uint64_t seed, int threads, int x, int y, long *out_attempts)
+{
+    *out_attempts = 0;
+    // Voor de opening moeten alle mijnen buiten de 3x3 rond de klik passen.
+    int inside = 0;
+    for (int ny = y - 1; ny <= y + 1; ++ny)
+        for (int nx = x - 1; nx <= x + 1; ++nx)
+            inside += map_in_bounds(b, nx, ny);
+    if (!map_in_bounds(b, x, y) || (size_t)b->mines + (size_t)inside > map_cell_count(b))
+        return -1;
+
+    if (threads <= 0)
+        threads = parallel_default_threads();
+    if (threads > NO_GUESS_MAX_ATTEMPTS)
+        threads = NO_GUESS_MAX_ATTEMPTS;
+    NoGuessWorker *workers = (NoGuessWorker *)calloc((size_t)threads, sizeof(NoGuessWorker));
+    if (!workers)
+        return -1;
+    int result = -1;
+    for (int t = 0; t < threads; ++t)
+    {
+        solver_init(&workers[t].solver);
+        workers[t].game = game_new(b->width, b->height, b->mines);
+        if (!workers[t].game)
+            goto done;
+    }
+
+    /*
+     * De kandidaten worden op de threads gegenereerd, dus add_mines loopt op meerdere threads tegelijk
+     * (daarom gebruikt rng_hypergeometric geen lgamma, zie rng.c). De kernels moeten gekozen zijn vooraleer de threads starten.
+     */
+    bitplane_setup();
+    NoGuessRound round;
+    round.seed = seed;
+    round.x = x;
+    round.y = y;
+    round.workers = workers;
+    for (round.first = 0; round.first < NO_GUESS_MAX_ATTEMPTS; round.first += threads)
+    {
+        parallel_for(threads, threads, check_candidate, &round);
+        for (int t = 0; t < threads; ++t)
+        {
+            if (!workers[t].solved)
+                continue;
+            *out_attempts = round.first + t + 1;
+            make_candidate(b, seed, round.first + t, x, y);
+            result = 0;
+            goto done;
+        }
+    }
+    *out_attempts = NO_GUESS_MAX_ATTEMPTS;
+
+done:
+    for (int t = 0; t < threads; ++t)
+    {
+        solver_free(&workers[t].solver);
+        game_free(workers[t].game);
+    }
+    free(workers);
+    return result;
+}
@@ -0,0 +1,20 @@
+#ifndef MINESWEEPER_NOGUESS_H
+#define MINESWEEPER_NOGUESS_H
+
+#include <stdint.h>
+#include "map.h"
+
+/*
+ * Genereert een speelveld dat zonder gokken op te lossen is vanaf de eerste klik (via -g).
+ * Elke kandidaat is een gewoon speelveld (add_mines) waarin de 3x3 rond de eerste klik vrijgemaakt wordt,
+ * zodat de eerste klik altijd een opening is. De solver speelt de kandidaat vanaf die klik: raakt hij vast, dan verwerpen we hem.
+ * De kandidaten worden speculatief per ronde van threads tegelijk gecontroleerd; de eerste geslaagde kandidaat
+ * (met de kleinste index) wint, dus het resultaat hangt enkel af van de seed en de klik, niet van het aantal threads.
+ */
+
+// Na zoveel kandidaten geven we op (de aanroeper valt dan terug op een gewoon speelveld).
+#define NO_GUESS_MAX_ATTEMPTS 100000
+
+int generate_no_guess(Board *b, uint64_t seed, int threads, int x, int y, long *out_attempts);
+
+#endif // MINESWEEPER_NOGUESS_H
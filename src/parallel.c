@@ -0,0 +1,155 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#include "parallel.h"
+
+// Het maximum aantal threads, ook als -j meer vraagt.
+#define PARALLEL_MAX_THREADS 256
+
+typedef struct
+{
+    ParallelTask task;
+    void *context;
+    int tasks;
+    int threads;
+    int first;
+    volatile long *next; // enkel bij parallel_for_dynamic: de teller van de volgende vrije taak
+} ParallelWorker;
+
+// Verhoogt *next atomair en geeft de oude waarde terug.
+static long fetch_next(volatile long *next)
+{
+#ifdef _WIN32
+    return InterlockedIncrement(next) - 1;
+#else
+    return __atomic_fetch_add(next, 1, __ATOMIC_RELAXED);
+#endif
+}
+
+/*
+ * Een worker voert de taken first, first + threads, first + 2 * threads, ... uit.
+ * Bij parallel_for_dynamic neemt hij telkens de volgende vrije taak, tot ze allemaal genomen zijn.
+ */
+static void run_worker(const ParallelWorker *worker)
+{
+    if (worker->next)
+    {
+        for (long i = fetch_next(worker->next); i < worker->tasks; i = fetch_next(worker->next))
+            worker->task(worker->context, (int)i);
+        return;
+    }
+    for (int i = worker->first; i < worker->tasks; i += worker->threads)
+        worker->task(worker->context, i);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI worker_main(LPVOID data)
+{
+    run_worker((const ParallelWorker *)data);
+    return 0;
+}
+#else
+static void *worker_main(void *data)
+{
+    run_worker((const ParallelWorker *)data);
+    return NULL;
+}
+#endif
+
+// Het aantal threads als de speler geen -j opgeeft: 1 per (logische) core.
+int parallel_default_threads()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int n = (int)info.dwNumberOfProcessors;
+#else
+    int n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return n > 0 ? n : 1;
+}
+
+/*
+ * Voert task(context, i) uit voor elke i in [0, tasks), verdeeld over maximaal threads threads (0 = parallel_default_threads).
+ * De aanroepende thread doet zelf mee als worker 0. Als er geen thread aangemaakt kan worden, voert de aanroeper
+ * de taken van die worker achteraf zelf uit: het resultaat blijft hetzelfde, enkel trager.
+ * Met next != NULL worden de taken dynamisch verdeeld (zie parallel_for_dynamic).
+ */
+static void run_parallel(int tasks, int threads, ParallelTask task, void *context, volatile long *next)
+{
+    if (threads <= 0)
+        threads = parallel_default_threads();
+    if (threads > tasks)
+        threads = tasks;
+    if (threads > PARALLEL_MAX_THREADS)
+        threads = PARALLEL_MAX_THREADS;
+    if (threads <= 1)
+    {
+        for (int i = 0; i < tasks; ++i)
+            task(context, i);
+        return;
+    }
+
+    ParallelWorker workers[PARALLEL_MAX_THREADS];
+#ifdef _WIN32
+    HANDLE handles[PARALLEL_MAX_THREADS];
+#else
+    pthread_t handles[PARALLEL_MAX_THREADS];
+#endif
+    bool started[PARALLEL_MAX_THREADS];
+    for (int t = 0; t < threads; ++t)
+    {
+        workers[t].task = task;
+        workers[t].context = context;
+        workers[t].tasks = tasks;
+        workers[t].threads = threads;
+        workers[t].first = t;
+        workers[t].next = next;
+        started[t] = false;
+    }
+    for (int t = 1; t < threads; ++t)
+    {
+#ifdef _WIN32
+        handles[t] = CreateThread(NULL, 0, worker_main, &workers[t], 0, NULL);
+        started[t] = handles[t] != NULL;
+#else
+        started[t] = pthread_create(&handles[t], NULL, worker_main, &workers[t]) == 0;
+#endif
+    }
+    run_worker(&workers[0]);
+    for (int t = 1; t < threads; ++t)
+    {
+        if (!started[t])
+        {
+            run_worker(&workers[t]);
+            continue;
+        }
+#ifdef _WIN32
+        WaitForSingleObject(handles[t], INFINITE);
+        CloseHandle(handles[t]);
+#else
+        pthread_join(handles[t], NULL);
+#endif
+    }
+}
+
+void parallel_for(int tasks, int threads, ParallelTask task, void *context)
+{
+    run_parallel(tasks, threads, task, context, NULL);
+}
+
+/*
+ * Zoals parallel_for, maar elke thread neemt de volgende vrije taak zodra hij klaar is met de vorige.
+ * Voor taken waarvan de kost sterk verschilt (geef de duurste eerst): een trage taak houdt de andere threads niet op.
+ * Welke thread een taak uitvoert, hangt hier wel af van de timing.
+ */
+void parallel_for_dynamic(int tasks, int threads, ParallelTask task, void *context)
+{
+    volatile long next = 0;
+    run_parallel(tasks, threads, task, context, &next);
+}
@@ -0,0 +1,16 @@
+#ifndef MINESWEEPER_PARALLEL_H
+#define MINESWEEPER_PARALLEL_H
+
+/*
+ * Een minimale parallel for, zonder SDL (de game core moet headless blijven): pthreads, of Win32 threads op Windows.
+ * Bij parallel_for gaat taak i naar thread i % threads; de verdeling hangt dus niet af van de timing.
+ * Bij parallel_for_dynamic neemt elke vrije thread de volgende taak (voor taken van ongelijke grootte).
+ * Het resultaat mag enkel van de taak zelf afhangen, niet van de thread die ze uitvoert.
+ */
+typedef void (*ParallelTask)(void *context, int task);
+
+int parallel_default_threads();
+void parallel_for(int tasks, int threads, ParallelTask task, void *context);
+void parallel_for_dynamic(int tasks, int threads, ParallelTask task, void *context);
+
+#endif // MINESWEEPER_PARALLEL_H
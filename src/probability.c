@@ -0,0 +1,682 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "probability.h"
+#include "parallel.h"
+
+// Tijdelijke markering in probability voor een covered cell die (nog) tot de binnenkant behoort.
+#define PROBABILITY_INTERIOR (-2.0f)
+
+void probability_init(ProbabilityEngine *engine)
+{
+    memset(engine, 0, sizeof(*engine));
+    solver_init(&engine->solver);
+}
+
+static void free_component(ProbabilityComponent *component)
+{
+    free(component->key);
+    free(component->counts);
+    free(component->var_mines);
+    memset(component, 0, sizeof(*component));
+}
+
+static void free_components(ProbabilityComponent *components, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        free_component(&components[i]);
+    free(components);
+}
+
+void probability_free(ProbabilityEngine *engine)
+{
+    int threads = engine->threads;
+    solver_free(&engine->solver);
+    free(engine->probability);
+    free(engine->var_of);
+    free(engine->log_factorial);
+    free_components(engine->components, engine->component_count);
+    probability_init(engine);
+    engine->threads = threads;
+}
+
+// Zorgt dat de buffers per cell groot genoeg zijn, en memoriseert log(n!) voor n = 0..cells.
+static int ensure_capacity(ProbabilityEngine *engine, size_t cells)
+{
+    if (cells <= engine->capacity)
+        return 0;
+    free(engine->probability);
+    free(engine->var_of);
+    free(engine->log_factorial);
+    engine->capacity = 0;
+    engine->probability = (float *)malloc(cells * sizeof(float));
+    engine->var_of = (int *)malloc(cells * sizeof(int));
+    engine->log_factorial = (double *)malloc((cells + 1) * sizeof(double));
+    if (!engine->probability || !engine->var_of || !engine->log_factorial)
+        return -1;
+    for (size_t i = 0; i < cells; ++i)
+        engine->var_of[i] = -1;
+    engine->log_factorial[0] = 0;
+    for (size_t n = 1; n <= cells; ++n)
+        engine->log_factorial[n] = engine->log_factorial[n - 1] + log((double)n);
+    engine->capacity = cells;
+    return 0;
+}
+
+// log(n boven k), of -oneindig als er geen enkele manier is.
+static double log_choose(const ProbabilityEngine *engine, long n, long k)
+{
+    if (k < 0 || k > n)
+        return -INFINITY;
+    return engine->log_factorial[n] - engine->log_factorial[k] - engine->log_factorial[n - k];
+}
+
+static int find_root(int *parent, int v)
+{
+    while (parent[v] != v)
+    {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+    return v;
+}
+
+// FNV-1a over de sleutel van een deel.
+static uint64_t hash_key(const int *key, size_t length)
+{
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < length; ++i)
+    {
+        h ^= (uint64_t)(uint32_t)key[i];
+        h *= 0x100000001B3ULL;
+    }
+    return h;
+}
+
+// De toestand van het tellen van de oplossingen van 1 deel (per taak, dus per thread).
+typedef struct
+{
+    int var_count;
+    const int *var_offsets;     // per variabele: de constraints waarin ze voorkomt (CSR)
+    const int *var_constraints;
+    int *mines_assigned;
+    int *unassigned;
+    const int *needed;
+    uint8_t *assignment;
+    double *counts;
+    double *var_mines;
+    long nodes;
+} SolutionCounter;
+
+static bool count_assign(SolutionCounter *e, int v, int mine)
+{
+    bool ok = true;
+    for (int k = e->var_offsets[v]; k < e->var_offsets[v + 1]; ++k)
+    {
+        int c = e->var_constraints[k];
+        e->unassigned[c]--;
+        e->mines_assigned[c] += mine;
+        if (e->mines_assigned[c] > e->needed[c] || e->mines_assigned[c] + e->unassigned[c] < e->needed[c])
+            ok = false;
+    }
+    return ok;
+}
+
+static void count_unassign(SolutionCounter *e, int v, int mine)
+{
+    for (int k = e->var_offsets[v]; k < e->var_offsets[v + 1]; ++k)
+    {
+        int c = e->var_constraints[k];
+        e->unassigned[c]++;
+        e->mines_assigned[c] -= mine;
+    }
+}
+
+// Backtracking zoals in de solver, maar we tellen de oplossingen per aantal mijnen (en per variabele).
+static void count_solutions(SolutionCounter *e, int v, int mines)
+{
+    if (e->nodes++ > PROBABILITY_NODE_BUDGET)
+        return;
+    if (v == e->var_count)
+    {
+        e->counts[mines] += 1;
+        for (int i = 0; i < e->var_count; ++i)
+        {
+            if (e->assignment[i])
+                e->var_mines[(size_t)i * (size_t)(e->var_count + 1) + (size_t)mines] += 1;
+        }
+        return;
+    }
+    for (int mine = 0; mine <= 1; ++mine)
+    {
+        e->assignment[v] = (uint8_t)mine;
+        if (count_assign(e, v, mine))
+            count_solutions(e, v + 1, mines + mine);
+        count_unassign(e, v, mine);
+    }
+}
+
+// Taak voor parallel_for_dynamic: telt de oplossingen van 1 deel, enkel op basis van zijn sleutel.
+static void count_component(void *context, int task)
+{
+    ProbabilityComponent *component = ((ProbabilityComponent **)context)[task];
+    const int *key = component->key;
+    int var_count = key[0], constraint_count = key[1];
+    component->exact = false;
+    if (var_count > PROBABILITY_MAX_COMPONENT_VARS)
+        return;
+
+    int *needed = (int *)malloc((size_t)constraint_count * sizeof(int));
+    int *mines_assigned = (int *)calloc((size_t)constraint_count, sizeof(int));
+    int *unassigned = (int *)malloc((size_t)constraint_count * sizeof(int));
+    int *var_offsets = (int *)calloc((size_t)var_count + 2, sizeof(int));
+    int *var_constraints = (int *)malloc((size_t)constraint_count * 8 * sizeof(int));
+    uint8_t *assignment = (uint8_t *)malloc((size_t)var_count);
+    component->counts = (double *)calloc((size_t)var_count + 1, sizeof(double));
+    component->var_mines = (double *)calloc((size_t)var_count * (size_t)(var_count + 1), sizeof(double));
+    if (needed && mines_assigned && unassigned && var_offsets && var_constraints && assignment && component->counts &&
+        component->var_mines)
+    {
+        // Per variabele de lijst van haar constraints, in 2 passen over de constraints in de sleutel.
+        const int *c = key + 2 + var_count;
+        for (int i = 0; i < constraint_count; ++i, c += 2 + c[1])
+        {
+            for (int j = 0; j < c[1]; ++j)
+                var_offsets[c[2 + j] + 2]++;
+        }
+        for (int v = 0; v < var_count; ++v)
+            var_offsets[v + 2] += var_offsets[v + 1];
+        c = key + 2 + var_count;
+        for (int i = 0; i < constraint_count; ++i, c += 2 + c[1])
+        {
+            needed[i] = c[0];
+            unassigned[i] = c[1];
+            for (int j = 0; j < c[1]; ++j)
+                var_constraints[var_offsets[c[2 + j] + 1]++] = i;
+        }
+
+        SolutionCounter e;
+        e.var_count = var_count;
+        e.var_offsets = var_offsets;
+        e.var_constraints = var_constraints;
+        e.mines_assigned = mines_assigned;
+        e.unassigned = unassigned;
+        e.needed = needed;
+        e.assignment = assignment;
+        e.counts = component->counts;
+        e.var_mines = component->var_mines;
+        e.nodes = 0;
+        count_solutions(&e, 0, 0);
+
+        double solutions = 0;
+        for (int k = 0; k <= var_count; ++k)
+            solutions += component->counts[k];
+        component->exact = e.nodes <= PROBABILITY_NODE_BUDGET && solutions > 0;
+    }
+    free(needed);
+    free(mines_assigned);
+    free(unassigned);
+    free(var_offsets);
+    free(var_constraints);
+    free(assignment);
+}
+
+// Sorteert de te tellen delen van groot naar klein, zodat een groot deel niet als laatste begint.
+static int compare_var_count(const void *a, const void *b)
+{
+    const ProbabilityComponent *x = *(ProbabilityComponent *const *)a, *y = *(ProbabilityComponent *const *)b;
+    return (y->var_count > x->var_count) - (y->var_count < x->var_count);
+}
+
+/*
+ * Splitst de onbekende variabelen van de constraints in onafhankelijke delen en geeft elk deel zijn sleutel.
+ * De resultaten van een deel met dezelfde sleutel als bij de vorige update worden overgenomen; de rest wordt (parallel) geteld.
+ * Geeft -1 terug als het geheugen opraakt.
+ */
+static int build_components(ProbabilityEngine *engine)
+{
+    Solver *solver = &engine->solver;
+    size_t max_vars = solver->constraint_count * 8;
+    int *cells = (int *)malloc((max_vars + 1) * sizeof(int));
+    int *parent = (int *)malloc((max_vars + 1) * sizeof(int));
+    int *active = (int *)malloc((solver->constraint_count + 1) * sizeof(int));
+    int *component_of = (int *)malloc((max_vars + 1) * sizeof(int));
+    int *local_of = (int *)malloc((max_vars + 1) * sizeof(int));
+    int *var_count_of = (int *)calloc(max_vars + 1, sizeof(int));
+    size_t *key_length_of = (size_t *)calloc(max_vars + 1, sizeof(size_t));
+    ProbabilityComponent *fresh = NULL, **pending = NULL;
+    size_t *table = NULL;
+    int result = -1;
+    int var_count = 0, active_count = 0;
+    size_t fresh_count = 0;
+    if (!cells || !parent || !active || !component_of || !local_of || !var_count_of || !key_length_of)
+        goto done;
+
+    for (size_t ci = 0; ci < solver->constraint_count; ++ci)
+    {
+        int vars[8], k;
+        int n = solver_effective(solver, &solver->constraints[ci], vars, &k);
+        if (n == 0)
+            continue;
+        active[active_count++] = (int)ci;
+        int first = -1;
+        for (int i = 0; i < n; ++i)
+        {
+            int id = engine->var_of[vars[i]];
+            if (id < 0)
+            {
+                id = var_count++;
+                engine->var_of[vars[i]] = id;
+                cells[id] = vars[i];
+                parent[id] = id;
+            }
+            if (first < 0)
+                first = find_root(parent, id);
+            else
+                parent[find_root(parent, id)] = first = find_root(parent, first);
+        }
+    }
+
+    // Elke wortel wordt een deel; we bepalen eerst de grootte van zijn sleutel.
+    for (int v = 0; v < var_count; ++v)
+        component_of[v] = -1;
+    for (int v = 0; v < var_count; ++v)
+    {
+        int r = find_root(parent, v);
+        if (component_of[r] < 0)
+            component_of[r] = (int)fresh_count++;
+        component_of[v] = component_of[r];
+        var_count_of[component_of[v]]++;
+    }
+    fresh = (ProbabilityComponent *)calloc(fresh_count + 1, sizeof(ProbabilityComponent));
+    pending = (ProbabilityComponent **)malloc((fresh_count + 1) * sizeof(ProbabilityComponent *));
+    if (!fresh || !pending)
+        goto done;
+    for (size_t i = 0; i < fresh_count; ++i)
+        key_length_of[i] = 2 + (size_t)var_count_of[i];
+    for (int a = 0; a < active_count; ++a)
+    {
+        int vars[8], k;
+        int n = solver_effective(solver, &solver->constraints[active[a]], vars, &k);
+        key_length_of[component_of[engine->var_of[vars[0]]]] += 2 + (size_t)n;
+    }
+    for (size_t i = 0; i < fresh_count; ++i)
+    {
+        fresh[i].key = (int *)malloc(key_length_of[i] * sizeof(int));
+        if (!fresh[i].key)
+            goto done;
+        fresh[i].key[0] = 0;
+        fresh[i].key[1] = 0;
+        fresh[i].key_length = 2;
+    }
+
+    // De variabelen in de volgorde van hun id, met hun lokale index in het deel; daarna de constraints.
+    for (int v = 0; v < var_count; ++v)
+    {
+        ProbabilityComponent *component = &fresh[component_of[v]];
+        component->key[component->key_length++] = cells[v];
+        local_of[v] = component->key[0]++;
+    }
+    for (int a = 0; a < active_count; ++a)
+    {
+        int vars[8], k;
+        int n = solver_effective(solver, &solver->constraints[active[a]], vars, &k);
+        ProbabilityComponent *component = &fresh[component_of[engine->var_of[vars[0]]]];
+        int *key = component->key;
+        key[1]++;
+        key[component->key_length++] = k;
+        key[component->key_length++] = n;
+        for (int i = 0; i < n; ++i)
+            key[component->key_length++] = local_of[engine->var_of[vars[i]]];
+    }
+
+    // De delen van de vorige update, op hash, om ongewijzigde delen terug te vinden.
+    size_t table_size = 1;
+    while (table_size < engine->component_count * 2 + 1)
+        table_size *= 2;
+    table = (size_t *)calloc(table_size, sizeof(size_t));
+    if (!table)
+        goto done;
+    for (size_t i = 0; i < engine->component_count; ++i)
+    {
+        size_t slot = (size_t)engine->components[i].hash & (table_size - 1);
+        while (table[slot])
+            slot = (slot + 1) & (table_size - 1);
+        table[slot] = i + 1;
+    }
+
+    size_t pending_count = 0;
+    engine->reused = 0;
+    for (size_t i = 0; i < fresh_count; ++i)
+    {
+        ProbabilityComponent *component = &fresh[i];
+        component->var_count = component->key[0];
+        component->hash = hash_key(component->key, component->key_length);
+        ProbabilityComponent *old = NULL;
+        for (size_t slot = (size_t)component->hash & (table_size - 1); table[slot]; slot = (slot + 1) & (table_size - 1))
+        {
+            ProbabilityComponent *candidate = &engine->components[table[slot] - 1];
+            if (candidate->key && candidate->hash == component->hash && candidate->key_length == component->key_length &&
+                memcmp(candidate->key, component->key, component->key_length * sizeof(int)) == 0)
+            {
+                old = candidate;
+                break;
+            }
+        }
+        if (old)
+        {
+            // Ongewijzigd sinds de vorige update: we nemen de getelde oplossingen over.
+            component->exact = old->exact;
+            component->counts = old->counts;
+            component->var_mines = old->var_mines;
+            old->counts = NULL;
+            old->var_mines = NULL;
+            free(old->key);
+            old->key = NULL;
+            engine->reused++;
+        }
+        else
+            pending[pending_count++] = component;
+    }
+
+    qsort(pending, pending_count, sizeof(ProbabilityComponent *), compare_var_count);
+    parallel_for_dynamic((int)pending_count, engine->threads, count_component, pending);
+    engine->computed = pending_count;
+
+    free_components(engine->components, engine->component_count);
+    engine->components = fresh;
+    engine->component_count = fresh_count;
+    fresh = NULL;
+    result = 0;
+
+done:
+    for (int v = 0; v < var_count; ++v)
+        engine->var_of[cells[v]] = -1;
+    if (fresh)
+        free_components(fresh, fresh_count);
+    free(cells);
+    free(parent);
+    free(active);
+    free(component_of);
+    free(local_of);
+    free(var_count_of);
+    free(key_length_of);
+    free(pending);
+    free(table);
+    return result;
+}
+
+/*
+ * Combineert de delen exact: de kans op een oplossing met k mijnen in deel c is evenredig met
+ * counts_c[k] * (de oplossingen van de andere delen) * C(binnenkant, resterende mijnen - alle mijnen in de delen).
+ * suffix[i] is de gewogen som over de delen i..n-1 en de binnenkant, prefix de convolutie van de delen 0..c-1.
+ * Elke vector wordt herschaald naar maximum 1: de kansen zijn verhoudingen, dus dat verandert niets.
+ * Geeft false terug als het geheugen opraakt of als er geen enkele oplossing is.
+ */
+static bool combine_exact(ProbabilityEngine *engine, ProbabilityComponent **parts, int n, int total_vars, long interior,
+                          long remaining, float *interior_probability)
+{
+    size_t width = (size_t)total_vars + 1;
+    double *suffix = (double *)malloc((size_t)(n + 1) * width * sizeof(double));
+    double *prefix = (double *)calloc(width, sizeof(double));
+    double *next = (double *)malloc(width * sizeof(double));
+    double *weights = (double *)malloc((PROBABILITY_MAX_COMPONENT_VARS + 1) * sizeof(double));
+    bool ok = false;
+    if (!suffix || !prefix || !next || !weights)
+        goto done;
+
+    double *g = &suffix[(size_t)n * width];
+    double max_log = -INFINITY;
+    for (size_t s = 0; s < width; ++s)
+    {
+        g[s] = log_choose(engine, interior, remaining - (long)s);
+        if (g[s] > max_log)
+            max_log = g[s];
+    }
+    if (max_log == -INFINITY)
+        goto done;
+    for (size_t s = 0; s < width; ++s)
+        g[s] = exp(g[s] - max_log);
+
+    for (int i = n - 1; i >= 0; --i)
+    {
+        const double *later = &suffix[(size_t)(i + 1) * width];
+        double *current = &suffix[(size_t)i * width];
+        const ProbabilityComponent *c = parts[i];
+        double max = 0;
+        for (size_t s = 0; s < width; ++s)
+        {
+            double sum = 0;
+            for (int k = 0; k <= c->var_count && s + (size_t)k < width; ++k)
+                sum += c->counts[k] * later[s + (size_t)k];
+            current[s] = sum;
+            if (sum > max)
+                max = sum;
+        }
+        if (max <= 0)
+            goto done;
+        for (size_t s = 0; s < width; ++s)
+            current[s] /= max;
+    }
+
+    prefix[0] = 1;
+    size_t used = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        const ProbabilityComponent *c = parts[i];
+        const double *later = &suffix[(size_t)(i + 1) * width];
+        double total = 0;
+        for (int k = 0; k <= c->var_count; ++k)
+        {
+            double sum = 0;
+            for (size_t p = 0; p <= used; ++p)
+                sum += prefix[p] * later[p + (size_t)k];
+            weights[k] = sum;
+            total += c->counts[k] * sum;
+        }
+        if (total <= 0)
+            goto done;
+        size_t stride = (size_t)c->var_count + 1;
+        for (int v = 0; v < c->var_count; ++v)
+        {
+            double sum = 0;
+            for (int k = 0; k <= c->var_count; ++k)
+                sum += c->var_mines[(size_t)v * stride + (size_t)k] * weights[k];
+            engine->probability[c->key[2 + v]] = (float)(sum / total);
+        }
+
+        // prefix = prefix * counts_c
+        double max = 0;
+        for (size_t s = 0; s <= used + (size_t)c->var_count; ++s)
+        {
+            double sum = 0;
+            for (int k = 0; k <= c->var_count && (size_t)k <= s; ++k)
+            {
+                if (s - (size_t)k <= used)
+                    sum += prefix[s - (size_t)k] * c->counts[k];
+            }
+            next[s] = sum;
+            if (sum > max)
+                max = sum;
+        }
+        used += (size_t)c->var_count;
+        for (size_t s = 0; s <= used; ++s)
+            prefix[s] = next[s] / max;
+    }
+
+    // De verwachte mijnen in de delen bepalen de kans voor de binnenkant.
+    double total = 0, expected = 0;
+    for (size_t s = 0; s <= used; ++s)
+    {
+        double t = prefix[s] * g[s];
+        total += t;
+        expected += t * (double)s;
+    }
+    if (total <= 0)
+        goto done;
+    *interior_probability = interior > 0 ? (float)(((double)remaining - expected / total) / (double)interior) : 0.0f;
+    ok = true;
+
+done:
+    free(suffix);
+    free(prefix);
+    free(next);
+    free(weights);
+    return ok;
+}
+
+/*
+ * De gewichten van de oplossingen van een deel met k mijnen, als elke mijn een factor q = exp(log_q) kost
+ * (herschaald met het grootste exponent, zodat er niets overloopt). Geeft het verwachte aantal mijnen terug.
+ */
+static double component_weights(const ProbabilityComponent *c, double log_q, double *weights)
+{
+    double max = -INFINITY;
+    for (int k = 0; k <= c->var_count; ++k)
+    {
+        if (c->counts[k] > 0 && k * log_q > max)
+            max = k * log_q;
+    }
+    double total = 0, expected = 0;
+    for (int k = 0; k <= c->var_count; ++k)
+    {
+        weights[k] = c->counts[k] > 0 ? exp(k * log_q - max) : 0;
+        total += c->counts[k] * weights[k];
+        expected += c->counts[k] * weights[k] * k;
+    }
+    return expected / total;
+}
+
+/*
+ * De benadering voor grote speelvelden: met een grote binnenkant met dichtheid d kost elke extra mijn in een deel
+ * ongeveer een factor d / (1 - d), onafhankelijk van de andere delen. We zoeken de d waarbij de verwachte mijnen
+ * in de delen en in de binnenkant samen precies de resterende mijnen geven.
+ */
+static void combine_independent(ProbabilityEngine *engine, ProbabilityComponent **parts, int n, int total_vars,
+                                long interior, long remaining, float *interior_probability)
+{
+    double weights[PROBABILITY_MAX_COMPONENT_VARS + 1];
+    double density = (double)remaining / (double)(interior + total_vars);
+    double log_q = 0;
+    if (interior > 0)
+    {
+        for (int iteration = 0; iteration < 64; ++iteration)
+        {
+            if (density < 1e-9)
+                density = 1e-9;
+            if (density > 1 - 1e-9)
+                density = 1 - 1e-9;
+            log_q = log(density / (1 - density));
+            double expected = 0;
+            for (int i = 0; i < n; ++i)
+                expected += component_weights(parts[i], log_q, weights);
+            double next = ((double)remaining - expected) / (double)interior;
+            if (next < 1e-9)
+                next = 1e-9;
+            if (next > 1 - 1e-9)
+                next = 1 - 1e-9;
+            if (fabs(next - density) < 1e-9)
+                break;
+            // Gedempt, want de verwachte mijnen in de delen reageren zelf op de dichtheid.
+            density = (density + next) / 2;
+        }
+    }
+    for (int i = 0; i < n; ++i)
+    {
+        const ProbabilityComponent *c = parts[i];
+        component_weights(c, log_q, weights);
+        double total = 0;
+        for (int k = 0; k <= c->var_count; ++k)
+            total += c->counts[k] * weights[k];
+        size_t stride = (size_t)c->var_count + 1;
+        for (int v = 0; v < c->var_count; ++v)
+        {
+            double sum = 0;
+            for (int k = 0; k <= c->var_count; ++k)
+                sum += c->var_mines[(size_t)v * stride + (size_t)k] * weights[k];
+            engine->probability[c->key[2 + v]] = (float)(sum / total);
+        }
+    }
+    *interior_probability = interior > 0 ? (float)density : 0.0f;
+}
+
+/*
+ * Berekent engine->probability opnieuw voor de huidige toestand van het spel.
+ * Enkel de delen van de frontier die veranderd zijn sinds de vorige oproep worden opnieuw geteld (zie engine->reused).
+ * Geeft -1 terug als het geheugen opraakt.
+ */
+int probability_update(ProbabilityEngine *engine, const Game *game)
+{
+    const Board *b = &game->board;
+    size_t cells = map_cell_count(b);
+    if (ensure_capacity(engine, cells) != 0)
+        return -1;
+    engine->reused = 0;
+    engine->computed = 0;
+    float *probability = engine->probability;
+    if (!game->mines_placed)
+    {
+        // Vóór de eerste klik weet de speler niets: elke cell heeft dezelfde kans.
+        float p = cells > 0 ? (float)b->mines / (float)cells : 0.0f;
+        for (size_t i = 0; i < cells; ++i)
+            probability[i] = p;
+        return 0;
+    }
+
+    Solver *solver = &engine->solver;
+    if (solver_step(solver, game) != 0 || build_components(engine) != 0)
+        return -1;
+
+    Cell uncovered_bit = game->show_all ? CELL_SAVED_UNCOVERED : CELL_UNCOVERED;
+    for (size_t i = 0; i < cells; ++i)
+    {
+        if (cell_has(b->cells[i], uncovered_bit))
+            probability[i] = PROBABILITY_NONE;
+        else if (solver->known[i] == SOLVER_SAFE)
+            probability[i] = 0.0f;
+        else if (solver->known[i] == SOLVER_MINE)
+            probability[i] = 1.0f;
+        else
+            probability[i] = PROBABILITY_INTERIOR;
+    }
+
+    // De exact getelde delen; de cellen van de andere delen blijven bij de binnenkant.
+    ProbabilityComponent **parts = (ProbabilityComponent **)malloc((engine->component_count + 1) * sizeof(ProbabilityComponent *));
+    if (!parts)
+        return -1;
+    int n = 0, total_vars = 0;
+    for (size_t i = 0; i < engine->component_count; ++i)
+    {
+        ProbabilityComponent *c = &engine->components[i];
+        if (!c->exact)
+            continue;
+        parts[n++] = c;
+        total_vars += c->var_count;
+        for (int v = 0; v < c->var_count; ++v)
+            probability[c->key[2 + v]] = 0.0f;
+    }
+    long interior = 0;
+    for (size_t i = 0; i < cells; ++i)
+        interior += probability[i] == PROBABILITY_INTERIOR;
+    long remaining = (long)b->mines - (long)solver->mine_count;
+    if (remaining < 0)
+        remaining = 0;
+
+    float interior_probability = 0.0f;
+    bool exact = (size_t)(n + 1) * (size_t)(total_vars + 1) <= PROBABILITY_EXACT_LIMIT &&
+                 combine_exact(engine, parts, n, total_vars, interior, remaining, &interior_probability);
+    if (!exact)
+        combine_independent(engine, parts, n, total_vars, interior, remaining, &interior_probability);
+    free(parts);
+
+    if (interior_probability < 0.0f)
+        interior_probability = 0.0f;
+    if (interior_probability > 1.0f)
+        interior_probability = 1.0f;
+    for (size_t i = 0; i < cells; ++i)
+    {
+        if (probability[i] == PROBABILITY_INTERIOR)
+            probability[i] = interior_probability;
+    }
+    return 0;
+}
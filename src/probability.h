@@ -0,0 +1,72 @@
+#ifndef MINESWEEPER_PROBABILITY_H
+#define MINESWEEPER_PROBABILITY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "game.h"
+#include "solver.h"
+
+/*
+ * Berekent voor elke covered cell de kans dat er een mijn ligt, met enkel wat de speler ziet (zoals de solver).
+ * - Eerst bepaalt de solver de zekere cellen (kans 0 of 1).
+ * - De rest van de frontier wordt opgesplitst in onafhankelijke delen (geen gemeenschappelijk getal).
+ *   Per deel tellen we de oplossingen per aantal mijnen k, en per variabele hoeveel daarvan er een mijn op hebben.
+ *   Die delen worden parallel berekend (parallel_for_dynamic, de grootste eerst).
+ * - De cellen zonder getal in de buurt (de "binnenkant") zijn allemaal gelijk: een deel met k mijnen laat
+ *   C(binnenkant, resterende mijnen - k) mogelijkheden over. Zo wegen we de delen met het globale aantal mijnen.
+ * De resultaten per deel worden bewaard: na een zet worden enkel de delen die veranderd zijn opnieuw opgesomd.
+ */
+
+// Een deel met meer variabelen dan dit wordt niet opgesomd; zijn cellen tellen dan mee als binnenkant (een benadering).
+#define PROBABILITY_MAX_COMPONENT_VARS 64
+
+// Het maximum aantal knopen in de zoekboom per deel; daarboven is het deel ook een benadering.
+#define PROBABILITY_NODE_BUDGET 2000000
+
+/*
+ * Het exacte combineren van de delen kost (delen + 1) * (variabelen + 1) doubles.
+ * Daarboven nemen we aan dat de binnenkant zo groot is dat de delen onafhankelijk zijn, met dezelfde dichtheid als de binnenkant.
+ */
+#define PROBABILITY_EXACT_LIMIT (1 << 22)
+
+// De kans van een cell die uncovered is (daar is geen kans).
+#define PROBABILITY_NONE (-1.0f)
+
+// 1 onafhankelijk deel van de frontier, met zijn opgesomde oplossingen.
+typedef struct
+{
+    /*
+     * De sleutel beschrijft het deel volledig: [variabelen, constraints, cellen van de variabelen...,
+     * dan per constraint: mijnen, n, n lokale indices van variabelen]. Dezelfde sleutel geeft dus dezelfde oplossingen.
+     */
+    int *key;
+    size_t key_length;
+    uint64_t hash;
+    int var_count;
+    bool exact;        // false als het deel te groot was, of als het budget of het geheugen opraakte
+    double *counts;    // [k]: het aantal oplossingen met k mijnen, k = 0..var_count
+    double *var_mines; // [v * (var_count + 1) + k]: het aantal oplossingen met k mijnen en een mijn op variabele v
+} ProbabilityComponent;
+
+typedef struct
+{
+    Solver solver;
+    int threads;         // het aantal threads voor het opsommen (0 = 1 per core)
+    size_t capacity;     // het aantal cellen waarvoor de buffers gealloceerd zijn
+    float *probability;  // per cell: de kans op een mijn, of PROBABILITY_NONE als de cell uncovered is
+    int *var_of;         // per cell: de index als variabele, of -1 (enkel tijdens probability_update)
+    double *log_factorial; // het gememoriseerde log(n!) voor n = 0..capacity
+    ProbabilityComponent *components;
+    size_t component_count;
+
+    // Statistieken van de laatste probability_update.
+    size_t reused;   // delen die ongewijzigd waren
+    size_t computed; // delen die opnieuw opgesomd werden
+} ProbabilityEngine;
+
+void probability_init(ProbabilityEngine *engine);
+void probability_free(ProbabilityEngine *engine);
+int probability_update(ProbabilityEngine *engine, const Game *game);
+
+#endif // MINESWEEPER_PROBABILITY_H
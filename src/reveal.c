@@ -0,0 +1,200 @@
+#include <stdlib.h>
+#include <string.h>
+#include "reveal.h"
+
+// De begincapaciteit van de worklist (in seeds).
+#define REVEAL_INITIAL_CAPACITY 1024
+
+void reveal_init(RevealEngine *engine)
+{
+    memset(engine, 0, sizeof(*engine));
+}
+
+// Dealloceert de worklist en de visited bitset.
+void reveal_free(RevealEngine *engine)
+{
+    free(engine->seeds);
+    free(engine->visited);
+    reveal_init(engine);
+}
+
+static inline bool visited_test_and_set(RevealEngine *engine, size_t i)
+{
+    uint64_t bit = (uint64_t)1 << (i & 63);
+    uint64_t *word = &engine->visited[i >> 6];
+    bool was_set = (*word & bit) != 0;
+    *word |= bit;
+    return was_set;
+}
+
+static inline void visited_clear(RevealEngine *engine, size_t i)
+{
+    engine->visited[i >> 6] &= ~((uint64_t)1 << (i & 63));
+}
+
+// Voegt een seed toe aan de worklist; de worklist groeit indien nodig (verdubbeling).
+static bool push_seed(RevealEngine *engine, int x, int y)
+{
+    if (engine->count == engine->capacity)
+    {
+        size_t capacity = engine->capacity ? engine->capacity * 2 : REVEAL_INITIAL_CAPACITY;
+        RevealSeed *seeds = (RevealSeed *)realloc(engine->seeds, capacity * sizeof(RevealSeed));
+        if (!seeds)
+            return false;
+        engine->seeds = seeds;
+        engine->capacity = capacity;
+    }
+    engine->seeds[engine->count].x = x;
+    engine->seeds[engine->count].y = y;
+    engine->count++;
+    return true;
+}
+
+/*
+ * De visited bitset wordt pas gealloceerd bij de eerste cascade en blijft daarna geldig voor het hele spel:
+ * elke cell die ooit op de worklist kwam, is op het einde van de cascade uncovered, en uncovered cellen worden nooit opnieuw gepusht.
+ * We moeten de bitset dus nooit wissen tussen 2 cascades.
+ */
+static bool ensure_visited(RevealEngine *engine, const Board *b)
+{
+    size_t words = (map_cell_count(b) + 63) / 64;
+    if (engine->visited && engine->visited_words == words)
+        return true;
+    free(engine->visited);
+    engine->visited = (uint64_t *)calloc(words, sizeof(uint64_t));
+    engine->visited_words = engine->visited ? words : 0;
+    return engine->visited != NULL;
+}
+
+// Een nul-cell die mee in een span opgenomen mag worden: covered en niet gevlagd.
+static inline bool is_open_zero(Cell c)
+{
+    return (c & (CELL_VALUE_MASK | CELL_UNCOVERED | CELL_FLAGGED)) == 0;
+}
+
+/*
+ * Scant de cellen [x0, x1] van rij y (naast een zonet uncovered span).
+ * Nummer-cellen worden meteen uncovered; voor elke aaneengesloten reeks van nul-cellen pushen we 1 seed.
+ */
+static long scan_row(RevealEngine *engine, Board *b, int y, int x0, int x1)
+{
+    long uncovered = 0;
+    Cell *row = &MAP_CELL(b, 0, y);
+    size_t row_start = (size_t)y * (size_t)b->width;
+    bool in_run = false;
+    for (int x = x0; x <= x1; ++x)
+    {
+        Cell c = row[x];
+        if (cell_has(c, CELL_UNCOVERED) || cell_has(c, CELL_FLAGGED))
+        {
+            in_run = false;
+            continue;
+        }
+        if (cell_neighbour_mines(c) != 0)
+        {
+            row[x] |= CELL_UNCOVERED;
+            uncovered++;
+            in_run = false;
+            continue;
+        }
+        /*
+         * Een nul-cell: we pushen enkel het begin van een reeks, en enkel als die cell nog nooit gepusht werd.
+         * Lukt de push niet (geen geheugen), dan wissen we de visited bit weer: de volgende cell van de reeks probeert het opnieuw,
+         * en anders blijft de reeks covered maar kan ze later nog (door een klik of een andere span) gepusht worden.
+         */
+        if (!in_run && !visited_test_and_set(engine, row_start + x) && !push_seed(engine, x, y))
+        {
+            visited_clear(engine, row_start + x);
+            continue;
+        }
+        in_run = true;
+    }
+    return uncovered;
+}
+
+/*
+ * Neemt de span van de seed op: we breiden eerst naar links en rechts uit over alle nul-cellen in dezelfde rij,
+ * daarna worden de randcellen van de span en de rijen erboven en eronder (inclusief de diagonalen) gescand.
+ * De aangeklikte cell (first) wordt altijd opgenomen, ook als ze gevlagd is. Geeft het aantal nieuw uncovered cellen terug.
+ */
+static long expand_seed(RevealEngine *engine, Board *b, RevealSeed seed, bool first, DirtyList *dirty)
+{
+    Cell *row = &MAP_CELL(b, 0, seed.y);
+    // Deze seed werd intussen al mee opgenomen in een andere span.
+    if (cell_has(row[seed.x], CELL_UNCOVERED))
+        return 0;
+    if (!first && !is_open_zero(row[seed.x]))
+        return 0;
+
+    int left = seed.x, right = seed.x;
+    while (left > 0 && is_open_zero(row[left - 1]))
+        left--;
+    while (right < b->width - 1 && is_open_zero(row[right + 1]))
+        right++;
+    for (int i = left; i <= right; ++i)
+        row[i] |= CELL_UNCOVERED;
+    long uncovered = right - left + 1;
+
+    // De randcellen links en rechts, en de rijen erboven en eronder.
+    int x0 = left > 0 ? left - 1 : left;
+    int x1 = right < b->width - 1 ? right + 1 : right;
+    uncovered += scan_row(engine, b, seed.y, x0, x1);
+    dirty_add(dirty, seed.y, x0, x1);
+    if (seed.y > 0)
+    {
+        uncovered += scan_row(engine, b, seed.y - 1, x0, x1);
+        dirty_add(dirty, seed.y - 1, x0, x1);
+    }
+    if (seed.y < b->height - 1)
+    {
+        uncovered += scan_row(engine, b, seed.y + 1, x0, x1);
+        dirty_add(dirty, seed.y + 1, x0, x1);
+    }
+    return uncovered;
+}
+
+/*
+ * Wanneer een nul-cell (zonder aangrenzende mijnen) wordt aangeklikt, worden de naburige cellen ook automatisch ontdekt.
+ * reveal_begin neemt meteen de span van de aangeklikte cell op en zet de nieuwe seeds op de worklist;
+ * reveal_continue werkt de worklist daarna af, in 1 keer of in stukken (zodat de GUI tussendoor kan tekenen).
+ * Een nieuwe klik terwijl de worklist nog niet leeg is, komt gewoon mee op dezelfde worklist.
+ * De functies geven het aantal nieuw uncovered cellen terug (dit zijn nooit mijnen).
+ * De gescande rijen worden als spans aan de dirty list toegevoegd (mag NULL zijn).
+ */
+long reveal_begin(RevealEngine *engine, Board *b, int x, int y, DirtyList *dirty)
+{
+    if (!map_in_bounds(b, x, y) || cell_has(MAP_CELL(b, x, y), CELL_UNCOVERED))
+        return 0;
+    if (!ensure_visited(engine, b))
+        return 0;
+    visited_test_and_set(engine, (size_t)y * (size_t)b->width + (size_t)x);
+    RevealSeed seed = {x, y};
+    return expand_seed(engine, b, seed, true, dirty);
+}
+
+// Werkt hoogstens budget seeds van de worklist af (alle seeds als budget < 0).
+long reveal_continue(RevealEngine *engine, Board *b, long budget, DirtyList *dirty)
+{
+    long uncovered = 0;
+    for (; engine->count > 0 && budget != 0; --budget)
+        uncovered += expand_seed(engine, b, engine->seeds[--engine->count], false, dirty);
+    return uncovered;
+}
+
+/*
+ * Gooit de worklist weg en wist de visited bitset: bij game over (de cellen op de worklist worden nu nooit uncovered,
+ * dus de bitset klopt niet meer) en voor een nieuw spel op hetzelfde speelveld (zie game_reset).
+ */
+void reveal_reset(RevealEngine *engine)
+{
+    engine->count = 0;
+    if (engine->visited)
+        memset(engine->visited, 0, engine->visited_words * sizeof(uint64_t));
+}
+
+// De volledige cascade vanaf (x, y) in 1 keer.
+long reveal_cascade(RevealEngine *engine, Board *b, int x, int y, DirtyList *dirty)
+{
+    long uncovered = reveal_begin(engine, b, x, y, dirty);
+    return uncovered + reveal_continue(engine, b, -1, dirty);
+}
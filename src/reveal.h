@@ -0,0 +1,47 @@
+#ifndef MINESWEEPER_REVEAL_H
+#define MINESWEEPER_REVEAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "map.h"
+#include "dirty.h"
+
+// Een startpunt (seed) op de worklist van de flood fill.
+typedef struct
+{
+    int x;
+    int y;
+} RevealSeed;
+
+/*
+ * De reveal engine voert de cascade uit wanneer een nul-cell wordt aangeklikt.
+ * We gebruiken een scanline flood fill: per seed wordt een volledige horizontale span van nul-cellen in 1 keer uncovered,
+ * waarna enkel de rij erboven en eronder gescand wordt voor nieuwe seeds.
+ * De worklist staat op de heap en wordt hergebruikt tussen cascades.
+ * De visited bitset (1 bit per cell) zorgt ervoor dat een cell nooit 2 keer op de worklist komt.
+ * De worklist blijft bestaan tussen aanroepen van reveal_continue, zodat een grote cascade over meerdere frames verdeeld kan worden.
+ */
+typedef struct
+{
+    RevealSeed *seeds;
+    size_t count;
+    size_t capacity;
+    uint64_t *visited;
+    size_t visited_words;
+} RevealEngine;
+
+void reveal_init(RevealEngine *engine);
+void reveal_free(RevealEngine *engine);
+long reveal_begin(RevealEngine *engine, Board *b, int x, int y, DirtyList *dirty);
+long reveal_continue(RevealEngine *engine, Board *b, long budget, DirtyList *dirty);
+void reveal_reset(RevealEngine *engine);
+long reveal_cascade(RevealEngine *engine, Board *b, int x, int y, DirtyList *dirty);
+
+// Of er nog een cascade bezig is (seeds op de worklist).
+static inline bool reveal_pending(const RevealEngine *engine)
+{
+    return engine->count > 0;
+}
+
+#endif // MINESWEEPER_REVEAL_H
@@ -0,0 +1,125 @@
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include "rng.h"
+
+// splitmix64: verspreidt de bits van x, om de toestand van xoshiro op te vullen vanuit 1 seed van 64 bits.
+static uint64_t splitmix64(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Initialiseert de generator met seed. Elke seed (ook 0) geeft een geldige toestand.
+void rng_seed(Rng *rng, uint64_t seed)
+{
+    for (int i = 0; i < 4; ++i)
+        rng->s[i] = splitmix64(&seed);
+}
+
+/*
+ * Initialiseert een onafhankelijke deelstroom stream van seed (bv. 1 per band van het speelveld).
+ * De toestand hangt enkel af van (seed, stream), niet van de volgorde waarin de stromen gebruikt worden.
+ */
+void rng_seed_stream(Rng *rng, uint64_t seed, uint64_t stream)
+{
+    uint64_t x = stream;
+    rng_seed(rng, seed ^ splitmix64(&x));
+}
+
+/*
+ * Een seed voor een nieuw spel wanneer de speler er geen opgeeft.
+ * time(NULL) alleen verandert maar 1 keer per seconde (2 spellen in dezelfde seconde waren vroeger identiek),
+ * dus mengen we er ook clock(), een adres op de stack en een teller bij.
+ * De teller wordt atomair verhoogd, want de threads van de simulatie maken elk hun eigen spel aan.
+ */
+uint64_t rng_random_seed()
+{
+    static volatile long long counter = 0;
+    int local = 0;
+#ifdef _WIN32
+    uint64_t n = (uint64_t)InterlockedIncrement64(&counter);
+#else
+    uint64_t n = (uint64_t)__atomic_add_fetch(&counter, 1, __ATOMIC_RELAXED);
+#endif
+    uint64_t x = (uint64_t)time(NULL) ^ ((uint64_t)clock() << 32) ^ (uint64_t)(uintptr_t)&local ^ n;
+    return splitmix64(&x);
+}
+
+// De verhouding p(k + 1) / p(k) = (good - k)(draws - k) / ((k + 1)(bad - draws + k + 1)) van de hypergeometrische verdeling.
+static inline double ratio_up(double g, double b, double d, double k)
+{
+    return (g - k) * (d - k) / ((k + 1) * (b - d + k + 1));
+}
+
+// De verhouding p(k - 1) / p(k) = k(bad - draws + k) / ((good - k + 1)(draws - k + 1)).
+static inline double ratio_down(double g, double b, double d, double k)
+{
+    return k * (b - d + k) / ((g - k + 1) * (d - k + 1));
+}
+
+/*
+ * Trekt uit de hypergeometrische verdeling: het aantal "goede" elementen bij draws trekkingen zonder teruglegging
+ * uit total elementen, waarvan er good goed zijn. (Bv. hoeveel van de mijnen er in een band van good cellen vallen.)
+ * We inverteren de verdeling vanaf de modus en lopen afwisselend naar boven en naar beneden,
+ * met de verhouding tussen opeenvolgende kansen; dat kost gemiddeld O(standaardafwijking) stappen.
+ * De kansen zijn relatief tegenover die van de modus (= 1); hun som berekenen we eerst met dezelfde verhoudingen.
+ * Zo gebruiken we enkel +, *, / en geen lgamma of exp: lgamma schrijft de globale signgam (een data race als meerdere
+ * threads tegelijk mijnen plaatsen), en de afronding ervan verschilt per platform, terwijl een seed overal hetzelfde speelveld moet geven.
+ */
+uint64_t rng_hypergeometric(Rng *rng, uint64_t total, uint64_t good, uint64_t draws)
+{
+    uint64_t bad = total - good;
+    uint64_t lo = draws > bad ? draws - bad : 0, hi = draws < good ? draws : good;
+    if (lo == hi)
+        return lo;
+
+    uint64_t mode = (uint64_t)(((double)draws + 1) * ((double)good + 1) / ((double)total + 2));
+    if (mode < lo)
+        mode = lo;
+    if (mode > hi)
+        mode = hi;
+    double g = (double)good, b = (double)bad, d = (double)draws;
+
+    // De som van de relatieve kansen, aan beide kanten van de modus tot de termen verwaarloosbaar zijn (< 2^-60 van de som).
+    double sum = 1, p = 1;
+    for (uint64_t k = mode; k < hi && p >= sum * 0x1p-60; ++k)
+    {
+        p *= ratio_up(g, b, d, (double)k);
+        sum += p;
+    }
+    p = 1;
+    for (uint64_t k = mode; k > lo && p >= sum * 0x1p-60; --k)
+    {
+        p *= ratio_down(g, b, d, (double)k);
+        sum += p;
+    }
+
+    double u = rng_uniform(rng) * sum - 1;
+    uint64_t up = mode, down = mode;
+    double p_up = 1, p_down = 1;
+    while (u > 0 && (up < hi || down > lo))
+    {
+        if (up < hi)
+        {
+            p_up *= ratio_up(g, b, d, (double)up);
+            up++;
+            u -= p_up;
+            if (u <= 0)
+                return up;
+        }
+        if (down > lo)
+        {
+            p_down *= ratio_down(g, b, d, (double)down);
+            down--;
+            u -= p_down;
+            if (u <= 0)
+                return down;
+        }
+    }
+    // Enkel door afrondingsfouten kan u hier nog positief zijn; de modus is dan de beste keuze.
+    return mode;
+}
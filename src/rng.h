@@ -0,0 +1,78 @@
+#ifndef MINESWEEPER_RNG_H
+#define MINESWEEPER_RNG_H
+
+#include <stdint.h>
+
+/*
+ * Een snelle, seedbare random number generator (xoshiro256**).
+ * In tegenstelling tot rand() is de toestand expliciet: dezelfde seed geeft op elk platform dezelfde reeks,
+ * zodat een speelveld reproduceerbaar is via zijn seed (zie -s).
+ */
+typedef struct
+{
+    uint64_t s[4];
+} Rng;
+
+void rng_seed(Rng *rng, uint64_t seed);
+void rng_seed_stream(Rng *rng, uint64_t seed, uint64_t stream);
+uint64_t rng_random_seed();
+uint64_t rng_hypergeometric(Rng *rng, uint64_t total, uint64_t good, uint64_t draws);
+
+static inline uint64_t rng_rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+// Het volgende getal van 64 bits.
+static inline uint64_t rng_next(Rng *rng)
+{
+    uint64_t *s = rng->s;
+    uint64_t result = rng_rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rng_rotl(s[3], 45);
+    return result;
+}
+
+/*
+ * Een uniform getal in [0, bound) zonder de bias van rng_next() % bound.
+ * We gebruiken de vermenigvuldiging van Lemire: enkel in het zeldzame geval dat het resultaat in de bevooroordeelde
+ * strook valt, trekken we opnieuw (en de deling wordt enkel dan berekend).
+ */
+static inline uint64_t rng_bounded(Rng *rng, uint64_t bound)
+{
+    uint64_t x = rng_next(rng);
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 m = (unsigned __int128)x * bound;
+    uint64_t low = (uint64_t)m;
+    if (low < bound)
+    {
+        uint64_t threshold = (0 - bound) % bound;
+        while (low < threshold)
+        {
+            x = rng_next(rng);
+            m = (unsigned __int128)x * bound;
+            low = (uint64_t)m;
+        }
+    }
+    return (uint64_t)(m >> 64);
+#else
+    // Zonder 128-bit vermenigvuldiging (bv. MSVC): rejection met een modulo.
+    uint64_t threshold = (0 - bound) % bound;
+    while (x < threshold)
+        x = rng_next(rng);
+    return x % bound;
+#endif
+}
+
+// Een uniform kommagetal in [0, 1), uit de bovenste 53 bits.
+static inline double rng_uniform(Rng *rng)
+{
+    return (double)(rng_next(rng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+#endif // MINESWEEPER_RNG_H
@@ -0,0 +1,457 @@
+#include <stdlib.h>
+#include <string.h>
+#include "roaring.h"
+
+#define ROARING_MASK (ROARING_CONTAINER_SIZE - 1)
+
+static inline int popcount64(uint64_t v)
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(v);
+#else
+    int n = 0;
+    for (; v; v &= v - 1)
+        n++;
+    return n;
+#endif
+}
+
+// De index van de laagste gezette bit (v != 0).
+static inline int lowest_bit(uint64_t v)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(v);
+#else
+    int n = 0;
+    for (; !(v & 1); v >>= 1)
+        n++;
+    return n;
+#endif
+}
+
+// De index van de hoogste gezette bit (v != 0).
+static inline int highest_bit(uint64_t v)
+{
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(v);
+#else
+    int n = 63;
+    for (; !(v >> 63); v <<= 1)
+        n--;
+    return n;
+#endif
+}
+
+// Zet de bits [lo, hi] van een bitmap container. Geeft het aantal nieuw gezette bits terug.
+static uint32_t bitmap_set_range(uint64_t *bitmap, uint32_t lo, uint32_t hi)
+{
+    uint32_t added = 0;
+    for (uint32_t w = lo >> 6; w <= hi >> 6; ++w)
+    {
+        uint64_t mask = ~(uint64_t)0;
+        if (w == lo >> 6)
+            mask &= ~(uint64_t)0 << (lo & 63);
+        if (w == hi >> 6)
+            mask &= ~(uint64_t)0 >> (63 - (hi & 63));
+        added += (uint32_t)popcount64(mask & ~bitmap[w]);
+        bitmap[w] |= mask;
+    }
+    return added;
+}
+
+// De eerste run met last >= v (run_count als er geen is).
+static uint32_t run_find(const RoaringContainer *c, uint32_t v)
+{
+    uint32_t lo = 0, hi = c->run_count;
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (c->runs[2 * mid + 1] < v)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static bool run_reserve(RoaringContainer *c, uint32_t runs)
+{
+    if (runs <= c->run_capacity)
+        return true;
+    uint32_t capacity = c->run_capacity ? c->run_capacity * 2 : 4;
+    while (capacity < runs)
+        capacity *= 2;
+    uint16_t *p = (uint16_t *)realloc(c->runs, (size_t)capacity * 2 * sizeof(uint16_t));
+    if (!p)
+        return false;
+    c->runs = p;
+    c->run_capacity = capacity;
+    return true;
+}
+
+// Zet een run container om naar een bitmap container (als er te veel runs zouden zijn).
+static bool to_bitmap(RoaringContainer *c)
+{
+    uint64_t *bitmap = (uint64_t *)calloc(ROARING_BITMAP_WORDS, sizeof(uint64_t));
+    if (!bitmap)
+        return false;
+    for (uint32_t k = 0; k < c->run_count; ++k)
+        bitmap_set_range(bitmap, c->runs[2 * k], c->runs[2 * k + 1]);
+    free(c->runs);
+    c->runs = NULL;
+    c->run_count = 0;
+    c->run_capacity = 0;
+    c->bitmap = bitmap;
+    return true;
+}
+
+// Een volle bitmap container wordt terug 1 run (4 bytes in plaats van 8 KB).
+static void to_full_run(RoaringContainer *c)
+{
+    uint16_t *runs = (uint16_t *)malloc(2 * sizeof(uint16_t));
+    if (!runs)
+        return;
+    runs[0] = 0;
+    runs[1] = ROARING_MASK;
+    free(c->bitmap);
+    c->bitmap = NULL;
+    c->runs = runs;
+    c->run_count = 1;
+    c->run_capacity = 1;
+}
+
+static bool container_contains(const RoaringContainer *c, uint32_t v)
+{
+    if (c->bitmap)
+        return (c->bitmap[v >> 6] >> (v & 63)) & 1;
+    uint32_t k = run_find(c, v);
+    return k < c->run_count && c->runs[2 * k] <= v;
+}
+
+/*
+ * Zet de bits [lo, hi] van een container. De runs die [lo, hi] overlappen of raken, worden samengevoegd tot 1 run.
+ * Geeft het aantal nieuw gezette bits terug, of -1 als er geen geheugen is.
+ */
+static int64_t container_add_range(RoaringContainer *c, uint32_t lo, uint32_t hi)
+{
+    uint32_t added;
+    if (!c->bitmap)
+    {
+        uint32_t i = run_find(c, lo == 0 ? 0 : lo - 1), j = i;
+        uint32_t covered = 0, start = lo, last = hi;
+        while (j < c->run_count && c->runs[2 * j] <= hi + 1)
+        {
+            uint32_t s = c->runs[2 * j], l = c->runs[2 * j + 1];
+            uint32_t a = s > lo ? s : lo, b = l < hi ? l : hi;
+            if (a <= b)
+                covered += b - a + 1;
+            start = s < start ? s : start;
+            last = l > last ? l : last;
+            j++;
+        }
+        uint32_t run_count = c->run_count + 1 - (j - i);
+        if (run_count <= ROARING_MAX_RUNS)
+        {
+            if (!run_reserve(c, run_count))
+                return -1;
+            memmove(&c->runs[2 * (i + 1)], &c->runs[2 * j], (size_t)(c->run_count - j) * 2 * sizeof(uint16_t));
+            c->runs[2 * i] = (uint16_t)start;
+            c->runs[2 * i + 1] = (uint16_t)last;
+            c->run_count = run_count;
+            c->count += hi - lo + 1 - covered;
+            return hi - lo + 1 - covered;
+        }
+        if (!to_bitmap(c))
+            return -1;
+    }
+    added = bitmap_set_range(c->bitmap, lo, hi);
+    c->count += added;
+    if (c->count == ROARING_CONTAINER_SIZE)
+        to_full_run(c);
+    return added;
+}
+
+// Wist bit v van een container. Geeft false terug als de bit niet gezet was (of als er geen geheugen is).
+static bool container_remove(RoaringContainer *c, uint32_t v)
+{
+    if (!c->bitmap)
+    {
+        uint32_t k = run_find(c, v);
+        if (k == c->run_count || c->runs[2 * k] > v)
+            return false;
+        uint32_t s = c->runs[2 * k], l = c->runs[2 * k + 1];
+        if (s == l)
+        {
+            memmove(&c->runs[2 * k], &c->runs[2 * (k + 1)], (size_t)(c->run_count - k - 1) * 2 * sizeof(uint16_t));
+            c->run_count--;
+        }
+        else if (v == s)
+            c->runs[2 * k]++;
+        else if (v == l)
+            c->runs[2 * k + 1]--;
+        else if (c->run_count + 1 <= ROARING_MAX_RUNS)
+        {
+            // De run wordt gesplitst in [s, v - 1] en [v + 1, l].
+            if (!run_reserve(c, c->run_count + 1))
+                return false;
+            memmove(&c->runs[2 * (k + 2)], &c->runs[2 * (k + 1)], (size_t)(c->run_count - k - 1) * 2 * sizeof(uint16_t));
+            c->runs[2 * k + 1] = (uint16_t)(v - 1);
+            c->runs[2 * (k + 1)] = (uint16_t)(v + 1);
+            c->runs[2 * (k + 1) + 1] = (uint16_t)l;
+            c->run_count++;
+        }
+        else if (!to_bitmap(c))
+            return false;
+        if (!c->bitmap)
+        {
+            c->count--;
+            return true;
+        }
+    }
+    if (!((c->bitmap[v >> 6] >> (v & 63)) & 1))
+        return false;
+    c->bitmap[v >> 6] &= ~((uint64_t)1 << (v & 63));
+    c->count--;
+    return true;
+}
+
+// De eerste gezette bit >= v in de container, of -1.
+static int32_t container_next_set(const RoaringContainer *c, uint32_t v)
+{
+    if (!c->bitmap)
+    {
+        uint32_t k = run_find(c, v);
+        if (k == c->run_count)
+            return -1;
+        return c->runs[2 * k] > v ? c->runs[2 * k] : (int32_t)v;
+    }
+    uint32_t w = v >> 6;
+    uint64_t bits = c->bitmap[w] & (~(uint64_t)0 << (v & 63));
+    for (;;)
+    {
+        if (bits)
+            return (int32_t)(w * 64 + (uint32_t)lowest_bit(bits));
+        if (++w == ROARING_BITMAP_WORDS)
+            return -1;
+        bits = c->bitmap[w];
+    }
+}
+
+// De eerste gewiste bit >= v in de container, of -1.
+static int32_t container_next_clear(const RoaringContainer *c, uint32_t v)
+{
+    if (!c->bitmap)
+    {
+        // Runs die elkaar raken, zijn altijd samengevoegd, dus na een run volgt een gewiste bit.
+        uint32_t k = run_find(c, v);
+        if (k == c->run_count || c->runs[2 * k] > v)
+            return (int32_t)v;
+        return c->runs[2 * k + 1] == ROARING_MASK ? -1 : c->runs[2 * k + 1] + 1;
+    }
+    uint32_t w = v >> 6;
+    uint64_t bits = ~c->bitmap[w] & (~(uint64_t)0 << (v & 63));
+    for (;;)
+    {
+        if (bits)
+            return (int32_t)(w * 64 + (uint32_t)lowest_bit(bits));
+        if (++w == ROARING_BITMAP_WORDS)
+            return -1;
+        bits = ~c->bitmap[w];
+    }
+}
+
+// De laatste gezette bit <= v in de container, of -1.
+static int32_t container_prev_set(const RoaringContainer *c, uint32_t v)
+{
+    if (!c->bitmap)
+    {
+        // De eerste run met start > v; de run ervoor is de kandidaat.
+        uint32_t lo = 0, hi = c->run_count;
+        while (lo < hi)
+        {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (c->runs[2 * mid] <= v)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo == 0)
+            return -1;
+        return c->runs[2 * (lo - 1) + 1] < v ? c->runs[2 * (lo - 1) + 1] : (int32_t)v;
+    }
+    int32_t w = (int32_t)(v >> 6);
+    uint64_t bits = c->bitmap[w] & (~(uint64_t)0 >> (63 - (v & 63)));
+    for (;;)
+    {
+        if (bits)
+            return w * 64 + highest_bit(bits);
+        if (--w < 0)
+            return -1;
+        bits = c->bitmap[w];
+    }
+}
+
+// Initialiseert een lege bitmap voor de indices [0, size). Enkel de tabel met de containers wordt gealloceerd.
+int roaring_init(Roaring *r, uint64_t size)
+{
+    memset(r, 0, sizeof(*r));
+    r->size = size;
+    r->container_count = (size_t)((size + ROARING_CONTAINER_SIZE - 1) >> ROARING_CONTAINER_BITS);
+    r->containers = (RoaringContainer **)calloc(r->container_count ? r->container_count : 1, sizeof(RoaringContainer *));
+    return r->containers ? 0 : -1;
+}
+
+void roaring_free(Roaring *r)
+{
+    for (size_t k = 0; r->containers && k < r->container_count; ++k)
+    {
+        if (!r->containers[k])
+            continue;
+        free(r->containers[k]->runs);
+        free(r->containers[k]->bitmap);
+        free(r->containers[k]);
+    }
+    free(r->containers);
+    memset(r, 0, sizeof(*r));
+}
+
+bool roaring_contains(const Roaring *r, uint64_t i)
+{
+    if (i >= r->size)
+        return false;
+    const RoaringContainer *c = r->containers[i >> ROARING_CONTAINER_BITS];
+    return c && container_contains(c, (uint32_t)(i & ROARING_MASK));
+}
+
+/*
+ * Zet de bits [lo, hi] (hi wordt begrensd tot size - 1).
+ * Geeft het aantal nieuw gezette bits terug, of -1 als er geen geheugen is (de bits tot dan blijven gezet).
+ */
+int64_t roaring_add_range(Roaring *r, uint64_t lo, uint64_t hi)
+{
+    if (hi >= r->size)
+        hi = r->size - 1;
+    if (r->size == 0 || lo > hi)
+        return 0;
+    int64_t total = 0;
+    for (uint64_t key = lo >> ROARING_CONTAINER_BITS; key <= hi >> ROARING_CONTAINER_BITS; ++key)
+    {
+        RoaringContainer *c = r->containers[key];
+        if (!c)
+        {
+            c = (RoaringContainer *)calloc(1, sizeof(RoaringContainer));
+            if (!c)
+                return -1;
+            r->containers[key] = c;
+        }
+        uint32_t a = key == lo >> ROARING_CONTAINER_BITS ? (uint32_t)(lo & ROARING_MASK) : 0;
+        uint32_t b = key == hi >> ROARING_CONTAINER_BITS ? (uint32_t)(hi & ROARING_MASK) : ROARING_MASK;
+        int64_t added = container_add_range(c, a, b);
+        if (added < 0)
+            return -1;
+        r->count += (uint64_t)added;
+        total += added;
+    }
+    return total;
+}
+
+// Wist bit i. Een container die leeg wordt, wordt vrijgegeven. Geeft terug of de bit gezet was.
+bool roaring_remove(Roaring *r, uint64_t i)
+{
+    if (i >= r->size)
+        return false;
+    RoaringContainer **slot = &r->containers[i >> ROARING_CONTAINER_BITS];
+    if (!*slot || !container_remove(*slot, (uint32_t)(i & ROARING_MASK)))
+        return false;
+    r->count--;
+    if ((*slot)->count == 0)
+    {
+        free((*slot)->runs);
+        free((*slot)->bitmap);
+        free(*slot);
+        *slot = NULL;
+    }
+    return true;
+}
+
+// De eerste gezette bit in [i, hi], of -1. Lege containers worden overgeslagen zonder ze te bekijken.
+int64_t roaring_next_set(const Roaring *r, uint64_t i, uint64_t hi)
+{
+    if (hi >= r->size)
+        hi = r->size - 1;
+    if (r->size == 0 || i > hi)
+        return -1;
+    for (uint64_t key = i >> ROARING_CONTAINER_BITS; key <= hi >> ROARING_CONTAINER_BITS; ++key)
+    {
+        const RoaringContainer *c = r->containers[key];
+        if (!c)
+            continue;
+        int32_t v = container_next_set(c, key == i >> ROARING_CONTAINER_BITS ? (uint32_t)(i & ROARING_MASK) : 0);
+        if (v >= 0)
+        {
+            uint64_t pos = (key << ROARING_CONTAINER_BITS) | (uint64_t)v;
+            return pos <= hi ? (int64_t)pos : -1;
+        }
+    }
+    return -1;
+}
+
+// De eerste gewiste bit in [i, hi], of -1.
+int64_t roaring_next_clear(const Roaring *r, uint64_t i, uint64_t hi)
+{
+    if (hi >= r->size)
+        hi = r->size - 1;
+    if (r->size == 0 || i > hi)
+        return -1;
+    for (uint64_t key = i >> ROARING_CONTAINER_BITS; key <= hi >> ROARING_CONTAINER_BITS; ++key)
+    {
+        const RoaringContainer *c = r->containers[key];
+        uint32_t from = key == i >> ROARING_CONTAINER_BITS ? (uint32_t)(i & ROARING_MASK) : 0;
+        int32_t v = c ? container_next_clear(c, from) : (int32_t)from;
+        if (v >= 0)
+        {
+            uint64_t pos = (key << ROARING_CONTAINER_BITS) | (uint64_t)v;
+            return pos <= hi ? (int64_t)pos : -1;
+        }
+    }
+    return -1;
+}
+
+// De laatste gezette bit in [lo, i], of -1.
+int64_t roaring_prev_set(const Roaring *r, uint64_t i, uint64_t lo)
+{
+    if (r->size == 0)
+        return -1;
+    if (i >= r->size)
+        i = r->size - 1;
+    if (i < lo)
+        return -1;
+    for (int64_t key = (int64_t)(i >> ROARING_CONTAINER_BITS); key >= (int64_t)(lo >> ROARING_CONTAINER_BITS); --key)
+    {
+        const RoaringContainer *c = r->containers[key];
+        if (!c)
+            continue;
+        int32_t v = container_prev_set(c, (uint64_t)key == i >> ROARING_CONTAINER_BITS ? (uint32_t)(i & ROARING_MASK) : ROARING_MASK);
+        if (v >= 0)
+        {
+            uint64_t pos = ((uint64_t)key << ROARING_CONTAINER_BITS) | (uint64_t)v;
+            return pos >= lo ? (int64_t)pos : -1;
+        }
+    }
+    return -1;
+}
+
+// Het geheugen dat de bitmap gebruikt, in bytes (voor de benchmarks en de statistieken).
+size_t roaring_memory(const Roaring *r)
+{
+    size_t bytes = r->container_count * sizeof(RoaringContainer *);
+    for (size_t k = 0; k < r->container_count; ++k)
+    {
+        const RoaringContainer *c = r->containers[k];
+        if (!c)
+            continue;
+        bytes += sizeof(RoaringContainer);
+        bytes += c->bitmap ? ROARING_BITMAP_WORDS * sizeof(uint64_t) : (size_t)c->run_capacity * 2 * sizeof(uint16_t);
+    }
+    return bytes;
+}
@@ -0,0 +1,47 @@
+#ifndef MINESWEEPER_ROARING_H
+#define MINESWEEPER_ROARING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Een gecomprimeerde bitmap (naar het voorbeeld van roaring bitmaps) over de indices [0, size).
+ * De indices worden verdeeld in containers van 65536 op hun bovenste bits; een lege container kost enkel een NULL pointer.
+ * Een container is ofwel een gesorteerde lijst van runs [start, last] (4 bytes per run), ofwel een gewone bitmap van 8 KB
+ * als er meer dan ROARING_MAX_RUNS runs zouden zijn. Een volle container is zo 1 run.
+ * Voor de toestanden van een speelveld (grote aaneengesloten gebieden uncovered) blijft de bitmap daardoor zeer klein.
+ */
+#define ROARING_CONTAINER_BITS 16
+#define ROARING_CONTAINER_SIZE (1u << ROARING_CONTAINER_BITS)
+#define ROARING_BITMAP_WORDS (ROARING_CONTAINER_SIZE / 64)
+#define ROARING_MAX_RUNS (ROARING_BITMAP_WORDS * 2)
+
+typedef struct
+{
+    uint32_t count;        // het aantal gezette bits
+    uint32_t run_count;    // het aantal runs (zonder bitmap)
+    uint32_t run_capacity;
+    uint16_t *runs;        // run k is [runs[2k], runs[2k + 1]]
+    uint64_t *bitmap;      // ROARING_BITMAP_WORDS woorden, of NULL voor een run container
+} RoaringContainer;
+
+typedef struct
+{
+    uint64_t size;
+    size_t container_count;
+    RoaringContainer **containers;
+    uint64_t count; // het totaal aantal gezette bits
+} Roaring;
+
+int roaring_init(Roaring *r, uint64_t size);
+void roaring_free(Roaring *r);
+bool roaring_contains(const Roaring *r, uint64_t i);
+int64_t roaring_add_range(Roaring *r, uint64_t lo, uint64_t hi);
+bool roaring_remove(Roaring *r, uint64_t i);
+int64_t roaring_next_set(const Roaring *r, uint64_t i, uint64_t hi);
+int64_t roaring_next_clear(const Roaring *r, uint64_t i, uint64_t hi);
+int64_t roaring_prev_set(const Roaring *r, uint64_t i, uint64_t lo);
+size_t roaring_memory(const Roaring *r);
+
+#endif // MINESWEEPER_ROARING_H
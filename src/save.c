@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+#include "save.h"
+#include "files.h"
+
+void save_job_init(SaveJob *job)
+{
+    memset(job, 0, sizeof(*job));
+}
+
+void save_job_free(SaveJob *job)
+{
+    free(job->snapshot.cells);
+    save_job_init(job);
+}
+
+static const char *save_extension(SaveFormat format)
+{
+    return format == SAVE_BINARY ? "msb" : "txt";
+}
+
+// Als name van de vorm <prefix><nummer>.<extensie> is, houden we het hoogste nummer bij in *highest.
+static void match_save_name(const char *name, const char *prefix, const char *extension, int *highest)
+{
+    size_t prefix_len = strlen(prefix);
+    if (strncmp(name, prefix, prefix_len) != 0)
+        return;
+    char *end = NULL;
+    long n = strtol(name + prefix_len, &end, 10);
+    if (end == name + prefix_len || *end != '.' || strcmp(end + 1, extension) != 0)
+        return;
+    if (n > *highest && n < 0x7FFFFFFF)
+        *highest = (int)n;
+}
+
+/*
+ * Bepaalt de volgende vrije bestandsnaam field_<w>x<h>_<n>.<ext> met 1 scan van de huidige map:
+ * n is 1 meer dan het hoogste nummer dat al bestaat voor deze afmetingen en dit formaat.
+ * Vroeger probeerden we elke n met fopen, wat steeds trager werd naarmate er meer saves waren.
+ */
+int save_next_filename(int w, int h, SaveFormat format, char *out_filename, size_t size)
+{
+    const char *extension = save_extension(format);
+    char prefix[64];
+    snprintf(prefix, sizeof(prefix), "field_%dx%d_", w, h);
+    int highest = 0;
+
+#ifdef _WIN32
+    char pattern[80];
+    snprintf(pattern, sizeof(pattern), "%s*.%s", prefix, extension);
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA(pattern, &entry);
+    if (find != INVALID_HANDLE_VALUE)
+    {
+        do
+            match_save_name(entry.cFileName, prefix, extension, &highest);
+        while (FindNextFileA(find, &entry));
+        FindClose(find);
+    }
+#else
+    DIR *dir = opendir(".");
+    if (dir)
+    {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL)
+            match_save_name(entry->d_name, prefix, extension, &highest);
+        closedir(dir);
+    }
+#endif
+
+    if (snprintf(out_filename, size, "%s%d.%s", prefix, highest + 1, extension) >= (int)size)
+        return -1;
+    return 0;
+}
+
+/*
+ * Neemt een momentopname van het spel voor een save: de cellen worden gekopieerd (1 memcpy) en de bestandsnaam wordt gekozen.
+ * Na deze functie kan het spel verder gespeeld worden terwijl save_job_run de momentopname wegschrijft.
+ */
+int save_job_prepare(SaveJob *job, const Game *game)
+{
+    const Board *b = &game->board;
+    size_t cells = map_cell_count(b);
+    if (cells > job->capacity)
+    {
+        Cell *grown = (Cell *)realloc(job->snapshot.cells, cells * sizeof(Cell));
+        if (!grown)
+            return -1;
+        job->snapshot.cells = grown;
+        job->capacity = cells;
+    }
+    memcpy(job->snapshot.cells, b->cells, cells * sizeof(Cell));
+    job->snapshot.width = b->width;
+    job->snapshot.height = b->height;
+    job->snapshot.mines = b->mines;
+    job->format = game->save_format;
+    job->durable = game->durable_save;
+    job->seed = game->seed;
+    return save_next_filename(b->width, b->height, job->format, job->filename, sizeof(job->filename));
+}
+
+// Schrijft de momentopname weg in het gekozen formaat. Deze functie mag op een andere thread lopen dan het spel.
+int save_job_run(const SaveJob *job)
+{
+    if (job->format == SAVE_BINARY)
+        return save_field_binary(job->filename, &job->snapshot, job->seed, job->durable);
+    return save_field(job->filename, &job->snapshot, job->durable);
+}
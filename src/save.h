@@ -0,0 +1,30 @@
+#ifndef MINESWEEPER_SAVE_H
+#define MINESWEEPER_SAVE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "game.h"
+
+/*
+ * Een save job: een momentopname van het speelveld die los van het spel weggeschreven kan worden (bv. op een achtergrondthread).
+ * save_job_prepare kopieert de cellen en kiest de bestandsnaam op de thread van het spel; save_job_run schrijft het bestand
+ * en raakt het spel zelf niet meer aan. De buffer van de momentopname wordt hergebruikt tussen opeenvolgende saves.
+ */
+typedef struct
+{
+    Board snapshot;
+    size_t capacity; // de gealloceerde grootte van snapshot.cells
+    SaveFormat format;
+    bool durable;
+    uint64_t seed;
+    char filename[256];
+} SaveJob;
+
+void save_job_init(SaveJob *job);
+void save_job_free(SaveJob *job);
+int save_job_prepare(SaveJob *job, const Game *game);
+int save_job_run(const SaveJob *job);
+int save_next_filename(int w, int h, SaveFormat format, char *out_filename, size_t size);
+
+#endif // MINESWEEPER_SAVE_H
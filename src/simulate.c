@@ -0,0 +1,195 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include "simulate.h"
+#include "bitplane.h"
+#include "game.h"
+#include "parallel.h"
+#include "probability.h"
+#include "rng.h"
+
+// Een monotone klok in seconden, voor de tijd per spel.
+static double now_seconds()
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec / 1e9;
+#endif
+}
+
+// De gedeelde toestand van de simulatie; elke thread schrijft enkel in de plaatsen van zijn eigen spellen.
+typedef struct
+{
+    const SimulationConfig *config;
+    int threads;
+    uint8_t *won;    // per spel: of het gewonnen is
+    long *guesses;   // per spel: het aantal gokken
+    double *times;   // per spel: de tijd in ms
+    double *first_click; // per spel: de tijd van de eerste klik in ms
+    long *attempts;  // per spel: game->generation_attempts
+    uint8_t *failed; // per thread: of die thread zijn spel niet kon alloceren (samengevoegd na de join)
+} Simulation;
+
+// Speelt spel i met de policy, op het spel en de engine van de thread. Geeft het aantal gokken terug.
+static long play_game(Game *game, ProbabilityEngine *engine, uint64_t seed, long i, double *first_click)
+{
+    Rng rng;
+    rng_seed_stream(&rng, seed, (uint64_t)i);
+    game_reset(game, rng_next(&rng));
+
+    Board *b = &game->board;
+    size_t cells = map_cell_count(b);
+    double start = now_seconds();
+    game_reveal(game, b->width / 2, b->height / 2);
+    *first_click = (now_seconds() - start) * 1000.0;
+    long guesses = 0;
+    while (game_status(game) == GAME_PLAYING)
+    {
+        // Eerst de (goedkopere) solver: zijn er zeker veilige cellen, dan uncoveren we die allemaal.
+        if (solver_step(&engine->solver, game) != 0)
+            break;
+        if (engine->solver.safe_count > 0)
+        {
+            for (size_t s = 0; s < engine->solver.safe_count; ++s)
+            {
+                int c = engine->solver.safe[s];
+                game_reveal(game, c % b->width, c / b->width);
+            }
+            continue;
+        }
+
+        // Anders gokken we de cell met de kleinste kans op een mijn (bij gelijke kans de eerste in het speelveld).
+        if (probability_update(engine, game) != 0)
+            break;
+        size_t best = cells;
+        for (size_t c = 0; c < cells; ++c)
+        {
+            float p = engine->probability[c];
+            if (p >= 0.0f && (best == cells || p < engine->probability[best]))
+                best = c;
+        }
+        if (best == cells)
+            break;
+        // Met het totaal aantal mijnen kan de engine soms nog een zeker veilige cell vinden; dat is geen gok.
+        if (engine->probability[best] > 0.0f)
+            guesses++;
+        game_reveal(game, (int)(best % (size_t)b->width), (int)(best / (size_t)b->width));
+    }
+    return guesses;
+}
+
+// Taak per thread: speelt de spellen thread, thread + threads, ... op 1 spel en 1 engine die hergebruikt worden.
+static void run_thread(void *context, int thread)
+{
+    Simulation *sim = (Simulation *)context;
+    const SimulationConfig *config = sim->config;
+    Game *game = game_new(config->width, config->height, config->mines);
+    ProbabilityEngine engine;
+    probability_init(&engine);
+    engine.threads = 1;
+    if (!game)
+    {
+        sim->failed[thread] = 1;
+        return;
+    }
+    game->threads = 1;
+    game->no_guess = config->no_guess;
+    for (long i = thread; i < config->games; i += sim->threads)
+    {
+        double start = now_seconds();
+        sim->guesses[i] = play_game(game, &engine, config->seed, i, &sim->first_click[i]);
+        sim->attempts[i] = game->generation_attempts;
+        sim->won[i] = game_status(game) == GAME_WON;
+        sim->times[i] = (now_seconds() - start) * 1000.0;
+    }
+    probability_free(&engine);
+    game_free(game);
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Speelt config->games spellen, verdeeld over de threads (elke thread met zijn eigen spel en engine),
+ * en vat ze samen in result. Geeft -1 terug als er geen geheugen is.
+ */
+int simulate(const SimulationConfig *config, SimulationResult *result)
+{
+    // De policy speelt met de solver, die geen speelvelden van meer dan SOLVER_MAX_CELLS cellen aanneemt.
+    if ((size_t)config->width * (size_t)config->height > SOLVER_MAX_CELLS)
+    {
+        fprintf(stderr, "Cannot simulate a board with more than %zu cells\n", SOLVER_MAX_CELLS);
+        return -1;
+    }
+
+    Simulation sim;
+    sim.config = config;
+    sim.threads = config->threads > 0 ? config->threads : parallel_default_threads();
+    if (sim.threads > config->games)
+        sim.threads = config->games > 0 ? (int)config->games : 1;
+    sim.won = (uint8_t *)calloc((size_t)config->games + 1, 1);
+    sim.guesses = (long *)calloc((size_t)config->games + 1, sizeof(long));
+    sim.times = (double *)calloc((size_t)config->games + 1, sizeof(double));
+    sim.first_click = (double *)calloc((size_t)config->games + 1, sizeof(double));
+    sim.attempts = (long *)calloc((size_t)config->games + 1, sizeof(long));
+    sim.failed = (uint8_t *)calloc((size_t)sim.threads, 1);
+    int status = -1;
+    if (!sim.won || !sim.guesses || !sim.times || !sim.first_click || !sim.attempts || !sim.failed)
+        goto done;
+
+    // Elke thread genereert speelvelden; de kernels moeten gekozen zijn vooraleer de threads starten.
+    bitplane_setup();
+    double start = now_seconds();
+    parallel_for(sim.threads, sim.threads, run_thread, &sim);
+    result->seconds = now_seconds() - start;
+    for (int t = 0; t < sim.threads; ++t)
+    {
+        if (sim.failed[t])
+            goto done;
+    }
+
+    result->games = config->games;
+    result->wins = 0;
+    result->guesses = 0;
+    result->threads = sim.threads;
+    result->attempts = 0;
+    result->fallbacks = 0;
+    double first_click = 0;
+    for (long i = 0; i < config->games; ++i)
+    {
+        result->wins += sim.won[i];
+        result->guesses += sim.guesses[i];
+        first_click += sim.first_click[i];
+        if (sim.attempts[i] < 0)
+            result->fallbacks++;
+        else
+            result->attempts += sim.attempts[i];
+    }
+    result->first_click_ms = config->games > 0 ? first_click / (double)config->games : 0;
+    qsort(sim.times, (size_t)config->games, sizeof(double), compare_double);
+    result->p50 = config->games > 0 ? sim.times[(config->games - 1) / 2] : 0;
+    result->p99 = config->games > 0 ? sim.times[(config->games - 1) * 99 / 100] : 0;
+    status = 0;
+
+done:
+    free(sim.won);
+    free(sim.guesses);
+    free(sim.times);
+    free(sim.first_click);
+    free(sim.attempts);
+    free(sim.failed);
+    return status;
+}
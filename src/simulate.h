@@ -0,0 +1,41 @@
+#ifndef MINESWEEPER_SIMULATE_H
+#define MINESWEEPER_SIMULATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Speelt een reeks spellen zonder venster, om een configuratie (-w/-h/-m) statistisch te evalueren (via -n).
+ * De speler klikt eerst in het midden en speelt daarna met de solver: alle zeker veilige cellen uncoveren,
+ * en als er geen zijn, de cell met de kleinste kans op een mijn volgens de probability engine.
+ * Spel i krijgt zijn eigen seed uit stroom i van de seed, dus de resultaten (behalve de tijden) hangen enkel af van de seed,
+ * niet van het aantal threads of de volgorde waarin de spellen gespeeld worden.
+ */
+typedef struct
+{
+    int width;
+    int height;
+    int mines;
+    long games;
+    uint64_t seed;
+    int threads; // 0 = 1 per core
+    bool no_guess; // speel op speelvelden die zonder gokken op te lossen zijn (zie noguess.h)
+} SimulationConfig;
+
+typedef struct
+{
+    long games;
+    long wins;
+    long guesses;    // het aantal keer dat er gegokt moest worden (de eerste klik niet meegerekend)
+    int threads;     // het aantal threads dat effectief gebruikt werd
+    double seconds;  // de totale tijd (wall clock)
+    double p50;      // de mediaan van de tijd per spel, in ms
+    double p99;      // het 99ste percentiel van de tijd per spel, in ms
+    double first_click_ms; // de gemiddelde tijd van de eerste klik (met het genereren van het speelveld), in ms
+    long attempts;   // met no_guess: het totaal aantal kandidaten van de gevonden speelvelden
+    long fallbacks;  // met no_guess: het aantal spellen zonder no-guess speelveld (gewoon speelveld gebruikt)
+} SimulationResult;
+
+int simulate(const SimulationConfig *config, SimulationResult *result);
+
+#endif // MINESWEEPER_SIMULATE_H
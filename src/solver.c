@@ -0,0 +1,519 @@
+#include <stdlib.h>
+#include <string.h>
+#include "solver.h"
+
+void solver_init(Solver *solver)
+{
+    memset(solver, 0, sizeof(*solver));
+}
+
+void solver_free(Solver *solver)
+{
+    free(solver->known);
+    free(solver->constraint_of);
+    free(solver->var_id);
+    free(solver->constraints);
+    free(solver->safe);
+    free(solver->mines);
+    solver_init(solver);
+}
+
+// Zorgt dat de buffers per cell groot genoeg zijn voor cells cellen.
+static int ensure_capacity(Solver *solver, size_t cells)
+{
+    if (cells <= solver->capacity)
+        return 0;
+    solver_free(solver);
+    solver->known = (uint8_t *)malloc(cells);
+    solver->constraint_of = (int *)malloc(cells * sizeof(int));
+    solver->var_id = (int *)malloc(cells * sizeof(int));
+    solver->safe = (int *)malloc(cells * sizeof(int));
+    solver->mines = (int *)malloc(cells * sizeof(int));
+    if (!solver->known || !solver->constraint_of || !solver->var_id || !solver->safe || !solver->mines)
+    {
+        solver_free(solver);
+        return -1;
+    }
+    // var_id staat altijd op -1 buiten een opsomming; de opsomming zet de gebruikte cellen zelf terug.
+    for (size_t i = 0; i < cells; ++i)
+        solver->var_id[i] = -1;
+    solver->capacity = cells;
+    return 0;
+}
+
+static int add_constraint(Solver *solver, const SolverConstraint *constraint)
+{
+    if (solver->constraint_count == solver->constraint_capacity)
+    {
+        size_t capacity = solver->constraint_capacity ? solver->constraint_capacity * 2 : 256;
+        SolverConstraint *grown = (SolverConstraint *)realloc(solver->constraints, capacity * sizeof(SolverConstraint));
+        if (!grown)
+            return -1;
+        solver->constraints = grown;
+        solver->constraint_capacity = capacity;
+    }
+    solver->constraints[solver->constraint_count++] = *constraint;
+    return 0;
+}
+
+/*
+ * De huidige vorm van een constraint: de variabelen die nog onbekend zijn (in out_vars, gesorteerd want vars is gesorteerd)
+ * en het aantal mijnen dat daar nog tussen moet zitten. Geeft het aantal onbekende variabelen terug.
+ */
+int solver_effective(const Solver *solver, const SolverConstraint *c, int *out_vars, int *out_mines)
+{
+    int n = 0, mines = c->count;
+    for (int i = 0; i < c->var_count; ++i)
+    {
+        uint8_t k = solver->known[c->vars[i]];
+        if (k == SOLVER_UNKNOWN)
+            out_vars[n++] = c->vars[i];
+        else if (k == SOLVER_MINE)
+            mines--;
+    }
+    *out_mines = mines;
+    return n;
+}
+
+// Markeert alle n cellen als value; geeft terug of er iets veranderd is.
+static bool mark_all(Solver *solver, const int *vars, int n, uint8_t value)
+{
+    bool changed = false;
+    for (int i = 0; i < n; ++i)
+    {
+        if (solver->known[vars[i]] == SOLVER_UNKNOWN)
+        {
+            solver->known[vars[i]] = value;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+// Of de gesorteerde lijst a (na elementen) een deel is van b; de rest van b komt in diff.
+static bool subset_difference(const int *a, int na, const int *b, int nb, int *diff, int *ndiff)
+{
+    int i = 0, d = 0;
+    for (int j = 0; j < nb; ++j)
+    {
+        if (i < na && a[i] == b[j])
+            i++;
+        else if (i < na && a[i] < b[j])
+            return false;
+        else
+            diff[d++] = b[j];
+    }
+    *ndiff = d;
+    return i == na;
+}
+
+/*
+ * Past de triviale regels en de subset-regels toe tot er niets meer verandert.
+ * Voor de subset-regel vergelijken we elk getal met de getallen in de 5x5 rond zich (enkel die kunnen buren delen).
+ */
+static void propagate(Solver *solver, int width, int height)
+{
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t ci = 0; ci < solver->constraint_count; ++ci)
+        {
+            const SolverConstraint *a = &solver->constraints[ci];
+            int va[8], ka;
+            int na = solver_effective(solver, a, va, &ka);
+            if (na == 0)
+                continue;
+            if (ka == 0)
+            {
+                changed |= mark_all(solver, va, na, SOLVER_SAFE);
+                continue;
+            }
+            if (ka == na)
+            {
+                changed |= mark_all(solver, va, na, SOLVER_MINE);
+                continue;
+            }
+
+            int ax = a->cell % width, ay = a->cell / width;
+            for (int by = ay - 2; by <= ay + 2; ++by)
+            {
+                if (by < 0 || by >= height)
+                    continue;
+                for (int bx = ax - 2; bx <= ax + 2; ++bx)
+                {
+                    if (bx < 0 || bx >= width || (bx == ax && by == ay))
+                        continue;
+                    int bi = solver->constraint_of[(size_t)by * (size_t)width + (size_t)bx];
+                    if (bi < 0)
+                        continue;
+                    int vb[8], kb, diff[8], nd;
+                    int nb = solver_effective(solver, &solver->constraints[bi], vb, &kb);
+                    if (nb <= na || !subset_difference(va, na, vb, nb, diff, &nd))
+                        continue;
+                    // De cellen van A liggen allemaal ook rond B, dus B \ A bevat precies kb - ka mijnen.
+                    if (kb - ka == 0)
+                        changed |= mark_all(solver, diff, nd, SOLVER_SAFE);
+                    else if (kb - ka == nd)
+                        changed |= mark_all(solver, diff, nd, SOLVER_MINE);
+                }
+            }
+        }
+    }
+}
+
+// De toestand van de zoektocht voor 1 samenhangend deel van de frontier.
+typedef struct
+{
+    int var_count;
+    const int *var_offsets;    // per variabele: de constraints waarin ze voorkomt (CSR)
+    const int *var_constraints;
+    int *mines_assigned;       // per constraint: het aantal variabelen die al een mijn zijn
+    int *unassigned;           // per constraint: het aantal variabelen die nog geen waarde hebben
+    const int *needed;         // per constraint: het aantal mijnen dat nog moet
+    uint8_t *assignment;
+    uint8_t *seen_mine;        // per variabele: of ze in een gevonden oplossing een mijn is
+    uint8_t *seen_safe;        // per variabele: of ze in een gevonden oplossing veilig is
+    int8_t *fixed;             // per variabele: de enige toegelaten waarde, of -1
+    long nodes;
+} Enumeration;
+
+// Geeft variabele v de waarde mine; geeft false terug als een constraint daardoor onmogelijk wordt.
+static bool assign(Enumeration *e, int v, int mine)
+{
+    bool ok = true;
+    for (int k = e->var_offsets[v]; k < e->var_offsets[v + 1]; ++k)
+    {
+        int c = e->var_constraints[k];
+        e->unassigned[c]--;
+        e->mines_assigned[c] += mine;
+        if (e->mines_assigned[c] > e->needed[c] || e->mines_assigned[c] + e->unassigned[c] < e->needed[c])
+            ok = false;
+    }
+    return ok;
+}
+
+static void unassign(Enumeration *e, int v, int mine)
+{
+    for (int k = e->var_offsets[v]; k < e->var_offsets[v + 1]; ++k)
+    {
+        int c = e->var_constraints[k];
+        e->unassigned[c]++;
+        e->mines_assigned[c] -= mine;
+    }
+}
+
+/*
+ * Backtracking over de variabelen in volgorde, tot de eerste toewijzing die met alle constraints klopt.
+ * De waarden van die oplossing worden in seen_mine en seen_safe genoteerd. Geeft false terug als er geen oplossing is,
+ * of als het budget aan knopen op is (dat ziet de oproeper aan nodes).
+ */
+static bool search(Enumeration *e, int v)
+{
+    if (e->nodes++ > SOLVER_NODE_BUDGET)
+        return false;
+    if (v == e->var_count)
+    {
+        for (int i = 0; i < e->var_count; ++i)
+        {
+            if (e->assignment[i])
+                e->seen_mine[i] = 1;
+            else
+                e->seen_safe[i] = 1;
+        }
+        return true;
+    }
+    for (int mine = 0; mine <= 1; ++mine)
+    {
+        if (e->fixed[v] >= 0 && e->fixed[v] != mine)
+            continue;
+        e->assignment[v] = (uint8_t)mine;
+        bool found = assign(e, v, mine) && search(e, v + 1);
+        unassign(e, v, mine);
+        if (found)
+            return true;
+    }
+    return false;
+}
+
+static int find_root(int *parent, int v)
+{
+    while (parent[v] != v)
+    {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+    return v;
+}
+
+/*
+ * Zoekt per samenhangend deel van de frontier welke variabelen in elke toewijzing die met de getallen klopt dezelfde waarde hebben.
+ * We zoeken eerst 1 oplossing. Daarna zoeken we voor elke variabele die tot nu toe maar in 1 waarde gezien is, een oplossing
+ * met de andere waarde; elke gevonden oplossing beslist meteen ook over de andere variabelen. Is er zo geen oplossing,
+ * dan ligt de variabele vast (veilig of mijn), en houden we ze voor de volgende zoektochten vast.
+ * Dat vraagt veel minder knopen dan alle oplossingen opsommen, zeker in delen waar niets te besluiten valt.
+ * (Het totaal aantal mijnen gebruiken we niet: dat kan enkel oplossingen uitsluiten, dus de besluiten blijven juist.)
+ * Geeft terug of er iets nieuws gevonden is, of -1 als het geheugen opraakt.
+ */
+static int enumerate_frontier(Solver *solver)
+{
+    // De frontier: alle onbekende variabelen van de constraints die nog niet opgelost zijn.
+    size_t max_vars = solver->constraint_count * 8;
+    int *cells = (int *)malloc((max_vars + 1) * sizeof(int));
+    int *active = (int *)malloc((solver->constraint_count + 1) * sizeof(int));
+    int *needed = (int *)malloc((solver->constraint_count + 1) * sizeof(int));
+    int *first_var = (int *)malloc((solver->constraint_count + 1) * sizeof(int));
+    int *parent = (int *)malloc((max_vars + 1) * sizeof(int));
+    if (!cells || !active || !needed || !first_var || !parent)
+    {
+        free(cells);
+        free(active);
+        free(needed);
+        free(first_var);
+        free(parent);
+        return -1;
+    }
+    int var_count = 0, active_count = 0;
+    for (size_t ci = 0; ci < solver->constraint_count; ++ci)
+    {
+        int vars[8], k;
+        int n = solver_effective(solver, &solver->constraints[ci], vars, &k);
+        if (n == 0)
+            continue;
+        active[active_count] = (int)ci;
+        first_var[active_count] = vars[0];
+        needed[active_count++] = k;
+        int first = -1;
+        for (int i = 0; i < n; ++i)
+        {
+            int id = solver->var_id[vars[i]];
+            if (id < 0)
+            {
+                id = var_count++;
+                solver->var_id[vars[i]] = id;
+                cells[id] = vars[i];
+                parent[id] = id;
+            }
+            // De variabelen van 1 constraint horen bij hetzelfde deel (union-find).
+            if (first < 0)
+                first = find_root(parent, id);
+            else
+                parent[find_root(parent, id)] = first = find_root(parent, first);
+        }
+    }
+
+    // We groeperen de variabelen per deel; binnen een deel blijft de volgorde van het speelveld (goed voor het snoeien).
+    int *order = (int *)malloc((size_t)(var_count + 1) * sizeof(int));
+    int *component_start = (int *)calloc((size_t)var_count + 2, sizeof(int));
+    int *constraint_order = (int *)malloc((size_t)(active_count + 1) * sizeof(int));
+    int *constraint_start = (int *)calloc((size_t)var_count + 2, sizeof(int));
+    int *local = (int *)malloc((size_t)(var_count + 1) * sizeof(int));
+    int *var_offsets = (int *)calloc((size_t)var_count + 2, sizeof(int));
+    int *var_constraints = (int *)malloc((size_t)active_count * 8 * sizeof(int) + sizeof(int));
+    int *mines_assigned = (int *)calloc((size_t)active_count + 1, sizeof(int));
+    int *unassigned = (int *)calloc((size_t)active_count + 1, sizeof(int));
+    int *constraint_needed = (int *)malloc((size_t)(active_count + 1) * sizeof(int));
+    int *constraint_local = (int *)malloc((size_t)(active_count + 1) * sizeof(int));
+    uint8_t *flags = (uint8_t *)malloc((size_t)var_count * 4 + 4);
+    int found = 0;
+    if (!order || !component_start || !constraint_order || !constraint_start || !local || !var_offsets || !var_constraints || !mines_assigned || !unassigned ||
+        !constraint_needed || !constraint_local || !flags)
+    {
+        found = -1;
+        goto done;
+    }
+
+    // Tel de grootte van elk deel (per wortel) en sorteer de variabelen per deel (counting sort).
+    for (int v = 0; v < var_count; ++v)
+        component_start[find_root(parent, v) + 1]++;
+    for (int r = 0; r < var_count; ++r)
+        component_start[r + 1] += component_start[r];
+    for (int v = 0; v < var_count; ++v)
+    {
+        int r = find_root(parent, v);
+        order[component_start[r]++] = v;
+    }
+    // component_start[r] wijst nu naar het einde van deel r; het begin is het einde van deel r - 1.
+    for (int r = var_count; r > 0; --r)
+        component_start[r] = component_start[r - 1];
+    component_start[0] = 0;
+
+    // Ook de constraints groeperen we per deel (de wortel van hun eerste variabele), zodat elk deel enkel de zijne overloopt.
+    for (int a = 0; a < active_count; ++a)
+        constraint_start[find_root(parent, solver->var_id[first_var[a]]) + 1]++;
+    for (int r = 0; r < var_count; ++r)
+        constraint_start[r + 1] += constraint_start[r];
+    for (int a = 0; a < active_count; ++a)
+        constraint_order[constraint_start[find_root(parent, solver->var_id[first_var[a]])]++] = a;
+    for (int r = var_count; r > 0; --r)
+        constraint_start[r] = constraint_start[r - 1];
+    constraint_start[0] = 0;
+
+    for (int r = 0; r < var_count && found >= 0; ++r)
+    {
+        int begin = component_start[r], end = component_start[r + 1], size = end - begin;
+        if (size == 0 || size > SOLVER_MAX_COMPONENT_VARS)
+            continue;
+        for (int i = 0; i < size; ++i)
+            local[order[begin + i]] = i;
+
+        // De constraints van dit deel, met per variabele de lijst van zijn constraints (CSR).
+        int constraints = 0;
+        memset(var_offsets, 0, (size_t)(size + 2) * sizeof(int));
+        for (int j = constraint_start[r]; j < constraint_start[r + 1]; ++j)
+        {
+            int a = constraint_order[j], vars[8], k;
+            int n = solver_effective(solver, &solver->constraints[active[a]], vars, &k);
+            constraint_local[a] = constraints;
+            constraint_needed[constraints] = needed[a];
+            mines_assigned[constraints] = 0;
+            unassigned[constraints] = n;
+            constraints++;
+            for (int i = 0; i < n; ++i)
+                var_offsets[local[solver->var_id[vars[i]]] + 2]++;
+        }
+        for (int i = 0; i < size; ++i)
+            var_offsets[i + 2] += var_offsets[i + 1];
+        for (int j = constraint_start[r]; j < constraint_start[r + 1]; ++j)
+        {
+            int a = constraint_order[j], vars[8], k;
+            int n = solver_effective(solver, &solver->constraints[active[a]], vars, &k);
+            for (int i = 0; i < n; ++i)
+                var_constraints[var_offsets[local[solver->var_id[vars[i]]] + 1]++] = constraint_local[a];
+        }
+
+        Enumeration e;
+        e.var_count = size;
+        e.var_offsets = var_offsets;
+        e.var_constraints = var_constraints;
+        e.mines_assigned = mines_assigned;
+        e.unassigned = unassigned;
+        e.needed = constraint_needed;
+        e.assignment = flags;
+        e.seen_mine = flags + size;
+        e.seen_safe = flags + 2 * size;
+        e.fixed = (int8_t *)(flags + 3 * size);
+        e.nodes = 0;
+        memset(flags, 0, (size_t)size * 3);
+        memset(e.fixed, -1, (size_t)size);
+        if (!search(&e, 0))
+            continue;
+        for (int i = 0; i < size; ++i)
+        {
+            if (e.seen_mine[i] && e.seen_safe[i])
+                continue;
+            int other = e.seen_mine[i] ? 0 : 1;
+            e.fixed[i] = (int8_t)other;
+            if (search(&e, 0))
+            {
+                e.fixed[i] = -1;
+                continue;
+            }
+            // Zonder knopen over is het antwoord onbekend, en is ook de rest van dit deel niet meer te beslissen.
+            if (e.nodes > SOLVER_NODE_BUDGET)
+                break;
+            e.fixed[i] = (int8_t)(1 - other);
+            solver->known[cells[order[begin + i]]] = other ? SOLVER_SAFE : SOLVER_MINE;
+            found = 1;
+        }
+    }
+
+done:
+    for (int v = 0; v < var_count; ++v)
+        solver->var_id[cells[v]] = -1;
+    free(cells);
+    free(active);
+    free(needed);
+    free(first_var);
+    free(parent);
+    free(order);
+    free(component_start);
+    free(constraint_order);
+    free(constraint_start);
+    free(local);
+    free(var_offsets);
+    free(var_constraints);
+    free(mines_assigned);
+    free(unassigned);
+    free(constraint_needed);
+    free(constraint_local);
+    free(flags);
+    return found;
+}
+
+/*
+ * Zoekt alle zekere zetten in de huidige toestand van het spel: solver->safe en solver->mines bevatten daarna
+ * de covered cellen die zeker veilig zijn, en de cellen die zeker een mijn zijn.
+ * Geeft -1 terug als het geheugen opraakt of als het speelveld meer dan SOLVER_MAX_CELLS cellen heeft.
+ */
+int solver_step(Solver *solver, const Game *game)
+{
+    const Board *b = &game->board;
+    size_t cells = map_cell_count(b);
+    if (cells > SOLVER_MAX_CELLS || ensure_capacity(solver, cells) != 0)
+        return -1;
+    solver->safe_count = 0;
+    solver->mine_count = 0;
+    solver->constraint_count = 0;
+    if (!game->mines_placed)
+        return 0;
+
+    // Terwijl show_all actief is, staat wat de speler echt uncovered heeft in CELL_SAVED_UNCOVERED.
+    Cell uncovered_bit = game->show_all ? CELL_SAVED_UNCOVERED : CELL_UNCOVERED;
+    for (size_t i = 0; i < cells; ++i)
+    {
+        solver->known[i] = cell_has(b->cells[i], uncovered_bit) ? SOLVER_SAFE : SOLVER_UNKNOWN;
+        solver->constraint_of[i] = -1;
+    }
+
+    // Elk uncovered getal met minstens 1 covered buur wordt een constraint (de buren in de volgorde van het speelveld).
+    for (int y = 0; y < b->height; ++y)
+    {
+        for (int x = 0; x < b->width; ++x)
+        {
+            Cell c = MAP_CELL(b, x, y);
+            if (!cell_has(c, uncovered_bit) || cell_is_mine(c))
+                continue;
+            SolverConstraint constraint;
+            constraint.cell = y * b->width + x;
+            constraint.count = cell_neighbour_mines(c);
+            constraint.var_count = 0;
+            for (int ny = y - 1; ny <= y + 1; ++ny)
+            {
+                for (int nx = x - 1; nx <= x + 1; ++nx)
+                {
+                    if (map_in_bounds(b, nx, ny) && !cell_has(MAP_CELL(b, nx, ny), uncovered_bit))
+                        constraint.vars[constraint.var_count++] = ny * b->width + nx;
+                }
+            }
+            if (constraint.var_count == 0)
+                continue;
+            solver->constraint_of[constraint.cell] = (int)solver->constraint_count;
+            if (add_constraint(solver, &constraint) != 0)
+                return -1;
+        }
+    }
+
+    // Eerst de goedkope regels; pas als die vastlopen, de opsomming (en daarna opnieuw de regels met wat die vond).
+    propagate(solver, b->width, b->height);
+    for (;;)
+    {
+        int found = enumerate_frontier(solver);
+        if (found < 0)
+            return -1;
+        if (found == 0)
+            break;
+        propagate(solver, b->width, b->height);
+    }
+
+    for (size_t i = 0; i < cells; ++i)
+    {
+        if (cell_has(b->cells[i], uncovered_bit))
+            continue;
+        if (solver->known[i] == SOLVER_SAFE)
+            solver->safe[solver->safe_count++] = (int)i;
+        else if (solver->known[i] == SOLVER_MINE)
+            solver->mines[solver->mine_count++] = (int)i;
+    }
+    return 0;
+}
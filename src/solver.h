@@ -0,0 +1,66 @@
+#ifndef MINESWEEPER_SOLVER_H
+#define MINESWEEPER_SOLVER_H
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "game.h"
+
+/*
+ * De solver redeneert enkel met wat de speler ziet: de uncovered getallen en welke cellen nog covered zijn
+ * (vlaggen van de speler worden niet vertrouwd). Per stap zoekt hij:
+ * - de triviale regels per getal (alle buren veilig, of alle buren mijn)
+ * - de subset-regels tussen 2 getallen in elkaars buurt (A ⊆ B: het verschil B \ A heeft B - A mijnen)
+ * - als de regels vastlopen: een exacte zoektocht over de geldige toewijzingen per samenhangend deel van de frontier
+ * Het resultaat zijn de covered cellen die zeker veilig zijn en de cellen die zeker een mijn zijn.
+ */
+
+/*
+ * De solver (en de kansberekening die erop steunt) nummert de cellen met int indices.
+ * Een speelveld met meer cellen dan dit wordt door solver_step geweigerd, in plaats van de indices te laten overlopen.
+ */
+#define SOLVER_MAX_CELLS ((size_t)INT_MAX)
+
+// Een deel van de frontier met meer variabelen dan dit wordt niet doorzocht (de regels gelden daar wel nog).
+#define SOLVER_MAX_COMPONENT_VARS 48
+
+// Het maximum aantal knopen in de zoekboom per deel van de frontier; daarboven geven we op voor (de rest van) dat deel.
+#define SOLVER_NODE_BUDGET 200000
+
+// Een getal op het speelveld met zijn covered buren (de variabelen).
+typedef struct
+{
+    int cell;    // de index van de uncovered cell
+    int count;   // het aantal mijnen bij de buren (het getal van de cell)
+    int vars[8]; // de indices van de covered buren
+    int var_count;
+} SolverConstraint;
+
+typedef struct
+{
+    size_t capacity;  // het aantal cellen waarvoor de buffers gealloceerd zijn
+    uint8_t *known;   // per cell: SOLVER_UNKNOWN, SOLVER_SAFE of SOLVER_MINE
+    int *constraint_of; // per cell: de index van zijn constraint, of -1
+    int *var_id;        // per cell: de index als variabele in de opsomming, of -1
+    SolverConstraint *constraints;
+    size_t constraint_count;
+    size_t constraint_capacity;
+
+    // Het resultaat van de laatste solver_step: indices van cellen, in de volgorde van het speelveld.
+    int *safe;
+    size_t safe_count;
+    int *mines;
+    size_t mine_count;
+} Solver;
+
+#define SOLVER_UNKNOWN 0
+#define SOLVER_SAFE 1
+#define SOLVER_MINE 2
+
+void solver_init(Solver *solver);
+void solver_free(Solver *solver);
+int solver_step(Solver *solver, const Game *game);
+int solver_effective(const Solver *solver, const SolverConstraint *c, int *out_vars, int *out_mines);
+
+#endif // MINESWEEPER_SOLVER_H
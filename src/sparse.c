@@ -0,0 +1,412 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sparse.h"
+#include "rng.h"
+
+static inline bool sparse_in_bounds(const SparseBoard *s, int x, int y)
+{
+    return x >= 0 && x < s->width && y >= 0 && y < s->height;
+}
+
+static inline uint64_t sparse_index(const SparseBoard *s, int x, int y)
+{
+    return (uint64_t)y * (uint64_t)s->width + (uint64_t)x;
+}
+
+// Initialiseert een leeg speelveld van w op h cellen, nog zonder mijnen. Geeft -1 terug als er geen geheugen is.
+int sparse_init(SparseBoard *s, int w, int h)
+{
+    memset(s, 0, sizeof(*s));
+    if (w <= 0 || h <= 0)
+        return -1;
+    s->width = w;
+    s->height = h;
+    uint64_t cells = (uint64_t)w * (uint64_t)h;
+    s->memo = (SparseMemo *)calloc(SPARSE_MEMO_SIZE, sizeof(SparseMemo));
+    if (!s->memo || roaring_init(&s->uncovered, cells) != 0 || roaring_init(&s->flagged, cells) != 0)
+    {
+        sparse_free(s);
+        return -1;
+    }
+    return 0;
+}
+
+void sparse_free(SparseBoard *s)
+{
+    free(s->mine_x);
+    free(s->row_start);
+    free(s->memo);
+    free(s->seeds);
+    roaring_free(&s->uncovered);
+    roaring_free(&s->flagged);
+    memset(s, 0, sizeof(*s));
+}
+
+/*
+ * Plaatst mines mijnen, niet op (exclude_x, exclude_y) (de eerste klik), deterministisch vanuit de seed.
+ * Zoals add_mines verdelen we de mijnen eerst hypergeometrisch over de rijen; per rij kiest Floyd de kolommen
+ * (met een eigen stroom van de seed per rij). Een bitset van 1 rij houdt de gekozen kolommen bij en geeft ze gesorteerd terug.
+ * Geeft het aantal geplaatste mijnen terug (minder als het speelveld te klein is), of -1 als er geen geheugen is.
+ */
+int sparse_place_mines(SparseBoard *s, int mines, uint64_t seed, int exclude_x, int exclude_y)
+{
+    bool exclude = sparse_in_bounds(s, exclude_x, exclude_y);
+    uint64_t free_cells = (uint64_t)s->width * (uint64_t)s->height - (exclude ? 1 : 0);
+    if (mines < 0)
+        mines = 0;
+    if ((uint64_t)mines > free_cells)
+        mines = (int)free_cells;
+
+    free(s->mine_x);
+    free(s->row_start);
+    s->mine_x = (uint32_t *)malloc((size_t)(mines > 0 ? mines : 1) * sizeof(uint32_t));
+    s->row_start = (uint32_t *)malloc(((size_t)s->height + 1) * sizeof(uint32_t));
+    size_t words = ((size_t)s->width + 63) / 64;
+    uint64_t *chosen = (uint64_t *)calloc(words, sizeof(uint64_t));
+    if (!s->mine_x || !s->row_start || !chosen)
+    {
+        free(chosen);
+        free(s->mine_x);
+        free(s->row_start);
+        s->mine_x = NULL;
+        s->row_start = NULL;
+        return -1;
+    }
+    // Nieuwe mijnen: de onthouden getallen zijn niet meer geldig.
+    memset(s->memo, 0, SPARSE_MEMO_SIZE * sizeof(SparseMemo));
+
+    Rng rng;
+    rng_seed(&rng, seed);
+    uint64_t remaining_cells = free_cells, remaining_mines = (uint64_t)mines;
+    uint32_t pos = 0;
+    for (int y = 0; y < s->height; ++y)
+    {
+        s->row_start[y] = pos;
+        uint32_t row_cells = (uint32_t)s->width - (exclude && y == exclude_y ? 1 : 0);
+        uint32_t k = (uint32_t)rng_hypergeometric(&rng, remaining_cells, row_cells, remaining_mines);
+        remaining_cells -= row_cells;
+        remaining_mines -= k;
+        if (k == 0)
+            continue;
+
+        Rng row_rng;
+        rng_seed_stream(&row_rng, seed, (uint64_t)y + 1);
+        uint32_t lo = row_cells, hi = 0;
+        for (uint32_t j = row_cells - k; j < row_cells; ++j)
+        {
+            uint32_t t = (uint32_t)rng_bounded(&row_rng, (uint64_t)j + 1);
+            if ((chosen[t >> 6] >> (t & 63)) & 1)
+                t = j;
+            chosen[t >> 6] |= (uint64_t)1 << (t & 63);
+            lo = t < lo ? t : lo;
+            hi = t > hi ? t : hi;
+        }
+        // De gekozen kolommen in volgorde (enkel de woorden tussen de kleinste en de grootste), en de bitset weer leeg.
+        for (uint32_t w = lo >> 6; w <= hi >> 6; ++w)
+        {
+            for (uint64_t bits = chosen[w]; bits; bits &= bits - 1)
+            {
+                uint32_t t = w * 64;
+                for (uint64_t b = bits & (~bits + 1); b > 1; b >>= 1)
+                    t++;
+                // In de rij van de eerste klik schuiven de kolommen vanaf de uitgesloten cell 1 op.
+                s->mine_x[pos++] = exclude && y == exclude_y && t >= (uint32_t)exclude_x ? t + 1 : t;
+            }
+            chosen[w] = 0;
+        }
+    }
+    s->row_start[s->height] = pos;
+    free(chosen);
+    return mines;
+}
+
+// De eerste mijn van rij y met kolom >= x, als index in mine_x (row_start[y + 1] als er geen is).
+static uint32_t row_lower_bound(const SparseBoard *s, int y, long x)
+{
+    uint32_t lo = s->row_start[y], hi = s->row_start[y + 1];
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if ((long)s->mine_x[mid] < x)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+bool sparse_is_mine(const SparseBoard *s, int x, int y)
+{
+    if (!s->row_start || !sparse_in_bounds(s, x, y))
+        return false;
+    uint32_t i = row_lower_bound(s, y, x);
+    return i < s->row_start[y + 1] && s->mine_x[i] == (uint32_t)x;
+}
+
+// Het aantal mijnen rond (x, y): per rij 1 binary search naar de eerste mijn vanaf kolom x - 1.
+static int count_neighbours(const SparseBoard *s, int x, int y)
+{
+    int count = 0;
+    for (int ny = y - 1; ny <= y + 1; ++ny)
+    {
+        if (ny < 0 || ny >= s->height)
+            continue;
+        for (uint32_t i = row_lower_bound(s, ny, (long)x - 1); i < s->row_start[ny + 1] && (long)s->mine_x[i] <= (long)x + 1; ++i)
+            count += ny != y || s->mine_x[i] != (uint32_t)x;
+    }
+    return count;
+}
+
+// Het aantal mijnen rond (x, y), berekend bij de eerste vraag en onthouden in een direct-mapped cache.
+int sparse_neighbour_mines(SparseBoard *s, int x, int y)
+{
+    if (!s->row_start || !sparse_in_bounds(s, x, y))
+        return 0;
+    uint64_t i = sparse_index(s, x, y);
+    SparseMemo *m = &s->memo[((i * 0x9E3779B97F4A7C15ULL) >> 40) & (SPARSE_MEMO_SIZE - 1)];
+    if (m->key != i + 1)
+    {
+        m->key = i + 1;
+        m->count = (uint8_t)count_neighbours(s, x, y);
+    }
+    return m->count;
+}
+
+// De cell (x, y) als gepackte Cell, zoals MAP_CELL die van een gewoon speelveld teruggeeft.
+Cell sparse_cell(SparseBoard *s, int x, int y)
+{
+    bool mine = sparse_is_mine(s, x, y);
+    Cell c = mine ? CELL_MINE : (Cell)sparse_neighbour_mines(s, x, y);
+    uint64_t i = sparse_index(s, x, y);
+    if (roaring_contains(&s->uncovered, i) || (mine && s->mines_uncovered))
+        c |= CELL_UNCOVERED;
+    if (roaring_contains(&s->flagged, i))
+        c |= CELL_FLAGGED;
+    return c;
+}
+
+// Uncovert 1 cell. Geeft terug of ze nieuw uncovered is.
+bool sparse_uncover(SparseBoard *s, int x, int y)
+{
+    if (!sparse_in_bounds(s, x, y))
+        return false;
+    uint64_t i = sparse_index(s, x, y);
+    return roaring_add_range(&s->uncovered, i, i) > 0;
+}
+
+// Zet of verwijdert de vlag van (x, y). Geeft terug of er iets veranderd is.
+bool sparse_set_flag(SparseBoard *s, int x, int y, bool on)
+{
+    if (!sparse_in_bounds(s, x, y))
+        return false;
+    uint64_t i = sparse_index(s, x, y);
+    return on ? roaring_add_range(&s->flagged, i, i) > 0 : roaring_remove(&s->flagged, i);
+}
+
+/*
+ * De eerste kolom >= x in rij y (of width) waar een reeks nul-cellen stopt: een mijn of getal, of een cell die al
+ * uncovered of gevlagd is. Een getal ligt naast een mijn, dus per rij volstaat de eerste mijn vanaf kolom x - 1.
+ */
+static int next_blocker(const SparseBoard *s, int x, int y)
+{
+    long end = s->width;
+    for (int ny = y - 1; ny <= y + 1; ++ny)
+    {
+        if (ny < 0 || ny >= s->height)
+            continue;
+        uint32_t i = row_lower_bound(s, ny, (long)x - 1);
+        if (i < s->row_start[ny + 1])
+        {
+            long b = (long)s->mine_x[i] - 1 < x ? x : (long)s->mine_x[i] - 1;
+            end = b < end ? b : end;
+        }
+    }
+    uint64_t row = sparse_index(s, 0, y);
+    if (x < end)
+    {
+        int64_t u = roaring_next_set(&s->uncovered, row + (uint64_t)x, row + (uint64_t)end - 1);
+        if (u >= 0)
+            end = (long)(u - (int64_t)row);
+    }
+    if (x < end)
+    {
+        int64_t f = roaring_next_set(&s->flagged, row + (uint64_t)x, row + (uint64_t)end - 1);
+        if (f >= 0)
+            end = (long)(f - (int64_t)row);
+    }
+    return (int)end;
+}
+
+// De laatste kolom <= x in rij y (of -1) waar een reeks nul-cellen stopt, in spiegelbeeld van next_blocker.
+static int prev_blocker(const SparseBoard *s, int x, int y)
+{
+    long start = -1;
+    for (int ny = y - 1; ny <= y + 1; ++ny)
+    {
+        if (ny < 0 || ny >= s->height)
+            continue;
+        uint32_t i = row_lower_bound(s, ny, (long)x + 2);
+        if (i > s->row_start[ny])
+        {
+            long b = (long)s->mine_x[i - 1] + 1 > x ? x : (long)s->mine_x[i - 1] + 1;
+            start = b > start ? b : start;
+        }
+    }
+    uint64_t row = sparse_index(s, 0, y);
+    if (start < x)
+    {
+        int64_t u = roaring_prev_set(&s->uncovered, row + (uint64_t)x, row + (uint64_t)(start + 1));
+        if (u >= 0)
+            start = (long)(u - (int64_t)row);
+    }
+    if (start < x)
+    {
+        int64_t f = roaring_prev_set(&s->flagged, row + (uint64_t)x, row + (uint64_t)(start + 1));
+        if (f >= 0)
+            start = (long)(f - (int64_t)row);
+    }
+    return (int)start;
+}
+
+static bool push_seed(SparseBoard *s, int x, int y)
+{
+    if (s->seed_count == s->seed_capacity)
+    {
+        size_t capacity = s->seed_capacity ? s->seed_capacity * 2 : 1024;
+        RevealSeed *seeds = (RevealSeed *)realloc(s->seeds, capacity * sizeof(RevealSeed));
+        if (!seeds)
+            return false;
+        s->seeds = seeds;
+        s->seed_capacity = capacity;
+    }
+    s->seeds[s->seed_count].x = x;
+    s->seeds[s->seed_count].y = y;
+    s->seed_count++;
+    return true;
+}
+
+/*
+ * Scant de cellen [x0, x1] van rij y (naast een zonet uncovered span), zoals scan_row van de reveal engine:
+ * getallen worden meteen uncovered, per reeks nul-cellen pushen we 1 seed en springen we naar het einde van de reeks.
+ * Uncovered cellen worden met de bitmap in 1 keer overgeslagen.
+ */
+static int64_t scan_row(SparseBoard *s, int y, int x0, int x1)
+{
+    int64_t uncovered = 0;
+    uint64_t row = sparse_index(s, 0, y);
+    int x = x0;
+    while (x <= x1)
+    {
+        int64_t next = roaring_next_clear(&s->uncovered, row + (uint64_t)x, row + (uint64_t)x1);
+        if (next < 0)
+            break;
+        x = (int)(next - (int64_t)row);
+        if (roaring_contains(&s->flagged, row + (uint64_t)x) || sparse_is_mine(s, x, y))
+        {
+            x++;
+            continue;
+        }
+        // Elke cell wordt hier maar 1 keer bekeken: buiten de cache om, die is voor het tekenen.
+        if (count_neighbours(s, x, y) != 0)
+        {
+            uncovered += sparse_uncover(s, x, y);
+            x++;
+            continue;
+        }
+        /*
+         * Zonder visited bitset (die zou 1 bit per cell kosten) kan een reeks 2 keer gepusht worden; de 2de keer is ze al uncovered.
+         * Lukt de push niet (geen geheugen), dan springen we niet over de reeks: de volgende cell probeert het opnieuw,
+         * en anders blijft de reeks covered (en kan ze later nog gepusht worden).
+         */
+        if (!push_seed(s, x, y))
+        {
+            x++;
+            continue;
+        }
+        x = next_blocker(s, x, y);
+    }
+    return uncovered;
+}
+
+/*
+ * Neemt de span van de seed op, zoals expand_seed van de reveal engine: we zoeken de span met next_blocker en prev_blocker
+ * (sprongen via de index van de mijnen en de bitmaps), zetten ze in 1 keer uncovered als run in de bitmap
+ * en scannen de randcellen en de rijen erboven en eronder. Geeft het aantal nieuw uncovered cellen terug.
+ */
+static int64_t expand_seed(SparseBoard *s, RevealSeed seed, bool first, DirtyList *dirty)
+{
+    uint64_t row = sparse_index(s, 0, seed.y);
+    if (roaring_contains(&s->uncovered, row + (uint64_t)seed.x))
+        return 0;
+    // De aangeklikte cell zelf wordt altijd opgenomen (ook als ze gevlagd is).
+    if (!first && roaring_contains(&s->flagged, row + (uint64_t)seed.x))
+        return 0;
+
+    int left = seed.x > 0 ? prev_blocker(s, seed.x - 1, seed.y) + 1 : 0;
+    int right = seed.x < s->width - 1 ? next_blocker(s, seed.x + 1, seed.y) - 1 : s->width - 1;
+    int64_t uncovered = roaring_add_range(&s->uncovered, row + (uint64_t)left, row + (uint64_t)right);
+    if (uncovered < 0)
+        return 0;
+
+    int x0 = left > 0 ? left - 1 : left;
+    int x1 = right < s->width - 1 ? right + 1 : right;
+    uncovered += scan_row(s, seed.y, x0, x1);
+    dirty_add(dirty, seed.y, x0, x1);
+    if (seed.y > 0)
+    {
+        uncovered += scan_row(s, seed.y - 1, x0, x1);
+        dirty_add(dirty, seed.y - 1, x0, x1);
+    }
+    if (seed.y < s->height - 1)
+    {
+        uncovered += scan_row(s, seed.y + 1, x0, x1);
+        dirty_add(dirty, seed.y + 1, x0, x1);
+    }
+    return uncovered;
+}
+
+/*
+ * De cascade vanaf de nul-cell (x, y), als scanline flood fill zoals reveal_begin en reveal_continue:
+ * sparse_cascade_begin neemt meteen de span van de aangeklikte cell op, sparse_cascade_continue werkt daarna
+ * hoogstens budget seeds van de worklist af (alle seeds als budget < 0). Geven het aantal nieuw uncovered cellen terug.
+ * De gescande rijen worden als spans aan de dirty list toegevoegd (mag NULL zijn).
+ */
+int64_t sparse_cascade_begin(SparseBoard *s, int x, int y, DirtyList *dirty)
+{
+    if (!sparse_in_bounds(s, x, y))
+        return 0;
+    RevealSeed seed = {x, y};
+    return expand_seed(s, seed, true, dirty);
+}
+
+int64_t sparse_cascade_continue(SparseBoard *s, long budget, DirtyList *dirty)
+{
+    int64_t uncovered = 0;
+    for (; s->seed_count > 0 && budget != 0; --budget)
+        uncovered += expand_seed(s, s->seeds[--s->seed_count], false, dirty);
+    return uncovered;
+}
+
+// Gooit de rest van de worklist weg (bij game over).
+void sparse_cascade_reset(SparseBoard *s)
+{
+    s->seed_count = 0;
+}
+
+// De volledige cascade vanaf (x, y) in 1 keer.
+int64_t sparse_cascade(SparseBoard *s, int x, int y, DirtyList *dirty)
+{
+    int64_t uncovered = sparse_cascade_begin(s, x, y, dirty);
+    return uncovered + sparse_cascade_continue(s, -1, dirty);
+}
+
+// Het geheugen van het speelveld in bytes (de index van de mijnen, de bitmaps, de cache en de worklist).
+size_t sparse_memory(const SparseBoard *s)
+{
+    size_t bytes = sizeof(SparseBoard);
+    if (s->row_start)
+        bytes += (size_t)s->row_start[s->height] * sizeof(uint32_t) + ((size_t)s->height + 1) * sizeof(uint32_t);
+    bytes += roaring_memory(&s->uncovered) + roaring_memory(&s->flagged);
+    bytes += SPARSE_MEMO_SIZE * sizeof(SparseMemo) + s->seed_capacity * sizeof(RevealSeed);
+    return bytes;
+}
@@ -0,0 +1,61 @@
+#ifndef MINESWEEPER_SPARSE_H
+#define MINESWEEPER_SPARSE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "map.h"
+#include "dirty.h"
+#include "reveal.h"
+#include "roaring.h"
+
+/*
+ * Een speelveld voor enorme speelvelden met weinig mijnen (via -z), bv. 100000x100000 met 0.1% mijnen.
+ * In plaats van 1 Cell per cell (10 GB) slaan we enkel op wat er is:
+ * - de mijnen als index: per rij de gesorteerde kolommen (4 bytes per mijn) en een offset per rij
+ * - de uncovered en gevlagde cellen als gecomprimeerde bitmaps (zie roaring.h): een opening is een handvol runs per rij
+ * - de getallen worden pas berekend als ze opgevraagd worden (3 binary searches), en onthouden in een kleine cache
+ * Via sparse_cell ziet een cell er voor de rest van het spel en de GUI uit zoals een gepackte Cell van een gewoon speelveld.
+ * De cascade springt met de index van de mijnen over volledige reeksen nul-cellen, in plaats van cell per cell te lopen,
+ * zodat de kost afhangt van het aantal mijnen rond de opening en niet van de oppervlakte ervan.
+ */
+
+// Het aantal plaatsen in de cache van de getallen (een macht van 2, direct-mapped).
+#define SPARSE_MEMO_SIZE 65536
+
+typedef struct
+{
+    uint64_t key; // de index van de cell + 1 (0 = leeg)
+    uint8_t count;
+} SparseMemo;
+
+typedef struct
+{
+    int width;
+    int height;
+    uint32_t *mine_x;    // de kolommen van de mijnen, rij per rij en per rij gesorteerd
+    uint32_t *row_start; // height + 1 offsets in mine_x: de mijnen van rij y zijn [row_start[y], row_start[y + 1])
+    bool mines_uncovered; // na verlies tonen we alle mijnen als uncovered (zonder ze allemaal in de bitmap te zetten)
+    Roaring uncovered;
+    Roaring flagged;
+    SparseMemo *memo;
+    RevealSeed *seeds; // de worklist van de cascade, hergebruikt en bewaard tussen aanroepen van sparse_cascade_continue
+    size_t seed_count;
+    size_t seed_capacity;
+} SparseBoard;
+
+int sparse_init(SparseBoard *s, int w, int h);
+void sparse_free(SparseBoard *s);
+int sparse_place_mines(SparseBoard *s, int mines, uint64_t seed, int exclude_x, int exclude_y);
+bool sparse_is_mine(const SparseBoard *s, int x, int y);
+int sparse_neighbour_mines(SparseBoard *s, int x, int y);
+Cell sparse_cell(SparseBoard *s, int x, int y);
+bool sparse_uncover(SparseBoard *s, int x, int y);
+bool sparse_set_flag(SparseBoard *s, int x, int y, bool on);
+int64_t sparse_cascade_begin(SparseBoard *s, int x, int y, DirtyList *dirty);
+int64_t sparse_cascade_continue(SparseBoard *s, long budget, DirtyList *dirty);
+void sparse_cascade_reset(SparseBoard *s);
+int64_t sparse_cascade(SparseBoard *s, int x, int y, DirtyList *dirty);
+size_t sparse_memory(const SparseBoard *s);
+
+#endif // MINESWEEPER_SPARSE_H
@@ -0,0 +1,573 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+#include "world.h"
+#include "files.h"
+#include "rng.h"
+
+#define WORLD_HEADER_SIZE 44
+#define WORLD_CHUNK_HEADER_SIZE 16
+#define WORLD_META_FILE "world.msw"
+
+// Cellen buiten [-WORLD_LIMIT, WORLD_LIMIT) bestaan niet, zodat x + 1 en de chunkcoördinaten nooit overflowen.
+#define WORLD_LIMIT (1 << 30)
+
+static inline bool world_in_bounds(int x, int y)
+{
+    return x >= -WORLD_LIMIT && x < WORLD_LIMIT && y >= -WORLD_LIMIT && y < WORLD_LIMIT;
+}
+
+// De chunk van een coördinaat (naar beneden afgerond, ook voor negatieve coördinaten).
+static inline int chunk_of(int v)
+{
+    return v >= 0 ? v / WORLD_CHUNK_SIZE : -((-v - 1) / WORLD_CHUNK_SIZE) - 1;
+}
+
+static inline uint64_t chunk_key(int cx, int cy)
+{
+    return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+}
+
+// Mengt de coördinaten van een chunk tot een hash (de finalizer van splitmix64).
+static inline size_t chunk_hash(int cx, int cy)
+{
+    uint64_t z = chunk_key(cx, cy) + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return (size_t)(z ^ (z >> 31));
+}
+
+static int make_directory(const char *directory)
+{
+#ifdef _WIN32
+    if (_mkdir(directory) != 0 && errno != EEXIST)
+        return -1;
+#else
+    if (mkdir(directory, 0755) != 0 && errno != EEXIST)
+        return -1;
+#endif
+    return 0;
+}
+
+static int chunk_filename(const World *world, int cx, int cy, char *out, size_t size)
+{
+    return snprintf(out, size, "%s/c_%d_%d.msc", world->directory, cx, cy) >= (int)size ? -1 : 0;
+}
+
+/*
+ * De mijnen van chunk (cx, cy) als 1 bitmask van 64 bits per rij.
+ * Ze volgen enkel uit de seed en de coördinaten: Floyd trekt chunk_mines verschillende cellen uit stroom (cx, cy) van de seed.
+ * De 3x3 rond de startcell in chunk (0, 0) blijft vrij, zodat de wereld met een opening begint.
+ */
+static void chunk_mines(const World *world, int cx, int cy, uint64_t rows[WORLD_CHUNK_SIZE])
+{
+    memset(rows, 0, WORLD_CHUNK_SIZE * sizeof(uint64_t));
+    Rng rng;
+    rng_seed_stream(&rng, world->seed, chunk_key(cx, cy));
+    for (int j = WORLD_CHUNK_CELLS - world->chunk_mines; j < WORLD_CHUNK_CELLS; ++j)
+    {
+        int t = (int)rng_bounded(&rng, (uint64_t)j + 1);
+        if (rows[t / WORLD_CHUNK_SIZE] >> (t % WORLD_CHUNK_SIZE) & 1)
+            t = j;
+        rows[t / WORLD_CHUNK_SIZE] |= (uint64_t)1 << (t % WORLD_CHUNK_SIZE);
+    }
+    if (cx == 0 && cy == 0)
+        for (int y = WORLD_START_Y - 1; y <= WORLD_START_Y + 1; ++y)
+            rows[y] &= ~((uint64_t)7 << (WORLD_START_X - 1));
+}
+
+// Maakt de cellen van chunk (cx, cy) (zonder toestanden): de mijnen en de getallen, met de mijnen van de 8 buurchunks.
+static void generate_chunk(const World *world, WorldChunk *chunk)
+{
+    uint64_t rows[3][3][WORLD_CHUNK_SIZE];
+    for (int dy = 0; dy < 3; ++dy)
+        for (int dx = 0; dx < 3; ++dx)
+            chunk_mines(world, chunk->cx + dx - 1, chunk->cy + dy - 1, rows[dy][dx]);
+
+    for (int y = 0; y < WORLD_CHUNK_SIZE; ++y)
+    {
+        for (int x = 0; x < WORLD_CHUNK_SIZE; ++x)
+        {
+            Cell *c = &chunk->cells[y * WORLD_CHUNK_SIZE + x];
+            if (rows[1][1][y] >> x & 1)
+            {
+                *c = CELL_MINE;
+                continue;
+            }
+            int count = 0;
+            for (int ny = y - 1; ny <= y + 1; ++ny)
+            {
+                int iy = ny < 0 ? 0 : ny >= WORLD_CHUNK_SIZE ? 2 : 1;
+                int ly = ny - (iy - 1) * WORLD_CHUNK_SIZE;
+                for (int nx = x - 1; nx <= x + 1; ++nx)
+                {
+                    int ix = nx < 0 ? 0 : nx >= WORLD_CHUNK_SIZE ? 2 : 1;
+                    int lx = nx - (ix - 1) * WORLD_CHUNK_SIZE;
+                    count += (int)(rows[iy][ix][ly] >> lx & 1);
+                }
+            }
+            *c = (Cell)count;
+        }
+    }
+}
+
+static WorldChunkKey *stored_slot(const World *world, int cx, int cy)
+{
+    size_t mask = world->stored_capacity - 1;
+    for (size_t i = chunk_hash(cx, cy) & mask;; i = (i + 1) & mask)
+    {
+        WorldChunkKey *k = &world->stored[i];
+        if (!k->used || (k->cx == cx && k->cy == cy))
+            return k;
+    }
+}
+
+static bool is_stored(const World *world, int cx, int cy)
+{
+    return world->stored_capacity > 0 && stored_slot(world, cx, cy)->used;
+}
+
+// Voegt (cx, cy) toe aan de set van chunks op schijf; de set wordt verdubbeld zodra hij half vol is.
+static int add_stored(World *world, int cx, int cy)
+{
+    if ((world->stored_count + 1) * 2 > world->stored_capacity)
+    {
+        size_t capacity = world->stored_capacity ? world->stored_capacity * 2 : 64;
+        WorldChunkKey *old = world->stored;
+        size_t old_capacity = world->stored_capacity;
+        world->stored = (WorldChunkKey *)calloc(capacity, sizeof(WorldChunkKey));
+        if (!world->stored)
+        {
+            world->stored = old;
+            return -1;
+        }
+        world->stored_capacity = capacity;
+        for (size_t i = 0; i < old_capacity; ++i)
+            if (old[i].used)
+                *stored_slot(world, old[i].cx, old[i].cy) = old[i];
+        free(old);
+    }
+    WorldChunkKey *k = stored_slot(world, cx, cy);
+    if (!k->used)
+    {
+        k->cx = cx;
+        k->cy = cy;
+        k->used = true;
+        world->stored_count++;
+    }
+    return 0;
+}
+
+// Schrijft de toestanden van een chunk weg (enkel als ze veranderd zijn).
+static int write_chunk(World *world, WorldChunk *chunk)
+{
+    if (!chunk->modified)
+        return 0;
+    char filename[320];
+    if (chunk_filename(world, chunk->cx, chunk->cy, filename, sizeof(filename)) != 0)
+        return -1;
+    uint8_t buf[WORLD_CHUNK_HEADER_SIZE + WORLD_CHUNK_CELLS];
+    memcpy(buf, WORLD_CHUNK_MAGIC, 4);
+    put_u16(buf + 4, WORLD_VERSION);
+    put_u16(buf + 6, 0);
+    put_u32(buf + 8, (uint32_t)chunk->cx);
+    put_u32(buf + 12, (uint32_t)chunk->cy);
+    memcpy(buf + WORLD_CHUNK_HEADER_SIZE, chunk->cells, WORLD_CHUNK_CELLS);
+    if (add_stored(world, chunk->cx, chunk->cy) != 0 || write_file(filename, buf, sizeof(buf), world->durable) != 0)
+        return -1;
+    chunk->modified = false;
+    return 0;
+}
+
+// Leest chunk (cx, cy) in van schijf. Geeft -1 terug (met een melding) als het bestand ontbreekt of ongeldig is.
+static int read_chunk(const World *world, WorldChunk *chunk)
+{
+    char filename[320];
+    if (chunk_filename(world, chunk->cx, chunk->cy, filename, sizeof(filename)) != 0)
+        return -1;
+    MappedFile f;
+    if (map_file(filename, &f) != 0)
+    {
+        fprintf(stderr, "%s: cannot open file or file is empty\n", filename);
+        return -1;
+    }
+    const uint8_t *data = (const uint8_t *)f.data;
+    int result = -1;
+    if (f.size != WORLD_CHUNK_HEADER_SIZE + WORLD_CHUNK_CELLS || memcmp(data, WORLD_CHUNK_MAGIC, 4) != 0)
+        fprintf(stderr, "%s: not a chunk of this world\n", filename);
+    else if (get_u16(data + 4) != WORLD_VERSION)
+        fprintf(stderr, "%s: unsupported version %u (expected %u)\n", filename, get_u16(data + 4), WORLD_VERSION);
+    else if ((int)get_u32(data + 8) != chunk->cx || (int)get_u32(data + 12) != chunk->cy)
+        fprintf(stderr, "%s: chunk has coordinates (%d, %d)\n", filename, (int)get_u32(data + 8), (int)get_u32(data + 12));
+    else
+    {
+        memcpy(chunk->cells, data + WORLD_CHUNK_HEADER_SIZE, WORLD_CHUNK_CELLS);
+        result = 0;
+    }
+    unmap_file(&f);
+    return result;
+}
+
+static void lru_unlink(World *world, WorldChunk *chunk)
+{
+    if (chunk->lru_prev)
+        chunk->lru_prev->lru_next = chunk->lru_next;
+    else
+        world->lru_head = chunk->lru_next;
+    if (chunk->lru_next)
+        chunk->lru_next->lru_prev = chunk->lru_prev;
+    else
+        world->lru_tail = chunk->lru_prev;
+}
+
+static void lru_push_front(World *world, WorldChunk *chunk)
+{
+    chunk->lru_prev = NULL;
+    chunk->lru_next = world->lru_head;
+    if (world->lru_head)
+        world->lru_head->lru_prev = chunk;
+    else
+        world->lru_tail = chunk;
+    world->lru_head = chunk;
+}
+
+// Haalt de minst recent gebruikte chunks uit het geheugen tot er hoogstens max_chunks over zijn (behalve keep).
+static void evict(World *world, const WorldChunk *keep)
+{
+    while (world->resident > (size_t)world->max_chunks && world->lru_tail && world->lru_tail != keep)
+    {
+        WorldChunk *victim = world->lru_tail;
+        // Kan de chunk niet weggeschreven worden, dan houden we hem (en de rest) in het geheugen: zo gaat er niets verloren.
+        if (write_chunk(world, victim) != 0)
+        {
+            world->io_error = true;
+            return;
+        }
+        lru_unlink(world, victim);
+        WorldChunk **link = &world->buckets[chunk_hash(victim->cx, victim->cy) & (world->bucket_count - 1)];
+        while (*link != victim)
+            link = &(*link)->next;
+        *link = victim->next;
+        free(victim);
+        world->resident--;
+    }
+}
+
+/*
+ * Geeft chunk (cx, cy) terug en zet hem vooraan in de LRU lijst.
+ * Een chunk die niet in het geheugen staat, wordt ingelezen van schijf, of met create nieuw gegenereerd.
+ * Zonder create geeft een chunk die de speler nooit aangeraakt heeft NULL terug.
+ */
+static WorldChunk *get_chunk(World *world, int cx, int cy, bool create)
+{
+    WorldChunk **bucket = &world->buckets[chunk_hash(cx, cy) & (world->bucket_count - 1)];
+    for (WorldChunk *chunk = *bucket; chunk; chunk = chunk->next)
+    {
+        if (chunk->cx == cx && chunk->cy == cy)
+        {
+            if (chunk != world->lru_head)
+            {
+                lru_unlink(world, chunk);
+                lru_push_front(world, chunk);
+            }
+            return chunk;
+        }
+    }
+
+    bool stored = is_stored(world, cx, cy);
+    if (!stored && !create)
+        return NULL;
+    WorldChunk *chunk = (WorldChunk *)malloc(sizeof(WorldChunk));
+    if (!chunk)
+        return NULL;
+    chunk->cx = cx;
+    chunk->cy = cy;
+    chunk->modified = false;
+    // Een beschadigd bestand vervangen we door een nieuwe chunk (de toestanden ervan zijn dan verloren).
+    if (!stored || read_chunk(world, chunk) != 0)
+    {
+        generate_chunk(world, chunk);
+        chunk->modified = stored;
+    }
+    chunk->next = *bucket;
+    *bucket = chunk;
+    lru_push_front(world, chunk);
+    world->resident++;
+    evict(world, chunk);
+    return chunk;
+}
+
+// De cell op (x, y), of NULL (buiten de wereld, geen geheugen, of zonder create een chunk die nooit aangeraakt werd).
+static Cell *get_cell(World *world, int x, int y, bool create, WorldChunk **out_chunk)
+{
+    if (!world_in_bounds(x, y))
+        return NULL;
+    int cx = chunk_of(x), cy = chunk_of(y);
+    WorldChunk *chunk = get_chunk(world, cx, cy, create);
+    if (!chunk)
+        return NULL;
+    *out_chunk = chunk;
+    return &chunk->cells[(y - cy * WORLD_CHUNK_SIZE) * WORLD_CHUNK_SIZE + (x - cx * WORLD_CHUNK_SIZE)];
+}
+
+static int push_seed(World *world, size_t count, int x, int y)
+{
+    if (count == world->queue_capacity)
+    {
+        size_t capacity = world->queue_capacity ? world->queue_capacity * 2 : 1024;
+        RevealSeed *queue = (RevealSeed *)realloc(world->queue, capacity * sizeof(RevealSeed));
+        if (!queue)
+            return -1;
+        world->queue = queue;
+        world->queue_capacity = capacity;
+    }
+    world->queue[count].x = x;
+    world->queue[count].y = y;
+    return 0;
+}
+
+/*
+ * De cascade vanaf de nul-cell (x, y), over de grenzen van de chunks heen.
+ * We houden nooit 2 cellen tegelijk vast: het ophalen van een buurcell kan een andere chunk uit het geheugen halen.
+ */
+static void cascade(World *world, int x, int y)
+{
+    size_t count = 0, pushed = 1;
+    if (push_seed(world, count++, x, y) != 0)
+        return;
+    while (count > 0)
+    {
+        RevealSeed s = world->queue[--count];
+        for (int ny = s.y - 1; ny <= s.y + 1; ++ny)
+        {
+            for (int nx = s.x - 1; nx <= s.x + 1; ++nx)
+            {
+                WorldChunk *chunk;
+                Cell *c = get_cell(world, nx, ny, true, &chunk);
+                if (!c || cell_has(*c, CELL_UNCOVERED | CELL_FLAGGED) || cell_is_mine(*c))
+                    continue;
+                cell_set(c, CELL_UNCOVERED, true);
+                chunk->modified = true;
+                world->uncovered++;
+                if (cell_neighbour_mines(*c) == 0 && pushed < WORLD_MAX_CASCADE && push_seed(world, count, nx, ny) == 0)
+                {
+                    count++;
+                    pushed++;
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Uncovert de cell (x, y). Een mijn doet de speler verliezen; een nul-cell start de cascade.
+ * Een nul-cell die al uncovered is, start de cascade opnieuw (bv. na een cascade die op WORLD_MAX_CASCADE gestopt is).
+ * Geeft terug of er iets veranderd is.
+ */
+bool world_reveal(World *world, int x, int y)
+{
+    WorldChunk *chunk;
+    Cell *c;
+    if (world->status != GAME_PLAYING || !(c = get_cell(world, x, y, true, &chunk)) || cell_has(*c, CELL_FLAGGED))
+        return false;
+    if (cell_has(*c, CELL_UNCOVERED))
+    {
+        if (cell_neighbour_mines(*c) != 0)
+            return false;
+        uint64_t before = world->uncovered;
+        cascade(world, x, y);
+        return world->uncovered != before;
+    }
+    cell_set(c, CELL_UNCOVERED, true);
+    chunk->modified = true;
+    if (cell_is_mine(*c))
+    {
+        world->status = GAME_LOST;
+        world->losing_x = x;
+        world->losing_y = y;
+        return true;
+    }
+    world->uncovered++;
+    if (cell_neighbour_mines(*c) == 0)
+        cascade(world, x, y);
+    return true;
+}
+
+// Zet of verwijdert een vlag op (x, y). Er is geen maximum aantal vlaggen in een oneindige wereld.
+int world_toggle_flag(World *world, int x, int y)
+{
+    WorldChunk *chunk;
+    Cell *c;
+    if (world->status != GAME_PLAYING || !(c = get_cell(world, x, y, true, &chunk)) || cell_has(*c, CELL_UNCOVERED))
+        return FLAG_UNCHANGED;
+    bool flagged = !cell_has(*c, CELL_FLAGGED);
+    cell_set(c, CELL_FLAGGED, flagged);
+    chunk->modified = true;
+    world->flags += flagged ? 1 : -1;
+    return FLAG_CHANGED;
+}
+
+/*
+ * De cell (x, y) om te tekenen. Een chunk die de speler nooit aangeraakt heeft, wordt hiervoor niet aangemaakt:
+ * die cell is covered en zonder vlag (en de waarde is 0). Chunks op schijf worden wel terug ingelezen.
+ */
+Cell world_peek(World *world, int x, int y)
+{
+    WorldChunk *chunk;
+    Cell *c = get_cell(world, x, y, false, &chunk);
+    return c ? *c : 0;
+}
+
+// Schrijft de meta-informatie van de wereld (world.msw) met de lijst van chunks op schijf.
+static int write_meta(const World *world)
+{
+    char filename[320];
+    if (snprintf(filename, sizeof(filename), "%s/%s", world->directory, WORLD_META_FILE) >= (int)sizeof(filename))
+        return -1;
+    size_t size = WORLD_HEADER_SIZE + world->stored_count * 8;
+    uint8_t *buf = (uint8_t *)malloc(size);
+    if (!buf)
+        return -1;
+    memcpy(buf, WORLD_MAGIC, 4);
+    put_u16(buf + 4, WORLD_VERSION);
+    put_u16(buf + 6, (uint16_t)world->status);
+    put_u64(buf + 8, world->seed);
+    put_u32(buf + 16, (uint32_t)world->chunk_mines);
+    put_u32(buf + 20, (uint32_t)world->losing_x);
+    put_u32(buf + 24, (uint32_t)world->losing_y);
+    put_u64(buf + 28, world->uncovered);
+    put_u32(buf + 36, (uint32_t)world->flags);
+    put_u32(buf + 40, (uint32_t)world->stored_count);
+    uint8_t *p = buf + WORLD_HEADER_SIZE;
+    for (size_t i = 0; i < world->stored_capacity; ++i)
+    {
+        if (!world->stored[i].used)
+            continue;
+        put_u32(p, (uint32_t)world->stored[i].cx);
+        put_u32(p + 4, (uint32_t)world->stored[i].cy);
+        p += 8;
+    }
+    int result = write_file(filename, buf, size, world->durable);
+    free(buf);
+    return result;
+}
+
+/*
+ * Leest world.msw in, als het bestaat. Geeft 1 terug als er een wereld ingelezen is, 0 als er geen is
+ * en -1 (met een melding) als het bestand ongeldig is.
+ */
+static int read_meta(World *world)
+{
+    char filename[320];
+    if (snprintf(filename, sizeof(filename), "%s/%s", world->directory, WORLD_META_FILE) >= (int)sizeof(filename))
+        return -1;
+    MappedFile f;
+    if (map_file(filename, &f) != 0)
+        return 0;
+    const uint8_t *data = (const uint8_t *)f.data;
+    int result = -1;
+    if (f.size < WORLD_HEADER_SIZE || memcmp(data, WORLD_MAGIC, 4) != 0)
+        fprintf(stderr, "%s: not a world file (bad magic)\n", filename);
+    else if (get_u16(data + 4) != WORLD_VERSION)
+        fprintf(stderr, "%s: unsupported version %u (expected %u)\n", filename, get_u16(data + 4), WORLD_VERSION);
+    else if (get_u16(data + 6) > GAME_LOST || get_u32(data + 16) < WORLD_MIN_CHUNK_MINES || get_u32(data + 16) > WORLD_MAX_CHUNK_MINES)
+        fprintf(stderr, "%s: invalid header\n", filename);
+    else if ((f.size - WORLD_HEADER_SIZE) / 8 != get_u32(data + 40) || (f.size - WORLD_HEADER_SIZE) % 8 != 0)
+        fprintf(stderr, "%s: header says %u chunks, file has %zu bytes\n", filename, get_u32(data + 40), f.size);
+    else
+    {
+        world->status = (GameStatus)get_u16(data + 6);
+        world->seed = get_u64(data + 8);
+        world->chunk_mines = (int)get_u32(data + 16);
+        world->losing_x = (int)get_u32(data + 20);
+        world->losing_y = (int)get_u32(data + 24);
+        world->uncovered = get_u64(data + 28);
+        world->flags = (int)get_u32(data + 36);
+        result = 1;
+        const uint8_t *p = data + WORLD_HEADER_SIZE;
+        for (uint32_t i = 0; i < get_u32(data + 40); ++i, p += 8)
+        {
+            if (add_stored(world, (int)get_u32(p), (int)get_u32(p + 4)) != 0)
+            {
+                result = -1;
+                break;
+            }
+        }
+    }
+    unmap_file(&f);
+    return result;
+}
+
+/*
+ * Opent de wereld in directory (die aangemaakt wordt als ze niet bestaat).
+ * Staat er al een wereld, dan spelen we die verder (*out_resumed = true) en worden seed en chunk_mines genegeerd.
+ * Anders begint een nieuwe wereld met de opening rond (WORLD_START_X, WORLD_START_Y).
+ * Hoogstens max_chunks chunks blijven in het geheugen (minstens 16, want de cascade gebruikt er tot 9 tegelijk).
+ */
+int world_open(World *world, const char *directory, uint64_t seed, int chunk_mines, int max_chunks, bool *out_resumed)
+{
+    memset(world, 0, sizeof(*world));
+    *out_resumed = false;
+    if (chunk_mines < WORLD_MIN_CHUNK_MINES || chunk_mines > WORLD_MAX_CHUNK_MINES)
+        return -1;
+    if (snprintf(world->directory, sizeof(world->directory), "%s", directory) >= (int)sizeof(world->directory))
+        return -1;
+    if (make_directory(directory) != 0)
+    {
+        fprintf(stderr, "%s: cannot create directory\n", directory);
+        return -1;
+    }
+    world->seed = seed;
+    world->chunk_mines = chunk_mines;
+    world->max_chunks = max_chunks < 16 ? 16 : max_chunks;
+    world->status = GAME_PLAYING;
+
+    // Een macht van 2, met gemiddeld hoogstens 1 chunk per bucket.
+    world->bucket_count = 16;
+    while (world->bucket_count < (size_t)world->max_chunks)
+        world->bucket_count *= 2;
+    world->buckets = (WorldChunk **)calloc(world->bucket_count, sizeof(WorldChunk *));
+    if (!world->buckets)
+        return -1;
+
+    int resumed = read_meta(world);
+    if (resumed < 0)
+    {
+        world_close(world);
+        return -1;
+    }
+    *out_resumed = resumed == 1;
+    if (!*out_resumed)
+        world_reveal(world, WORLD_START_X, WORLD_START_Y);
+    return 0;
+}
+
+// Schrijft alle veranderde chunks in het geheugen weg, en daarna world.msw.
+int world_save(World *world)
+{
+    for (WorldChunk *chunk = world->lru_head; chunk; chunk = chunk->lru_next)
+        if (write_chunk(world, chunk) != 0)
+            return -1;
+    return write_meta(world);
+}
+
+// Geeft het geheugen van de wereld vrij, zonder op te slaan.
+void world_close(World *world)
+{
+    WorldChunk *chunk = world->lru_head;
+    while (chunk)
+    {
+        WorldChunk *next = chunk->lru_next;
+        free(chunk);
+        chunk = next;
+    }
+    free(world->buckets);
+    free(world->stored);
+    free(world->queue);
+    memset(world, 0, sizeof(*world));
+}
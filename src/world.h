@@ -0,0 +1,103 @@
+#ifndef MINESWEEPER_WORLD_H
+#define MINESWEEPER_WORLD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "map.h"
+#include "game.h"
+#include "reveal.h"
+
+/*
+ * De "endless" wereld (via -e): een speelveld zonder randen, opgedeeld in chunks van WORLD_CHUNK_SIZE x WORLD_CHUNK_SIZE cellen.
+ * - De mijnen van een chunk volgen enkel uit de seed en de coördinaten van de chunk (Floyd met een eigen stroom van de RNG),
+ *   dus een chunk die de speler nog niet aangeraakt heeft, hoeft nergens bewaard te worden.
+ * - Een chunk wordt pas aangemaakt (met zijn getallen, waarvoor ook de mijnen van de 8 buurchunks nodig zijn)
+ *   als er een cell in uncovered of gevlagd wordt. Een chunk die nooit aangeraakt werd, wordt als covered getekend.
+ * - De aangemaakte chunks staan in een hash map op hun coördinaten en in een LRU lijst. Zijn er meer dan max_chunks,
+ *   dan wordt de minst recent gebruikte chunk weggeschreven naar de map van de wereld (als hij toestanden heeft) en vrijgegeven.
+ * Het geheugen hangt zo enkel af van max_chunks en van het aantal chunks dat de speler ooit aangeraakt heeft: een WorldChunkKey
+ * van 12 bytes in een set die hoogstens half vol is, dus 24 tot 48 bytes per chunk (in world.msw 8 bytes per chunk).
+ *
+ * In de map van de wereld staan:
+ * - world.msw: magic "MSWE", versie (u16), status (u16), seed (u64), mijnen per chunk (u32), de verloren cell (2 x i32),
+ *   uncovered cellen (u64), vlaggen (u32), aantal chunks op schijf (u32) en hun coördinaten (2 x i32 per chunk); little-endian
+ * - c_<cx>_<cy>.msc per chunk met toestanden: magic "MSWC", versie (u16), 2 gereserveerde bytes, cx en cy (i32) en de cellen
+ */
+#define WORLD_CHUNK_SHIFT 6
+#define WORLD_CHUNK_SIZE (1 << WORLD_CHUNK_SHIFT)
+#define WORLD_CHUNK_CELLS (WORLD_CHUNK_SIZE * WORLD_CHUNK_SIZE)
+
+/*
+ * Het aantal mijnen per chunk. Onder WORLD_MIN_CHUNK_MINES (12.5%) vormen de nul-cellen oneindige gebieden
+ * (percolatie) en zou een cascade nooit stoppen.
+ */
+#define WORLD_DEFAULT_CHUNK_MINES 640
+#define WORLD_MIN_CHUNK_MINES 512
+#define WORLD_MAX_CHUNK_MINES (WORLD_CHUNK_CELLS / 2)
+
+// Het standaard maximum aantal chunks in het geheugen (4 KB per chunk).
+#define WORLD_DEFAULT_MAX_CHUNKS 1024
+
+// Een cascade stopt na zoveel cellen (voor de zekerheid; de rand blijft covered en kan verder aangeklikt worden).
+#define WORLD_MAX_CASCADE (1 << 22)
+
+// De wereld begint met een opening rond deze cell (de 3x3 errond heeft nooit een mijn).
+#define WORLD_START_X (WORLD_CHUNK_SIZE / 2)
+#define WORLD_START_Y (WORLD_CHUNK_SIZE / 2)
+
+#define WORLD_MAGIC "MSWE"
+#define WORLD_CHUNK_MAGIC "MSWC"
+#define WORLD_VERSION 1
+
+typedef struct WorldChunk
+{
+    int cx, cy;
+    bool modified;                         // of de toestanden veranderd zijn sinds de chunk laatst op schijf stond
+    struct WorldChunk *next;               // de volgende chunk in dezelfde bucket van de hash map
+    struct WorldChunk *lru_prev, *lru_next; // de LRU lijst: vooraan de meest recent gebruikte
+    Cell cells[WORLD_CHUNK_CELLS];
+} WorldChunk;
+
+// De coördinaten van een chunk op schijf, in een open-addressing set.
+typedef struct
+{
+    int cx, cy;
+    bool used;
+} WorldChunkKey;
+
+typedef struct
+{
+    char directory[256];
+    uint64_t seed;
+    int chunk_mines;
+    int max_chunks;
+    bool durable; // schrijf de bestanden durable weg (zie write_file)
+
+    WorldChunk **buckets;
+    size_t bucket_count;
+    size_t resident;
+    WorldChunk *lru_head, *lru_tail;
+
+    WorldChunkKey *stored; // de chunks die op schijf staan
+    size_t stored_count;
+    size_t stored_capacity;
+
+    GameStatus status;
+    int losing_x, losing_y;
+    uint64_t uncovered; // aantal uncovered cellen (geen mijnen), de score
+    int flags;
+    bool io_error;      // een chunk kon niet weggeschreven worden (hij blijft dan in het geheugen)
+
+    RevealSeed *queue;  // de worklist van de cascade, hergebruikt
+    size_t queue_capacity;
+} World;
+
+int world_open(World *world, const char *directory, uint64_t seed, int chunk_mines, int max_chunks, bool *out_resumed);
+void world_close(World *world);
+int world_save(World *world);
+Cell world_peek(World *world, int x, int y);
+bool world_reveal(World *world, int x, int y);
+int world_toggle_flag(World *world, int x, int y);
+
+#endif // MINESWEEPER_WORLD_H
@@ -0,0 +1,29 @@
+#ifndef MINESWEEPER_TEST_H
+#define MINESWEEPER_TEST_H
+
+#include <stdio.h>
+
+/*
+ * Een minimale test-helper: CHECK telt de mislukte controles en print waar het misliep.
+ * Elke test is een apart programma dat TEST_RESULT() teruggeeft uit main, zodat make test en ctest een fout zien.
+ */
+static int test_failures = 0;
+
+#define CHECK(cond, ...)                                                  \
+    do                                                                    \
+    {                                                                     \
+        if (!(cond))                                                      \
+        {                                                                 \
+            if (test_failures < 20)                                       \
+            {                                                             \
+                fprintf(stderr, "%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #cond); \
+                fprintf(stderr, __VA_ARGS__);                             \
+                fprintf(stderr, "\n");                                    \
+            }                                                             \
+            test_failures++;                                              \
+        }                                                                 \
+    } while (0)
+
+#define TEST_RESULT() (test_failures == 0 ? 0 : (fprintf(stderr, "%d checks failed\n", test_failures), 1))
+
+#endif // MINESWEEPER_TEST_H
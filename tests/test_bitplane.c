@@ -0,0 +1,90 @@
+#include <stdlib.h>
+#include "test.h"
+#include "map.h"
+#include "bitplane.h"
+#include "rng.h"
+
+/*
+ * Vergelijkt de bit-sliced buren-kernel (elke versie die op deze CPU draait) met de eenvoudige telling per buur,
+ * op willekeurige speelvelden met breedtes rond de 64-bit woordgrenzen, 1xN en Nx1 velden, en lege/volle velden.
+ */
+
+static int reference_count(const Board *b, int x, int y)
+{
+    int count = 0;
+    for (int ay = -1; ay <= 1; ay++)
+    {
+        for (int ax = -1; ax <= 1; ax++)
+        {
+            if ((ax != 0 || ay != 0) && map_in_bounds(b, x + ax, y + ay) && cell_is_mine(MAP_CELL(b, x + ax, y + ay)))
+                count++;
+        }
+    }
+    return count;
+}
+
+static void check_board(const char *kernel, int w, int h, double density, Rng *rng)
+{
+    Board b = {w, h, 0, (Cell *)malloc((size_t)w * (size_t)h)};
+    if (!b.cells)
+        return;
+    // Willekeurige toestand-bits, die de kernel moet laten staan.
+    Cell *states = (Cell *)malloc((size_t)w * (size_t)h);
+    for (size_t i = 0; i < (size_t)w * (size_t)h; ++i)
+    {
+        states[i] = (Cell)(rng_next(rng) & CELL_STATE_MASK);
+        b.cells[i] = states[i] | (rng_uniform(rng) < density ? CELL_MINE : 0);
+    }
+
+    fill_map(&b);
+
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            size_t i = (size_t)y * (size_t)w + (size_t)x;
+            Cell c = b.cells[i];
+            CHECK((c & CELL_STATE_MASK) == states[i], "%s %dx%d: state bits changed at (%d, %d)", kernel, w, h, x, y);
+            if (!cell_is_mine(c))
+                CHECK(cell_neighbour_mines(c) == reference_count(&b, x, y), "%s %dx%d density %.2f: (%d, %d) has %d, expected %d",
+                      kernel, w, h, density, x, y, cell_neighbour_mines(c), reference_count(&b, x, y));
+        }
+    }
+    free(states);
+    free(b.cells);
+}
+
+int main()
+{
+    static const struct
+    {
+        BitplaneKernel kernel;
+        const char *name;
+    } kernels[] = {{BITPLANE_KERNEL_SCALAR, "scalar"}, {BITPLANE_KERNEL_SSE2, "sse2"}, {BITPLANE_KERNEL_AVX2, "avx2"}};
+    static const int widths[] = {1, 2, 7, 8, 9, 63, 64, 65, 127, 128, 129, 191, 255, 256, 257, 300};
+    static const double densities[] = {0.0, 0.05, 0.2, 0.5, 1.0};
+
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k)
+    {
+        if (bitplane_use_kernel(kernels[k].kernel) != 0)
+        {
+            printf("skipping %s kernel (not available)\n", kernels[k].name);
+            continue;
+        }
+        Rng rng;
+        rng_seed(&rng, 0x5eed + k);
+        for (size_t d = 0; d < sizeof(densities) / sizeof(densities[0]); ++d)
+        {
+            for (size_t wi = 0; wi < sizeof(widths) / sizeof(widths[0]); ++wi)
+            {
+                check_board(kernels[k].name, widths[wi], 1 + (int)rng_bounded(&rng, 40), densities[d], &rng);
+                // 1xN en Nx1 velden.
+                check_board(kernels[k].name, widths[wi], 1, densities[d], &rng);
+                check_board(kernels[k].name, 1, widths[wi], densities[d], &rng);
+            }
+        }
+        printf("%s kernel ok\n", kernels[k].name);
+    }
+    bitplane_use_kernel(BITPLANE_KERNEL_AUTO);
+    return TEST_RESULT();
+}
@@ -0,0 +1,251 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include "test.h"
+#include "files.h"
+#include "map.h"
+#include "rng.h"
+
+/*
+ * Test de bestandsformaten van files.h: het binaire formaat moet elk speelveld exact teruggeven
+ * (met de RLE en met de gewone state plane, en gevlagde cellen die ook uncovered zijn),
+ * en een beschadigd bestand moet geweigerd worden met de juiste foutmelding.
+ * Het tekstformaat (save_field en load_field) moet een niet-vierkant speelveld rij per rij teruggeven,
+ * en load_field moet een fout in een tekstbestand melden met de juiste lijn.
+ */
+
+#define TEST_FILE "test_files.tmp"
+
+// De foutmeldingen gaan naar stderr; tijdens een controle leiden we stderr om naar een tijdelijk bestand.
+static FILE *captured;
+static int saved_stderr = -1;
+
+static void capture_begin()
+{
+    fflush(stderr);
+    captured = tmpfile();
+    if (!captured)
+        return;
+    saved_stderr = dup(fileno(stderr));
+    dup2(fileno(captured), fileno(stderr));
+}
+
+// Zet stderr terug en geeft de opgevangen tekst terug in message.
+static void capture_end(char *message, size_t size)
+{
+    message[0] = '\0';
+    if (!captured)
+        return;
+    fflush(stderr);
+    dup2(saved_stderr, fileno(stderr));
+    close(saved_stderr);
+    rewind(captured);
+    size_t n = fread(message, 1, size - 1, captured);
+    message[n] = '\0';
+    fclose(captured);
+    captured = NULL;
+}
+
+/*
+ * Een speelveld van w x h met mijnen en willekeurige toestanden: uncovered en flagged (elk met de gegeven kans in %),
+ * onafhankelijk van elkaar, dus ook gevlagde cellen die uncovered zijn.
+ */
+static int random_board(Board *b, int w, int h, int mines, int uncovered_percent, int flagged_percent, uint64_t seed)
+{
+    if (init_map(b, w, h, mines) != 0)
+        return -1;
+    add_mines(b, seed, 1, -1, -1);
+    Rng rng;
+    rng_seed(&rng, seed);
+    for (size_t i = 0; i < map_cell_count(b); ++i)
+    {
+        cell_set(&b->cells[i], CELL_UNCOVERED, rng_bounded(&rng, 100) < (uint64_t)uncovered_percent);
+        cell_set(&b->cells[i], CELL_FLAGGED, rng_bounded(&rng, 100) < (uint64_t)flagged_percent);
+    }
+    return 0;
+}
+
+static bool same_boards(const Board *a, const Board *b)
+{
+    return a->width == b->width && a->height == b->height && a->mines == b->mines &&
+           memcmp(a->cells, b->cells, map_cell_count(a)) == 0;
+}
+
+// Codeert en parset het speelveld in het geheugen en via een bestand; rle geeft aan welke codering van de toestanden we verwachten.
+static void check_binary(int w, int h, int mines, int uncovered_percent, int flagged_percent, bool rle, uint64_t seed)
+{
+    Board b, parsed;
+    if (random_board(&b, w, h, mines, uncovered_percent, flagged_percent, seed) != 0)
+    {
+        CHECK(0, "%dx%d: out of memory", w, h);
+        return;
+    }
+    size_t size;
+    uint8_t *data = encode_field_binary(&b, seed, CELL_UNCOVERED, &size);
+    CHECK(data != NULL, "%dx%d: encoding failed", w, h);
+    if (!data)
+    {
+        free_map(&b);
+        return;
+    }
+    CHECK(((get_u16(data + 6) & BINARY_FLAG_RLE) != 0) == rle, "%dx%d (%d%% uncovered, %d%% flagged): expected the %s state encoding",
+          w, h, uncovered_percent, flagged_percent, rle ? "RLE" : "raw");
+
+    uint64_t parsed_seed = 0;
+    CHECK(parse_field_binary("memory", data, size, &parsed, &parsed_seed) == 0, "%dx%d: parsing failed", w, h);
+    CHECK(same_boards(&b, &parsed) && parsed_seed == seed, "%dx%d (%s): board or seed differs after parsing", w, h, rle ? "RLE" : "raw");
+    free_map(&parsed);
+
+    CHECK(save_field_binary(TEST_FILE, &b, seed, false) == 0, "%dx%d: cannot write %s", w, h, TEST_FILE);
+    parsed_seed = 0;
+    CHECK(load_field(TEST_FILE, &parsed, &parsed_seed) == 0, "%dx%d: cannot load %s", w, h, TEST_FILE);
+    CHECK(same_boards(&b, &parsed) && parsed_seed == seed, "%dx%d (%s): board or seed differs after loading the file", w, h, rle ? "RLE" : "raw");
+    free_map(&parsed);
+    free(data);
+    free_map(&b);
+}
+
+// Parset een beschadigd binair speelveld: dat moet mislukken met een foutmelding die expected bevat.
+static void check_binary_rejected(const char *name, const uint8_t *data, size_t size, const char *expected)
+{
+    Board b;
+    char message[512];
+    capture_begin();
+    int result = parse_field_binary(name, data, size, &b, NULL);
+    capture_end(message, sizeof(message));
+    if (result == 0)
+        free_map(&b);
+    CHECK(result != 0, "%s: not rejected", name);
+    CHECK(strstr(message, expected) != NULL, "%s: expected \"%s\", got \"%s\"", name, expected, message);
+}
+
+static void check_binary_errors()
+{
+    Board b;
+    size_t size;
+    uint8_t *data;
+
+    // De gewone state plane: 1 byte te weinig, of een onbekende versie.
+    if (random_board(&b, 65, 7, 40, 50, 20, 11) != 0 || !(data = encode_field_binary(&b, 11, CELL_UNCOVERED, &size)))
+        return;
+    CHECK(!(get_u16(data + 6) & BINARY_FLAG_RLE), "expected the raw state encoding");
+    check_binary_rejected("truncated plane", data, size - 1, "truncated state plane");
+    put_u16(data + 4, BINARY_VERSION + 1);
+    check_binary_rejected("unknown version", data, size, "unsupported version");
+    free(data);
+    free_map(&b);
+
+    // De RLE: een varint die niet eindigt, en een run die langer is dan het speelveld.
+    if (random_board(&b, 100, 30, 90, 1, 0, 12) != 0 || !(data = encode_field_binary(&b, 12, CELL_UNCOVERED, &size)))
+        return;
+    CHECK(get_u16(data + 6) & BINARY_FLAG_RLE, "expected the RLE state encoding");
+    size_t states = BINARY_HEADER_SIZE + (map_cell_count(&b) + 7) / 8;
+    uint8_t *corrupt = (uint8_t *)malloc(states + 16);
+    if (corrupt)
+    {
+        memcpy(corrupt, data, states);
+        memset(corrupt + states, 0xFF, 16);
+        check_binary_rejected("unterminated varint", corrupt, states + 16, "truncated state runs");
+        // Een run van 3001 covered cellen op een speelveld van 3000 cellen.
+        corrupt[states] = 0xB9;
+        corrupt[states + 1] = 0x17;
+        corrupt[states + 2] = 0x00;
+        check_binary_rejected("bad varint run", corrupt, states + 3, "state runs exceed the board");
+        free(corrupt);
+    }
+    free(data);
+    free_map(&b);
+}
+
+/*
+ * Slaat het speelveld op in het tekstformaat en laadt het terug. Op een niet-vierkant speelveld valt zo op
+ * als de rijen en kolommen verwisseld worden. Het tekstformaat kent enkel F voor een gevlagde cell, ook als ze uncovered is.
+ */
+static void check_text(int w, int h, int mines, uint64_t seed)
+{
+    Board b, loaded;
+    if (random_board(&b, w, h, mines, 40, 20, seed) != 0)
+    {
+        CHECK(0, "%dx%d: out of memory", w, h);
+        return;
+    }
+    CHECK(save_field(TEST_FILE, &b, false) == 0, "%dx%d: cannot write %s", w, h, TEST_FILE);
+    for (size_t i = 0; i < map_cell_count(&b); ++i)
+        if (cell_has(b.cells[i], CELL_FLAGGED))
+            cell_set(&b.cells[i], CELL_UNCOVERED, false);
+    uint64_t loaded_seed = 1;
+    CHECK(load_field(TEST_FILE, &loaded, &loaded_seed) == 0, "%dx%d: cannot load %s", w, h, TEST_FILE);
+    CHECK(same_boards(&b, &loaded) && loaded_seed == 0, "%dx%d: board differs after save_field and load_field", w, h);
+    free_map(&loaded);
+    free_map(&b);
+}
+
+// Laadt een tekstbestand met de gegeven inhoud: dat moet mislukken met een foutmelding die expected bevat.
+static void check_text_rejected(const char *name, const char *content, const char *expected)
+{
+    Board b;
+    char message[512];
+    if (write_file(TEST_FILE, content, strlen(content), false) != 0)
+    {
+        CHECK(0, "%s: cannot write %s", name, TEST_FILE);
+        return;
+    }
+    capture_begin();
+    int result = load_field(TEST_FILE, &b, NULL);
+    capture_end(message, sizeof(message));
+    if (result == 0)
+        free_map(&b);
+    CHECK(result != 0, "%s: not rejected", name);
+    CHECK(strstr(message, expected) != NULL, "%s: expected \"%s\", got \"%s\"", name, expected, message);
+}
+
+static void check_text_errors()
+{
+    check_text_rejected("unexpected character", "1 2 3 \n1 X 3 \n", ":2:3: unexpected character 'X' (expected 0-8 or M)");
+    check_text_rejected("empty first row", "\n1 2 \n", ":1: the first row of the field is empty");
+    check_text_rejected("row too long", "1 2 3 \n1 2 3 4 \n", ":2:7: row has more than 3 cells");
+    check_text_rejected("row too short", "1 2 3 \n1 2 \n", ":2: row has 2 cells, expected 3");
+    check_text_rejected("bad state", "1 2 \n3 4 \n\nU F \nU M \n", ":5:3: unexpected character 'M' (expected U, F or #)");
+    check_text_rejected("short state grid", "1 2 \n3 4 \n\nU F \n", ":5: the state grid has 1 rows, expected 2");
+    check_text_rejected("short state row", "1 2 \n3 4 \n\nU F \nU \n", ":5: state row has 1 cells, expected 2");
+    check_text_rejected("long state row", "1 2 \n3 4 \n\nU F \nU F # \n", ":5:5: row has more than 2 cells");
+    check_text_rejected("trailing content", "1 2 \n3 4 \n\nU F \n# # \n\n1 2 \n", ":7: unexpected content after the state grid");
+
+    // Zonder toestanden (of met enkel lege lijnen erna) is het bestand wel geldig.
+    Board b;
+    const char *field_only = "1 M \n1 1 \n\n\n";
+    bool loaded = write_file(TEST_FILE, field_only, strlen(field_only), false) == 0 && load_field(TEST_FILE, &b, NULL) == 0;
+    CHECK(loaded, "a field without states was rejected");
+    if (loaded)
+    {
+        CHECK(b.width == 2 && b.height == 2 && b.mines == 1, "field without states: %dx%d with %d mines", b.width, b.height, b.mines);
+        free_map(&b);
+    }
+}
+
+int main()
+{
+    // Breedtes rond een veelvoud van 64 (de mijnen worden per 64 cellen gelezen), en een kolom van 1 cell breed.
+    static const int widths[] = {1, 7, 63, 64, 65, 100, 129};
+    for (size_t i = 0; i < sizeof(widths) / sizeof(widths[0]); ++i)
+    {
+        int w = widths[i], h = 200 + (int)(i * 5);
+        check_binary(w, h, w * h / 5, 1, 1, true, 100 + i);
+        check_binary(w, h, w * h / 5, 50, 30, false, 200 + i);
+    }
+    check_binary(37, 11, 60, 0, 0, true, 1);
+    check_binary(37, 11, 60, 100, 100, false, 2);
+    check_binary_errors();
+
+    check_text(37, 11, 60, 3);
+    check_text(11, 37, 60, 4);
+    check_text(1, 5, 1, 5);
+    check_text_errors();
+    remove(TEST_FILE);
+    return TEST_RESULT();
+}
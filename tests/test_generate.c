@@ -0,0 +1,59 @@
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "map.h"
+
+/*
+ * Controleert dat add_mines voor een gegeven seed (en uitgesloten cell) hetzelfde speelveld geeft, ongeacht het aantal threads.
+ * De velden zijn groot genoeg (boven MAP_PARALLEL_MIN_CELLS) om echt over meerdere threads verdeeld te worden,
+ * met een breedte die geen veelvoud van 64 is en een hoogte die geen veelvoud van de bandhoogte is.
+ */
+
+static int generate(Board *b, int w, int h, int mines, uint64_t seed, int threads, int ex, int ey)
+{
+    if (init_map(b, w, h, mines) != 0)
+        return -1;
+    add_mines(b, seed, threads, ex, ey);
+    return 0;
+}
+
+static void check_threads(int w, int h, int mines, uint64_t seed, int ex, int ey)
+{
+    static const int thread_counts[] = {2, 3, 4, 7, 16};
+    Board reference;
+    if (generate(&reference, w, h, mines, seed, 1, ex, ey) != 0)
+    {
+        CHECK(0, "out of memory for %dx%d", w, h);
+        return;
+    }
+
+    size_t placed = 0;
+    for (size_t i = 0; i < map_cell_count(&reference); ++i)
+        placed += cell_is_mine(reference.cells[i]);
+    CHECK(placed == (size_t)reference.mines, "%dx%d: %zu mines placed, expected %d", w, h, placed, reference.mines);
+    if (map_in_bounds(&reference, ex, ey))
+        CHECK(!cell_is_mine(MAP_CELL(&reference, ex, ey)), "%dx%d: mine on the excluded cell (%d, %d)", w, h, ex, ey);
+
+    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); ++t)
+    {
+        Board b;
+        if (generate(&b, w, h, mines, seed, thread_counts[t], ex, ey) != 0)
+            continue;
+        CHECK(memcmp(b.cells, reference.cells, map_cell_count(&b)) == 0, "%dx%d seed %llu: %d threads differ from 1 thread",
+              w, h, (unsigned long long)seed, thread_counts[t]);
+        free_map(&b);
+    }
+    free_map(&reference);
+}
+
+int main()
+{
+    check_threads(1100, 1000, 150000, 1, -1, -1);
+    check_threads(1537, 701, 200000, 2, 1536, 700);
+    check_threads(1000, 1100, 1000, 3, 500, 500);
+    // Bijna vol: op 1 cell na (de uitgesloten cell) wordt alles een mijn.
+    check_threads(1031, 1031, 1031 * 1031, 4, 0, 0);
+    // Klein (1 thread volstaat daar), maar het resultaat mag evenmin afhangen van het aantal threads.
+    check_threads(30, 16, 99, 5, 3, 3);
+    return TEST_RESULT();
+}
@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "files.h"
+#include "game.h"
+#include "journal.h"
+#include "rng.h"
+
+/*
+ * Speelt spellen zoals de GUI: elke zet wordt uitgevoerd en daarna in het journal bijgehouden, met een progressieve cascade
+ * (zie game_reveal_step), vlaggen, show_all en show_mines, en een compactie terwijl er nog een cascade bezig is.
+ * Het afgespeelde journal moet daarna exact hetzelfde spel geven. Een onvolledig laatste record wordt genegeerd;
+ * een journal met een verkeerde magic, versie of flags wordt geweigerd.
+ */
+
+#define TEST_FILE "test_journal.tmp"
+
+/*
+ * Vergelijkt 2 spellen. Buiten show_all is CELL_SAVED_UNCOVERED een overblijfsel van de vorige toggle
+ * (de momentopname bewaart het niet), dus die bit tellen we dan niet mee.
+ */
+static bool same_games(const Game *a, const Game *b)
+{
+    Cell mask = a->show_all ? 0xFF : (Cell)~CELL_SAVED_UNCOVERED;
+    for (size_t i = 0; i < map_cell_count(&a->board) && i < map_cell_count(&b->board); ++i)
+        if ((a->board.cells[i] & mask) != (b->board.cells[i] & mask))
+            return false;
+    return a->board.width == b->board.width && a->board.height == b->board.height && a->board.mines == b->board.mines && a->status == b->status &&
+           a->show_all == b->show_all && a->show_mines == b->show_mines && a->seed == b->seed &&
+           a->uncovered_safe == b->uncovered_safe && a->flags_placed == b->flags_placed && a->correct_flags == b->correct_flags;
+}
+
+// Een willekeurige cell die nog geen mijn is (met show_all kijken we naar de echte uncovered toestand).
+static void random_cell(const Game *game, Rng *rng, int *x, int *y)
+{
+    const Board *b = &game->board;
+    do
+    {
+        *x = (int)rng_bounded(rng, (uint64_t)b->width);
+        *y = (int)rng_bounded(rng, (uint64_t)b->height);
+    } while (cell_is_mine(MAP_CELL(b, *x, *y)));
+}
+
+// Uncovert een covered nul-cell met covered buren, zodat er een cascade begint (als die er nog is).
+static bool start_cascade(Game *game, Journal *journal)
+{
+    const Board *b = &game->board;
+    for (int y = 0; y < b->height; ++y)
+    {
+        for (int x = 0; x < b->width; ++x)
+        {
+            Cell c = MAP_CELL(b, x, y);
+            if (cell_has(c, CELL_UNCOVERED | CELL_FLAGGED) || cell_is_mine(c) || cell_neighbour_mines(c) != 0)
+                continue;
+            if (game_reveal(game, x, y))
+                CHECK(journal_record(journal, game, JOURNAL_REVEAL, x, y) == 0, "reveal (%d, %d) not recorded", x, y);
+            return game_reveal_pending(game);
+        }
+    }
+    return false;
+}
+
+// Houdt een zet bij in het journal, en telt de compacties door journal_flush (als de records groter worden dan de momentopname).
+static void record(Journal *journal, const Game *game, JournalRecordType type, int x, int y, int *compactions)
+{
+    size_t before = journal->record_bytes;
+    CHECK(journal_record(journal, game, type, x, y) == 0, "move %d at (%d, %d) not recorded", (int)type, x, y);
+    *compactions += journal->record_bytes < before;
+}
+
+// Speelt hoogstens moves zetten, waarvan ongeveer reveal_percent % reveals. Geeft het aantal compacties door journal_flush terug.
+static int play(Game *game, Journal *journal, Rng *rng, int moves, int reveal_percent)
+{
+    int compactions = 0;
+    for (int k = 0; k < moves && game->status == GAME_PLAYING; ++k)
+    {
+        int x, y;
+        uint64_t r = rng_bounded(rng, 100);
+        if (k == 0 || r < (uint64_t)reveal_percent)
+        {
+            random_cell(game, rng, &x, &y);
+            if (game_reveal(game, x, y))
+                record(journal, game, JOURNAL_REVEAL, x, y, &compactions);
+        }
+        else if (r < 92)
+        {
+            x = (int)rng_bounded(rng, (uint64_t)game->board.width);
+            y = (int)rng_bounded(rng, (uint64_t)game->board.height);
+            if (game_toggle_flag(game, x, y) == FLAG_CHANGED)
+                record(journal, game, JOURNAL_FLAG, x, y, &compactions);
+        }
+        else if (r < 96)
+        {
+            game_toggle_show_mines(game);
+            record(journal, game, JOURNAL_SHOW_MINES, 0, 0, &compactions);
+        }
+        else
+        {
+            game_toggle_show_all(game);
+            record(journal, game, JOURNAL_SHOW_ALL, 0, 0, &compactions);
+        }
+        // Zoals de GUI per frame: een lopende cascade vordert maar een beetje tussen 2 zetten.
+        game_reveal_step(game, 2);
+
+        // Halverwege compacteren we terwijl er een cascade bezig is: de seeds op de worklist komen dan als records in het journal.
+        if (k == moves / 2 && !game->show_all && start_cascade(game, journal))
+            CHECK(journal_compact(journal, game) == 0, "compaction during a cascade failed");
+    }
+    return compactions;
+}
+
+static void check_replay(int t, int w, int h, int mines, int moves, int reveal_percent, int min_compactions, Rng *rng)
+{
+    Game *live = game_new(w, h, mines);
+    if (!live)
+    {
+        CHECK(0, "game %d: out of memory", t);
+        return;
+    }
+    live->seed = rng_next(rng);
+    live->progressive = true;
+    Journal journal;
+    if (journal_open(&journal, TEST_FILE, live, false) != 0)
+    {
+        CHECK(0, "game %d: cannot open %s", t, TEST_FILE);
+        game_free(live);
+        return;
+    }
+    int compactions = play(live, &journal, rng, moves, reveal_percent);
+    CHECK(compactions >= min_compactions, "game %d: %d compactions by journal_flush, expected at least %d", t, compactions, min_compactions);
+    journal_close(&journal, live);
+    game_reveal_finish(live);
+
+    Game *replay = game_load(TEST_FILE);
+    CHECK(replay && same_games(live, replay), "game %d (%dx%d, %d moves, seed %llu): replay differs from the live game",
+          t, w, h, moves, (unsigned long long)live->seed);
+    game_free(replay);
+
+    // Een crash tijdens het schrijven laat een onvolledig record achter; dat wordt genegeerd.
+    FILE *out = fopen(TEST_FILE, "ab");
+    if (out)
+    {
+        fwrite("\x01\x00\x00\x00\x05", 1, 5, out);
+        fclose(out);
+    }
+    replay = game_load(TEST_FILE);
+    CHECK(replay && same_games(live, replay), "game %d: replay with a truncated last record differs", t);
+    game_free(replay);
+    game_free(live);
+}
+
+/*
+ * Verandert de bytes [offset, offset + size) van een geldig journal en houdt er enkel de eerste keep bytes van over (0 = alles);
+ * het inlezen moet dan mislukken.
+ */
+static void check_rejected(const char *name, size_t offset, const void *bytes, size_t size, size_t keep)
+{
+    MappedFile f;
+    if (map_file(TEST_FILE, &f) != 0)
+    {
+        CHECK(0, "%s: cannot read %s", name, TEST_FILE);
+        return;
+    }
+    uint8_t *data = (uint8_t *)malloc(f.size);
+    size_t total = f.size;
+    if (data)
+        memcpy(data, f.data, total);
+    unmap_file(&f);
+    if (!data)
+        return;
+    memcpy(data + offset, bytes, size);
+    const char *corrupt = "test_journal_corrupt.tmp";
+    if (keep > 0 && keep < total)
+        total = keep;
+    CHECK(write_file(corrupt, data, total, false) == 0, "%s: cannot write %s", name, corrupt);
+    free(data);
+
+    Game *game = game_load(corrupt);
+    CHECK(game == NULL, "%s: journal was not rejected", name);
+    // Zonder de juiste magic is het ook geen journal meer (game_load probeert het dan als tekst- of binair speelveld).
+    if (offset == 0 && memcmp(bytes, JOURNAL_MAGIC, 4) != 0)
+        CHECK(!journal_detect(corrupt), "%s: still detected as a journal", name);
+    game_free(game);
+    remove(corrupt);
+}
+
+int main()
+{
+    Rng rng;
+    rng_seed(&rng, 15);
+    for (int t = 0; t < 20; ++t)
+        check_replay(t, 20 + (int)rng_bounded(&rng, 60), 20 + (int)rng_bounded(&rng, 60), 40 + (int)rng_bounded(&rng, 100),
+                     50 + (int)rng_bounded(&rng, 400), 55, 0, &rng);
+    // Vooral vlaggen, zodat de records voorbij de momentopname (en JOURNAL_MIN_COMPACT_SIZE) groeien: journal_flush compacteert.
+    check_replay(20, 100, 100, 3000, 100000, 1, 2, &rng);
+
+    uint8_t version[2] = {JOURNAL_VERSION + 1, 0}, flags[2] = {0x02, 0};
+    check_rejected("bad magic", 0, "MSWX", 4, 0);
+    check_rejected("bad version", 4, version, sizeof(version), 0);
+    check_rejected("bad flags", 6, flags, sizeof(flags), 0);
+    check_rejected("truncated header", 0, JOURNAL_MAGIC, 4, JOURNAL_HEADER_SIZE - 1);
+    check_rejected("truncated snapshot", 0, JOURNAL_MAGIC, 4, JOURNAL_HEADER_SIZE + 8);
+    remove(TEST_FILE);
+    return TEST_RESULT();
+}
@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <string.h>
+#include "test.h"
+#include "game.h"
+#include "rng.h"
+
+/*
+ * Vergelijkt een progressieve cascade (zoals in de GUI, in stukken via game_reveal_step) met een synchrone replay van dezelfde acties.
+ * Midden in de cascade vlaggen we seeds die nog op de worklist staan, en halen we de vlaggen terug weg:
+ * daarna moeten beide spellen identiek zijn, en na het uncoveren van elke veilige cell moeten beide gewonnen zijn.
+ * Zowel op een gewoon speelveld als op een speelveld van -z.
+ */
+
+#define TEST_BOARDS 200
+#define TEST_CLICKS 20
+#define TEST_FLAGS 16
+
+static Game *new_game(bool sparse, int w, int h, int mines, uint64_t seed, bool progressive)
+{
+    Game *game = sparse ? game_new_sparse(w, h, mines) : game_new(w, h, mines);
+    if (!game)
+        return NULL;
+    game->seed = seed;
+    game->progressive = progressive;
+    return game;
+}
+
+static bool same_games(const Game *a, const Game *b)
+{
+    for (int y = 0; y < a->board.height; ++y)
+        for (int x = 0; x < a->board.width; ++x)
+            if (game_cell(a, x, y) != game_cell(b, x, y))
+                return false;
+    return a->status == b->status && a->uncovered_safe == b->uncovered_safe && a->flags_placed == b->flags_placed;
+}
+
+// Uncovert elke veilige cell die nog covered is; de progressieve cascade werken we telkens meteen af.
+static void reveal_all_safe(Game *game)
+{
+    for (int y = 0; y < game->board.height && game->status == GAME_PLAYING; ++y)
+    {
+        for (int x = 0; x < game->board.width && game->status == GAME_PLAYING; ++x)
+        {
+            Cell c = game_cell(game, x, y);
+            if (cell_is_mine(c) || cell_has(c, CELL_UNCOVERED))
+                continue;
+            game_reveal(game, x, y);
+            game_reveal_finish(game);
+        }
+    }
+}
+
+static void check_board(int t, bool sparse, Rng *rng)
+{
+    int w = 9 + (int)rng_bounded(rng, 60), h = 9 + (int)rng_bounded(rng, 60);
+    int mines = 1 + (int)((double)w * h * 0.08 * rng_uniform(rng));
+    int cx = (int)rng_bounded(rng, w), cy = (int)rng_bounded(rng, h);
+    uint64_t seed = rng_next(rng);
+
+    Game *live = new_game(sparse, w, h, mines, seed, true);
+    Game *replay = new_game(sparse, w, h, mines, seed, false);
+    if (!live || !replay)
+    {
+        CHECK(0, "board %d: out of memory", t);
+        game_free(live);
+        game_free(replay);
+        return;
+    }
+
+    // De eerste klik start de cascade; we werken er maar 1 seed van af, zodat er nog seeds op de worklist staan.
+    game_reveal(live, cx, cy);
+    game_reveal_step(live, 1);
+    game_reveal(replay, cx, cy);
+
+    // We vlaggen (hoogstens TEST_FLAGS van) de seeds die nog op de worklist staan, en halen de vlaggen daarna terug weg.
+    RevealSeed flagged[TEST_FLAGS];
+    size_t count;
+    const RevealSeed *frontier = game_reveal_frontier(live, &count);
+    if (count > TEST_FLAGS)
+        count = TEST_FLAGS;
+    // Zonder lopende cascade is de worklist leeg en frontier mogelijk NULL.
+    if (count > 0)
+        memcpy(flagged, frontier, count * sizeof(RevealSeed));
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            game_toggle_flag(live, flagged[i].x, flagged[i].y);
+            game_toggle_flag(replay, flagged[i].x, flagged[i].y);
+        }
+    }
+    game_reveal_finish(live);
+    CHECK(same_games(live, replay), "board %d (%s %dx%d, seed %llu): flags on %zu pending seeds changed the cascade",
+          t, sparse ? "sparse" : "dense", w, h, (unsigned long long)seed, count);
+
+    // Daarna nog enkele kliks op veilige cellen: een nieuwe cascade moet ook over de (niet langer gevlagde) seeds heen lopen.
+    for (int k = 0; k < TEST_CLICKS && live->status == GAME_PLAYING; ++k)
+    {
+        int x = (int)rng_bounded(rng, w), y = (int)rng_bounded(rng, h);
+        if (cell_is_mine(game_cell(live, x, y)))
+            continue;
+        game_reveal(live, x, y);
+        game_reveal_finish(live);
+        game_reveal(replay, x, y);
+        CHECK(same_games(live, replay), "board %d (%s %dx%d, seed %llu): click (%d, %d) after the flags differs",
+              t, sparse ? "sparse" : "dense", w, h, (unsigned long long)seed, x, y);
+    }
+
+    reveal_all_safe(live);
+    reveal_all_safe(replay);
+    CHECK(live->status == GAME_WON && replay->status == GAME_WON, "board %d (%s %dx%d, seed %llu): status %d (live) and %d (replay), expected won",
+          t, sparse ? "sparse" : "dense", w, h, (unsigned long long)seed, (int)live->status, (int)replay->status);
+
+    game_free(live);
+    game_free(replay);
+}
+
+int main()
+{
+    Rng rng;
+    rng_seed(&rng, 25);
+    for (int t = 0; t < TEST_BOARDS; ++t)
+    {
+        check_board(t, false, &rng);
+        check_board(t, true, &rng);
+    }
+    return TEST_RESULT();
+}
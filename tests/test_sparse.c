@@ -0,0 +1,104 @@
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "map.h"
+#include "reveal.h"
+#include "sparse.h"
+#include "rng.h"
+
+/*
+ * Vergelijkt het speelveld van -z (sparse.h) met een gewoon speelveld met dezelfde mijnen, op 300 willekeurige speelvelden.
+ * Na het plaatsen van de mijnen kopiëren we ze naar een gewoon speelveld, en spelen we op beide dezelfde vlaggen en kliks:
+ * sparse_cascade moet evenveel cellen uncoveren als reveal_cascade, en op het einde moet elke cell identiek zijn.
+ */
+
+#define TEST_BOARDS 300
+#define TEST_CLICKS 40
+
+// Controleert de index van de mijnen en kopieert de mijnen naar het gewone speelveld b (met de getallen).
+static void copy_mines(const SparseBoard *s, Board *b, int mines, int cx, int cy)
+{
+    int count = 0;
+    memset(b->cells, 0, map_cell_count(b));
+    for (int y = 0; y < b->height; ++y)
+    {
+        for (uint32_t i = s->row_start[y]; i < s->row_start[y + 1]; ++i)
+        {
+            CHECK(i == s->row_start[y] || s->mine_x[i] > s->mine_x[i - 1], "row %d: mine columns not sorted", y);
+            MAP_CELL(b, s->mine_x[i], y) = CELL_MINE;
+            count++;
+        }
+    }
+    CHECK(count == mines, "%dx%d: %d mines in the index, expected %d", b->width, b->height, count, mines);
+    CHECK(!cell_is_mine(MAP_CELL(b, cx, cy)), "%dx%d: mine on the first click (%d, %d)", b->width, b->height, cx, cy);
+    fill_map(b);
+}
+
+static void check_board(int t, Rng *rng)
+{
+    int w = 20 + (int)rng_bounded(rng, 300), h = 20 + (int)rng_bounded(rng, 300);
+    int mines = (int)((double)w * h * (0.005 + 0.2 * rng_uniform(rng)));
+    int cx = (int)rng_bounded(rng, w), cy = (int)rng_bounded(rng, h);
+
+    SparseBoard s;
+    Board b;
+    if (sparse_init(&s, w, h) != 0 || init_map(&b, w, h, mines) != 0)
+    {
+        CHECK(0, "board %d: out of memory", t);
+        return;
+    }
+    CHECK(sparse_place_mines(&s, mines, rng_next(rng), cx, cy) == mines, "board %d: wrong number of mines placed", t);
+    copy_mines(&s, &b, mines, cx, cy);
+
+    // Ongeveer 1% vlaggen, ook op mijnen en in openingen, zodat de cascade er rond moet.
+    for (int k = 0; k < w * h / 100; ++k)
+    {
+        int x = (int)rng_bounded(rng, w), y = (int)rng_bounded(rng, h);
+        cell_set(&MAP_CELL(&b, x, y), CELL_FLAGGED, true);
+        sparse_set_flag(&s, x, y, true);
+    }
+
+    RevealEngine engine;
+    DirtyList dirty;
+    reveal_init(&engine);
+    dirty_init(&dirty);
+    for (int k = 0; k < TEST_CLICKS; ++k)
+    {
+        int x = k == 0 ? cx : (int)rng_bounded(rng, w), y = k == 0 ? cy : (int)rng_bounded(rng, h);
+        Cell c = MAP_CELL(&b, x, y);
+        if (cell_is_mine(c))
+            continue;
+        if (cell_neighbour_mines(c) == 0)
+        {
+            long dense = reveal_cascade(&engine, &b, x, y, &dirty);
+            long long sparse = sparse_cascade(&s, x, y, &dirty);
+            CHECK(dense == sparse, "board %d: cascade at (%d, %d) uncovered %ld dense, %lld sparse", t, x, y, dense, sparse);
+        }
+        else
+        {
+            cell_set(&MAP_CELL(&b, x, y), CELL_UNCOVERED, true);
+            sparse_uncover(&s, x, y);
+        }
+        dirty_clear(&dirty);
+    }
+
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+            CHECK(sparse_cell(&s, x, y) == MAP_CELL(&b, x, y), "board %d (%dx%d): cell (%d, %d) is %#x sparse, %#x dense", t, w, h, x,
+                  y, sparse_cell(&s, x, y), MAP_CELL(&b, x, y));
+    }
+    reveal_free(&engine);
+    dirty_free(&dirty);
+    free_map(&b);
+    sparse_free(&s);
+}
+
+int main()
+{
+    Rng rng;
+    rng_seed(&rng, 12345);
+    for (int t = 0; t < TEST_BOARDS; ++t)
+        check_board(t, &rng);
+    return TEST_RESULT();
+}
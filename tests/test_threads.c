@@ -0,0 +1,68 @@
+#include "test.h"
+#include <string.h>
+#include "simulate.h"
+#include "noguess.h"
+
+/*
+ * Speelt dezelfde simulatie (-n) met 1 en met meerdere threads: de resultaten (behalve de tijden) moeten identiek zijn.
+ * Idem voor het no-guess speelveld (-g): elke thread genereert en speelt daar zijn eigen kandidaten.
+ * De speelvelden zijn hoger dan 64 rijen (MAP_BAND_ROWS in map.c), zodat add_mines op elke thread meerdere banden verdeelt:
+ * de threads plaatsen dan tegelijk mijnen en spelen tegelijk met de solver en de probability engine.
+ * Gebouwd met -fsanitize=thread (make test CORE_CFLAGS="-O1 -g -fsanitize=thread -pthread") vindt ThreadSanitizer hier de data races.
+ */
+
+static void check_simulation(int w, int h, int mines, long games, uint64_t seed)
+{
+    static const int thread_counts[] = {2, 4};
+    SimulationConfig config = {w, h, mines, games, seed, 1, false};
+    SimulationResult reference;
+    if (simulate(&config, &reference) != 0)
+    {
+        CHECK(0, "%dx%d: simulation failed", w, h);
+        return;
+    }
+    CHECK(reference.games == games, "%dx%d: %ld games played, expected %ld", w, h, reference.games, games);
+
+    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); ++t)
+    {
+        SimulationResult result;
+        config.threads = thread_counts[t];
+        if (simulate(&config, &result) != 0)
+        {
+            CHECK(0, "%dx%d: simulation with %d threads failed", w, h, thread_counts[t]);
+            continue;
+        }
+        CHECK(result.games == reference.games && result.wins == reference.wins && result.guesses == reference.guesses,
+              "%dx%d seed %llu: %d threads give %ld/%ld wins and %ld guesses, 1 thread %ld/%ld wins and %ld guesses",
+              w, h, (unsigned long long)seed, thread_counts[t], result.wins, result.games, result.guesses,
+              reference.wins, reference.games, reference.guesses);
+    }
+}
+
+static void check_no_guess(int w, int h, int mines, uint64_t seed, int x, int y)
+{
+    Board reference, b;
+    if (init_map(&reference, w, h, mines) != 0 || init_map(&b, w, h, mines) != 0)
+    {
+        CHECK(0, "%dx%d: out of memory", w, h);
+        return;
+    }
+    long reference_attempts, attempts;
+    CHECK(generate_no_guess(&reference, seed, 1, x, y, &reference_attempts) == 0, "%dx%d seed %llu: no board found with 1 thread",
+          w, h, (unsigned long long)seed);
+    CHECK(generate_no_guess(&b, seed, 4, x, y, &attempts) == 0, "%dx%d seed %llu: no board found with 4 threads",
+          w, h, (unsigned long long)seed);
+    CHECK(attempts == reference_attempts && memcmp(b.cells, reference.cells, map_cell_count(&b)) == 0,
+          "%dx%d seed %llu: 4 threads give candidate %ld, 1 thread candidate %ld", w, h, (unsigned long long)seed, attempts, reference_attempts);
+    free_map(&reference);
+    free_map(&b);
+}
+
+int main()
+{
+    check_simulation(100, 100, 1500, 16, 1);
+    check_simulation(70, 130, 1200, 16, 2);
+    check_no_guess(80, 80, 800, 3, 40, 40);
+    check_no_guess(30, 100, 450, 4, 0, 99);
+    return TEST_RESULT();
+}
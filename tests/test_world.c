@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+#include <direct.h>
+#define rmdir _rmdir
+#else
+#include <unistd.h>
+#endif
+#include "test.h"
+#include "world.h"
+#include "rng.h"
+
+/*
+ * Test de endless wereld (world.h):
+ * - dezelfde zetten op een wereld met een cache van 16 chunks en op een wereld die alles in het geheugen houdt,
+ *   moeten hetzelfde resultaat geven (de kleine cache schrijft chunks weg en leest ze terug in);
+ * - de getallen kloppen met de mijnen van de buren, ook over de grenzen van de chunks (en in negatieve coördinaten);
+ * - na world_save en world_open spelen we verder met exact dezelfde wereld.
+ */
+
+#define SMALL_DIR "test_world_small.tmp"
+#define LARGE_DIR "test_world_large.tmp"
+#define TEST_SEED 2023
+
+// Het gebied waarin we spelen: over 10 x 10 chunks, rond de oorsprong.
+#define AREA_MIN (-5 * WORLD_CHUNK_SIZE)
+#define AREA_MAX (5 * WORLD_CHUNK_SIZE - 1)
+
+// Raakt de cell (x, y) aan zonder iets te veranderen: 2 keer een vlag, zodat de chunk aangemaakt wordt (en world_peek de mijnen toont).
+static void touch(World *world, int x, int y)
+{
+    if (world_toggle_flag(world, x, y) == FLAG_CHANGED)
+        world_toggle_flag(world, x, y);
+}
+
+// Vergelijkt elke cell van het gebied en de tellers van 2 werelden.
+static bool same_worlds(World *a, World *b)
+{
+    for (int y = AREA_MIN - 1; y <= AREA_MAX + 1; ++y)
+        for (int x = AREA_MIN - 1; x <= AREA_MAX + 1; ++x)
+            if (world_peek(a, x, y) != world_peek(b, x, y))
+                return false;
+    return a->status == b->status && a->uncovered == b->uncovered && a->flags == b->flags;
+}
+
+/*
+ * Speelt moves zetten op beide werelden: een willekeurige cell wordt eerst aangeraakt, en is ze een mijn, dan krijgt ze een vlag;
+ * anders wordt ze uncovered (met een cascade als het een nul-cell is). Zo verliest de speler nooit.
+ */
+static void play(World *small, World *large, Rng *rng, int moves)
+{
+    for (int k = 0; k < moves; ++k)
+    {
+        int x = AREA_MIN + (int)rng_bounded(rng, AREA_MAX - AREA_MIN + 1);
+        int y = AREA_MIN + (int)rng_bounded(rng, AREA_MAX - AREA_MIN + 1);
+        touch(small, x, y);
+        touch(large, x, y);
+        Cell c = world_peek(large, x, y);
+        CHECK(world_peek(small, x, y) == c, "move %d: cell (%d, %d) differs", k, x, y);
+        if (cell_is_mine(c))
+        {
+            if (!cell_has(c, CELL_FLAGGED))
+                CHECK(world_toggle_flag(small, x, y) == world_toggle_flag(large, x, y), "move %d: flag (%d, %d) differs", k, x, y);
+        }
+        else
+            CHECK(world_reveal(small, x, y) == world_reveal(large, x, y), "move %d: reveal (%d, %d) differs", k, x, y);
+    }
+}
+
+// Het getal van elke cell in het gebied moet het aantal mijnen bij de 8 buren zijn.
+static void check_numbers(World *world)
+{
+    for (int cy = AREA_MIN - WORLD_CHUNK_SIZE; cy <= AREA_MAX + WORLD_CHUNK_SIZE; cy += WORLD_CHUNK_SIZE)
+        for (int cx = AREA_MIN - WORLD_CHUNK_SIZE; cx <= AREA_MAX + WORLD_CHUNK_SIZE; cx += WORLD_CHUNK_SIZE)
+            touch(world, cx, cy);
+    int wrong = 0;
+    for (int y = AREA_MIN; y <= AREA_MAX; ++y)
+    {
+        for (int x = AREA_MIN; x <= AREA_MAX; ++x)
+        {
+            Cell c = world_peek(world, x, y);
+            if (cell_is_mine(c))
+                continue;
+            int mines = 0;
+            for (int ny = y - 1; ny <= y + 1; ++ny)
+                for (int nx = x - 1; nx <= x + 1; ++nx)
+                    mines += cell_is_mine(world_peek(world, nx, ny));
+            wrong += cell_neighbour_mines(c) != mines;
+        }
+    }
+    CHECK(wrong == 0, "%d cells have a wrong number", wrong);
+}
+
+// Verwijdert de bestanden van de wereld (de chunks op schijf en world.msw) en de map zelf.
+static void remove_world(World *world, const char *directory)
+{
+    char filename[320];
+    for (size_t i = 0; i < world->stored_capacity; ++i)
+    {
+        if (!world->stored[i].used)
+            continue;
+        snprintf(filename, sizeof(filename), "%s/c_%d_%d.msc", directory, world->stored[i].cx, world->stored[i].cy);
+        remove(filename);
+    }
+    snprintf(filename, sizeof(filename), "%s/world.msw", directory);
+    remove(filename);
+    world_close(world);
+    rmdir(directory);
+}
+
+int main()
+{
+    World small, large;
+    bool resumed;
+    if (world_open(&small, SMALL_DIR, TEST_SEED, WORLD_DEFAULT_CHUNK_MINES, 16, &resumed) != 0 || resumed)
+    {
+        CHECK(0, "cannot open a new world in %s", SMALL_DIR);
+        return TEST_RESULT();
+    }
+    if (world_open(&large, LARGE_DIR, TEST_SEED, WORLD_DEFAULT_CHUNK_MINES, 4096, &resumed) != 0 || resumed)
+    {
+        CHECK(0, "cannot open a new world in %s", LARGE_DIR);
+        remove_world(&small, SMALL_DIR);
+        return TEST_RESULT();
+    }
+
+    Rng rng;
+    rng_seed(&rng, TEST_SEED);
+    play(&small, &large, &rng, 3000);
+    CHECK(small.resident <= 16, "%zu chunks in memory, expected at most 16", small.resident);
+    CHECK(small.stored_count > 16, "only %zu chunks written to disk", small.stored_count);
+    CHECK(!small.io_error, "a chunk could not be written");
+    CHECK(same_worlds(&small, &large), "the 16-chunk world differs from the unbounded world");
+
+    check_numbers(&small);
+    check_numbers(&large);
+
+    // Opslaan en opnieuw openen: de wereld moet identiek zijn, en we spelen verder.
+    CHECK(world_save(&small) == 0, "world_save failed");
+    world_close(&small);
+    if (world_open(&small, SMALL_DIR, TEST_SEED + 1, WORLD_DEFAULT_CHUNK_MINES + 1, 16, &resumed) != 0 || !resumed)
+    {
+        CHECK(0, "cannot resume the world in %s", SMALL_DIR);
+        remove_world(&large, LARGE_DIR);
+        return TEST_RESULT();
+    }
+    CHECK(small.seed == TEST_SEED && small.chunk_mines == WORLD_DEFAULT_CHUNK_MINES, "the resumed world has another seed or mine count");
+    CHECK(same_worlds(&small, &large), "the resumed world differs");
+    play(&small, &large, &rng, 1000);
+    CHECK(same_worlds(&small, &large), "the resumed world differs after playing on");
+
+    remove_world(&small, SMALL_DIR);
+    remove_world(&large, LARGE_DIR);
+    return TEST_RESULT();
+}